@@ -16,15 +16,133 @@ extern class MiniAudio {
 		_loadFiles(vec);
 	}
 	@:native("loadFiles") static function _loadFiles(argv:StdVectorString):Void;
+	@:runtime inline static function loadFromMemory(stems:Array<haxe.io.Bytes>):Void {
+		var vec = StdVectorBytes.create();
+		var sizes:Array<Int> = [];
+		for (stem in stems) {
+			vec.push_back(cpp.Pointer.ofArray(stem.getData()).constRaw);
+			sizes.push(stem.length);
+		}
+		_loadFromMemory(vec, cpp.Pointer.ofArray(sizes).constRaw);
+	}
+	@:native("loadFromMemory") static function _loadFromMemory(data:StdVectorBytes, sizes:cpp.RawConstPointer<Int>):Void;
+
+	@:runtime inline static function mountPack(path:String):Bool {
+		return _mountPack(cpp.ConstCharStar.fromString(path)) == 1;
+	}
+	@:native("mountPack") static function _mountPack(path:cpp.ConstCharStar):Int;
+	@:native("unmountPack") static function unmountPack():Void;
+	@:runtime inline static function addPackEntry(name:String, offset:cpp.Int64, size:cpp.Int64):Bool {
+		return _addPackEntry(cpp.ConstCharStar.fromString(name), offset, size) == 1;
+	}
+	@:native("addPackEntry") static function _addPackEntry(name:cpp.ConstCharStar, offset:cpp.Int64, size:cpp.Int64):Int;
+
+	@:runtime inline static function loadSfx(path:String):Int {
+		return _loadSfx(cpp.ConstCharStar.fromString(path));
+	}
+	@:native("loadSfx") static function _loadSfx(path:cpp.ConstCharStar):Int;
+	@:runtime inline static function loadSfxFromMemory(bytes:haxe.io.Bytes):Int {
+		return _loadSfxFromMemory(cpp.Pointer.ofArray(bytes.getData()).constRaw, bytes.length);
+	}
+	@:native("loadSfxFromMemory") static function _loadSfxFromMemory(data:cpp.RawConstPointer<cpp.UInt8>, size:Int):Int;
+	@:native("unloadSfx") static function unloadSfx(id:Int):Void;
+	@:runtime inline static function playSfx(id:Int, gain:Float, pan:Float, frame:cpp.Int64):Bool {
+		return _playSfx(id, gain, pan, frame) == 1;
+	}
+	@:native("playSfx") static function _playSfx(id:Int, gain:Float, pan:Float, frame:cpp.Int64):Int;
+	@:native("stopSfx") static function stopSfx():Void;
+	@:runtime inline static function previewFiles(arr:Array<String>, startFrame:cpp.Int64, fadeFrames:Int):Bool {
+		return _previewFiles(StdVectorString.fromStringArray(arr), startFrame, fadeFrames) == 1;
+	}
+	@:native("previewFiles") static function _previewFiles(argv:StdVectorString, startFrame:cpp.Int64, fadeFrames:Int):Int;
+	@:native("stopPreview") static function stopPreview(fadeFrames:Int):Void;
+	@:native("closePreview") static function closePreview():Void;
 
 	@:native("getPlaybackPosition") static function getPlaybackPosition():Float;
 	@:native("getDuration") static function getDuration():Float;
 	@:native("getMixerState") static function getMixerState():Int;
 
 	@:native("setPlaybackRate") static function setPlaybackRate(playbackRate:cpp.Float32):Void;
+	@:native("setStretchPreset") static function setStretchPreset(preset:Int):Void;
+	@:native("setStretchSeed") static function setStretchSeed(seed:Int):Void;
+	@:native("setRateMode") static function setRateMode(mode:Int):Void;
+
+	@:runtime inline static function setPrerenderRates(rates:Array<Float>):Void {
+		var floats:Array<cpp.Float32> = [for (rate in rates) rate];
+		_setPrerenderRates(cpp.Pointer.ofArray(floats).constRaw, floats.length);
+	}
+	@:native("setPrerenderRates") static function _setPrerenderRates(rates:cpp.RawConstPointer<cpp.Float32>, count:Int):Void;
+
 	@:native("seekToPCMFrame") static function seekToPCMFrame(pos:cpp.Int64):Void;
+	@:runtime inline static function setLoop(startFrame:cpp.Int64, endFrame:cpp.Int64, crossfadeFrames:Int):Bool {
+		return _setLoop(startFrame, endFrame, crossfadeFrames) == 1;
+	}
+	@:native("setLoop") static function _setLoop(startFrame:cpp.Int64, endFrame:cpp.Int64, crossfadeFrames:Int):Int;
+	@:native("clearLoop") static function clearLoop():Void;
 	@:native("deactivate_decoder") static function deactivate_decoder(index:Int):Void;
 	@:native("amplify_decoder") static function amplify_decoder(index:Int, volume:Float):Void;
+	@:native("setStemPan") static function setStemPan(index:Int, pan:Float):Void;
+	@:runtime inline static function setStemMute(index:Int, muted:Bool):Void {
+		_setStemMute(index, muted ? 1 : 0);
+	}
+	@:native("setStemMute") static function _setStemMute(index:Int, muted:Int):Void;
+	@:runtime inline static function scheduleChange(type:Int, index:Int, value:Float, frame:cpp.Int64):Bool {
+		return _scheduleChange(type, index, value, frame) == 1;
+	}
+	@:native("scheduleChange") static function _scheduleChange(type:Int, index:Int, value:Float, frame:cpp.Int64):Int;
+	@:native("clearSchedule") static function clearSchedule():Void;
+	@:runtime inline static function getStemMeters(out:Array<Float>):Int {
+		var count = out.length > 0 ? _getStemMeters(cpp.Pointer.ofArray(out).raw, out.length) : _getStemMeters(null, 0);
+		if (count * 3 > out.length) {
+			out.resize(count * 3);
+			count = _getStemMeters(cpp.Pointer.ofArray(out).raw, out.length);
+		}
+		return count;
+	}
+	@:native("getStemMeters") static function _getStemMeters(out:cpp.RawPointer<Float>, capacity:Int):Int;
+	@:runtime inline static function getSnapshot(out:Array<Float>):Int {
+		var size = out.length > 0 ? _getSnapshot(cpp.Pointer.ofArray(out).raw, out.length) : _getSnapshot(null, 0);
+		if (size > out.length) {
+			out.resize(size);
+			size = _getSnapshot(cpp.Pointer.ofArray(out).raw, out.length);
+		}
+		return size;
+	}
+	@:native("getSnapshot") static function _getSnapshot(out:cpp.RawPointer<Float>, capacity:Int):Int;
+	@:runtime inline static function getTelemetryJson():String {
+		var bytes = haxe.io.Bytes.alloc(_getTelemetryJson(null, 0) + 64); // The counters can grow a digit or two in between
+		var size = _getTelemetryJson(cpp.Pointer.ofArray(bytes.getData()).raw, bytes.length);
+		return bytes.getString(0, size < bytes.length ? size : bytes.length - 1);
+	}
+	@:native("getTelemetryJson") static function _getTelemetryJson(out:cpp.RawPointer<cpp.UInt8>, capacity:Int):Int;
+	@:native("resetTelemetry") static function resetTelemetry():Void;
+	@:runtime inline static function pollEvents(out:Array<Float>):Int {
+		return out.length > 0 ? _pollEvents(cpp.Pointer.ofArray(out).raw, out.length) : 0;
+	}
+	@:native("pollEvents") static function _pollEvents(out:cpp.RawPointer<Float>, capacity:Int):Int;
+	@:native("addMarker") static function addMarker(id:Int, frame:cpp.Int64):Void;
+	@:native("clearMarkers") static function clearMarkers():Void;
+	@:runtime inline static function setConductorMap(changes:Array<Float>):Void {
+		_setConductorMap(changes.length > 0 ? cpp.Pointer.ofArray(changes).constRaw : null, Std.int(changes.length / 4));
+	}
+	@:native("setConductorMap") static function _setConductorMap(changes:cpp.RawConstPointer<Float>, count:Int):Void;
+	@:native("setConductorTicks") static function setConductorTicks(mode:Int):Void;
+
+	@:native("setWaveformMode") static function setWaveformMode(mode:Int):Void;
+	@:runtime inline static function getStemPCM(index:Int):cpp.Pointer<cpp.Float32> {
+		return cpp.Pointer.fromRaw(_getStemPCM(index));
+	}
+	@:native("getStemPCM") static function _getStemPCM(index:Int):cpp.RawPointer<cpp.Float32>;
+	@:native("getStemFrames") static function getStemFrames(index:Int):Int;
+	@:native("getStemPeakLevels") static function getStemPeakLevels(index:Int):Int;
+	@:runtime inline static function getStemPeaks(index:Int, level:Int):cpp.Pointer<cpp.Float32> {
+		return cpp.Pointer.fromRaw(_getStemPeaks(index, level));
+	}
+	@:native("getStemPeaks") static function _getStemPeaks(index:Int, level:Int):cpp.RawPointer<cpp.Float32>;
+	@:native("getStemPeakCount") static function getStemPeakCount(index:Int, level:Int):Int;
+
+	@:native("setReverb") static function setReverb(mode:Int, send:Float, roomMs:Float, decaySeconds:Float, dampingHz:Float):Void;
+	@:native("setStemFilter") static function setStemFilter(index:Int, type:Int, frequency:Float, gainDb:Float, q:Float):Void;
 }
 #elseif hl
 class MiniAudio {
@@ -44,6 +162,60 @@ class MiniAudio {
 		_loadFiles(nativeArray);
 	}
 	@:hlNative("ma_thing", "loadFiles") public static function _loadFiles(args:hl.NativeArray<hl.Bytes>):Void {}
+	@:runtime inline public static function loadFromMemory(stems:Array<haxe.io.Bytes>):Void {
+		var data = new hl.NativeArray<hl.Bytes>(stems.length);
+		var sizes = new hl.Bytes(stems.length * 4);
+		for (i in 0...stems.length) {
+			data[i] = @:privateAccess stems[i].b;
+			sizes.setI32(i * 4, stems[i].length);
+		}
+		_loadFromMemory(data, sizes);
+	}
+	@:hlNative("ma_thing", "load_from_memory") public static function _loadFromMemory(data:hl.NativeArray<hl.Bytes>, sizes:hl.Bytes):Void {}
+
+	@:runtime inline public static function mountPack(path:String):Bool {
+		return _mountPack(@:privateAccess path.toUtf8());
+	}
+	@:hlNative("ma_thing", "mount_pack") public static function _mountPack(path:hl.Bytes):Bool {
+		return false;
+	}
+	@:hlNative("ma_thing", "unmount_pack") public static function unmountPack():Void {}
+	@:runtime inline public static function addPackEntry(name:String, offset:hl.I64, size:hl.I64):Bool {
+		return _addPackEntry(@:privateAccess name.toUtf8(), offset, size);
+	}
+	@:hlNative("ma_thing", "add_pack_entry") public static function _addPackEntry(name:hl.Bytes, offset:hl.I64, size:hl.I64):Bool {
+		return false;
+	}
+
+	@:runtime inline public static function loadSfx(path:String):Int {
+		return _loadSfx(@:privateAccess path.toUtf8());
+	}
+	@:hlNative("ma_thing", "load_sfx") public static function _loadSfx(path:hl.Bytes):Int {
+		return -1;
+	}
+	@:runtime inline public static function loadSfxFromMemory(bytes:haxe.io.Bytes):Int {
+		return _loadSfxFromMemory(@:privateAccess bytes.b, bytes.length);
+	}
+	@:hlNative("ma_thing", "load_sfx_from_memory") public static function _loadSfxFromMemory(data:hl.Bytes, size:Int):Int {
+		return -1;
+	}
+	@:hlNative("ma_thing", "unload_sfx") public static function unloadSfx(id:Int):Void {}
+	@:hlNative("ma_thing", "play_sfx") public static function playSfx(id:Int, gain:Float, pan:Float, frame:hl.I64):Bool {
+		return false;
+	}
+	@:hlNative("ma_thing", "stop_sfx") public static function stopSfx():Void {}
+	@:runtime inline public static function previewFiles(arr:Array<String>, startFrame:hl.I64, fadeFrames:Int):Bool {
+		var nativeArray = new hl.NativeArray(arr.length);
+		for (i in 0...arr.length) {
+			nativeArray[i] = @:privateAccess arr[i].toUtf8();
+		}
+		return _previewFiles(nativeArray, startFrame, fadeFrames);
+	}
+	@:hlNative("ma_thing", "preview_files") public static function _previewFiles(args:hl.NativeArray<hl.Bytes>, startFrame:hl.I64, fadeFrames:Int):Bool {
+		return false;
+	}
+	@:hlNative("ma_thing", "stop_preview") public static function stopPreview(fadeFrames:Int):Void {}
+	@:hlNative("ma_thing", "close_preview") public static function closePreview():Void {}
 
 	@:hlNative("ma_thing", "get_playback_position") public static function getPlaybackPosition():Float {
 		return 0;
@@ -56,9 +228,126 @@ class MiniAudio {
 	}
 
 	@:hlNative("ma_thing", "setPlaybackRate") public static function setPlaybackRate(playbackRate:hl.F32):Void {}
+	@:hlNative("ma_thing", "set_stretch_preset") public static function setStretchPreset(preset:Int):Void {}
+	@:hlNative("ma_thing", "set_stretch_seed") public static function setStretchSeed(seed:Int):Void {}
+	@:hlNative("ma_thing", "set_rate_mode") public static function setRateMode(mode:Int):Void {}
+
+	@:runtime inline public static function setPrerenderRates(rates:Array<Float>):Void {
+		var bytes = new hl.Bytes(rates.length * 4);
+		for (i in 0...rates.length) {
+			bytes.setF32(i * 4, rates[i]);
+		}
+		_setPrerenderRates(bytes, rates.length);
+	}
+	@:hlNative("ma_thing", "set_prerender_rates") public static function _setPrerenderRates(rates:hl.Bytes, count:Int):Void {}
+
 	@:hlNative("ma_thing", "seek_to_pcm_frame") public static function seekToPCMFrame(pos:hl.I64):Void {}
+	@:hlNative("ma_thing", "set_loop") public static function setLoop(startFrame:hl.I64, endFrame:hl.I64, crossfadeFrames:Int):Bool {
+		return false;
+	}
+	@:hlNative("ma_thing", "clear_loop") public static function clearLoop():Void {}
 	@:hlNative("ma_thing", "deactivate_decoder_hl") public static function deactivate_decoder(index:Int):Void {}
 	@:hlNative("ma_thing", "amplify_decoder_hl") public static function amplify_decoder(index:Int, volume:Float):Void {}
+	@:hlNative("ma_thing", "set_stem_pan") public static function setStemPan(index:Int, pan:Float):Void {}
+	@:hlNative("ma_thing", "set_stem_mute") public static function setStemMute(index:Int, muted:Bool):Void {}
+	@:hlNative("ma_thing", "schedule_change") public static function scheduleChange(type:Int, index:Int, value:Float, frame:hl.I64):Bool {
+		return false;
+	}
+	@:hlNative("ma_thing", "clear_schedule") public static function clearSchedule():Void {}
+	static var meterBytes:hl.Bytes = null;
+	static var meterBytesLength:Int = 0;
+
+	@:runtime inline public static function getStemMeters(out:Array<Float>):Int {
+		var count = _getStemMeters(null, 0);
+		if (count * 3 > meterBytesLength) {
+			meterBytesLength = count * 3;
+			meterBytes = new hl.Bytes(meterBytesLength * 8);
+		}
+		count = _getStemMeters(meterBytes, count * 3);
+		for (i in 0...count * 3) {
+			out[i] = meterBytes.getF64(i * 8);
+		}
+		return count;
+	}
+	@:hlNative("ma_thing", "get_stem_meters") public static function _getStemMeters(out:hl.Bytes, capacity:Int):Int {
+		return 0;
+	}
+	static var snapshotBytes:hl.Bytes = null;
+	static var snapshotBytesLength:Int = 0;
+
+	@:runtime inline public static function getSnapshot(out:Array<Float>):Int {
+		var size = _getSnapshot(snapshotBytes, snapshotBytesLength);
+		if (size > snapshotBytesLength) {
+			snapshotBytesLength = size;
+			snapshotBytes = new hl.Bytes(snapshotBytesLength * 8);
+			size = _getSnapshot(snapshotBytes, snapshotBytesLength);
+		}
+		for (i in 0...size) {
+			out[i] = snapshotBytes.getF64(i * 8);
+		}
+		return size;
+	}
+	@:hlNative("ma_thing", "get_snapshot") public static function _getSnapshot(out:hl.Bytes, capacity:Int):Int {
+		return 0;
+	}
+	@:runtime inline public static function getTelemetryJson():String {
+		var capacity = _getTelemetryJson(null, 0) + 64; // The counters can grow a digit or two in between
+		var bytes = new hl.Bytes(capacity);
+		_getTelemetryJson(bytes, capacity);
+		return @:privateAccess String.fromUTF8(bytes);
+	}
+	@:hlNative("ma_thing", "get_telemetry_json") public static function _getTelemetryJson(out:hl.Bytes, capacity:Int):Int {
+		return 0;
+	}
+	@:hlNative("ma_thing", "reset_telemetry") public static function resetTelemetry():Void {}
+	static var eventBytes:hl.Bytes = null;
+	static var eventBytesLength:Int = 0;
+
+	@:runtime inline public static function pollEvents(out:Array<Float>):Int {
+		if (out.length > eventBytesLength) {
+			eventBytesLength = out.length;
+			eventBytes = new hl.Bytes(eventBytesLength * 8);
+		}
+		var count = _pollEvents(eventBytes, out.length);
+		for (i in 0...count * 3) {
+			out[i] = eventBytes.getF64(i * 8);
+		}
+		return count;
+	}
+	@:hlNative("ma_thing", "poll_events") public static function _pollEvents(out:hl.Bytes, capacity:Int):Int {
+		return 0;
+	}
+	@:hlNative("ma_thing", "add_marker") public static function addMarker(id:Int, frame:hl.I64):Void {}
+	@:hlNative("ma_thing", "clear_markers") public static function clearMarkers():Void {}
+	@:runtime inline public static function setConductorMap(changes:Array<Float>):Void {
+		var bytes = new hl.Bytes(changes.length * 8);
+		for (i in 0...changes.length) {
+			bytes.setF64(i * 8, changes[i]);
+		}
+		_setConductorMap(bytes, Std.int(changes.length / 4));
+	}
+	@:hlNative("ma_thing", "set_conductor_map") public static function _setConductorMap(changes:hl.Bytes, count:Int):Void {}
+	@:hlNative("ma_thing", "set_conductor_ticks") public static function setConductorTicks(mode:Int):Void {}
+
+	@:hlNative("ma_thing", "set_waveform_mode") public static function setWaveformMode(mode:Int):Void {}
+	@:hlNative("ma_thing", "get_stem_pcm") public static function getStemPCM(index:Int):hl.Bytes {
+		return null;
+	}
+	@:hlNative("ma_thing", "get_stem_frames") public static function getStemFrames(index:Int):Int {
+		return 0;
+	}
+	@:hlNative("ma_thing", "get_stem_peak_levels") public static function getStemPeakLevels(index:Int):Int {
+		return 0;
+	}
+	@:hlNative("ma_thing", "get_stem_peaks") public static function getStemPeaks(index:Int, level:Int):hl.Bytes {
+		return null;
+	}
+	@:hlNative("ma_thing", "get_stem_peak_count") public static function getStemPeakCount(index:Int, level:Int):Int {
+		return 0;
+	}
+
+	@:hlNative("ma_thing", "set_reverb") public static function setReverb(mode:Int, send:Float, roomMs:Float, decaySeconds:Float, dampingHz:Float):Void {}
+	@:hlNative("ma_thing", "set_stem_filter") public static function setStemFilter(index:Int, type:Int, frequency:Float, gainDb:Float, q:Float):Void {}
 }
 #else
 class MiniAudio {
@@ -71,6 +360,30 @@ class MiniAudio {
 	}
 
 	static function loadFiles(arr:Array<String>):Void {}
+	static function loadFromMemory(stems:Array<haxe.io.Bytes>):Void {}
+	static function mountPack(path:String):Bool {
+		return false;
+	}
+	static function unmountPack():Void {}
+	static function addPackEntry(name:String, offset:haxe.Int64, size:haxe.Int64):Bool {
+		return false;
+	}
+	static function loadSfx(path:String):Int {
+		return -1;
+	}
+	static function loadSfxFromMemory(bytes:haxe.io.Bytes):Int {
+		return -1;
+	}
+	static function unloadSfx(id:Int):Void {}
+	static function playSfx(id:Int, gain:Float, pan:Float, frame:haxe.Int64):Bool {
+		return false;
+	}
+	static function stopSfx():Void {}
+	static function previewFiles(arr:Array<String>, startFrame:haxe.Int64, fadeFrames:Int):Bool {
+		return false;
+	}
+	static function stopPreview(fadeFrames:Int):Void {}
+	static function closePreview():Void {}
 
 	static function getPlaybackPosition():Float {
 		return 0;
@@ -83,8 +396,57 @@ class MiniAudio {
 	}
 
 	static function setPlaybackRate(playbackRate:Float):Void {}
+	static function setStretchPreset(preset:Int):Void {}
+	static function setStretchSeed(seed:Int):Void {}
+	static function setRateMode(mode:Int):Void {}
+	static function setPrerenderRates(rates:Array<Float>):Void {}
 	static function seekToPCMFrame(pos:haxe.Int64):Void {}
+	static function setLoop(startFrame:haxe.Int64, endFrame:haxe.Int64, crossfadeFrames:Int):Bool {
+		return false;
+	}
+	static function clearLoop():Void {}
 	static function deactivate_decoder(index:Int):Void {}
 	function amplify_decoder(index:Int, volume:Float):Void {}
+	static function setStemPan(index:Int, pan:Float):Void {}
+	static function setStemMute(index:Int, muted:Bool):Void {}
+	static function scheduleChange(type:Int, index:Int, value:Float, frame:haxe.Int64):Bool {
+		return false;
+	}
+	static function clearSchedule():Void {}
+	static function getStemMeters(out:Array<Float>):Int {
+		return 0;
+	}
+	static function getSnapshot(out:Array<Float>):Int {
+		return 0;
+	}
+	static function getTelemetryJson():String {
+		return "{}";
+	}
+	static function resetTelemetry():Void {}
+	static function pollEvents(out:Array<Float>):Int {
+		return 0;
+	}
+	static function addMarker(id:Int, frame:haxe.Int64):Void {}
+	static function clearMarkers():Void {}
+	static function setConductorMap(changes:Array<Float>):Void {}
+	static function setConductorTicks(mode:Int):Void {}
+	static function setWaveformMode(mode:Int):Void {}
+	static function getStemPCM(index:Int):Dynamic {
+		return null;
+	}
+	static function getStemFrames(index:Int):Int {
+		return 0;
+	}
+	static function getStemPeakLevels(index:Int):Int {
+		return 0;
+	}
+	static function getStemPeaks(index:Int, level:Int):Dynamic {
+		return null;
+	}
+	static function getStemPeakCount(index:Int, level:Int):Int {
+		return 0;
+	}
+	static function setReverb(mode:Int, send:Float, roomMs:Float, decaySeconds:Float, dampingHz:Float):Void {}
+	static function setStemFilter(index:Int, type:Int, frequency:Float, gainDb:Float, q:Float):Void {}
 }
 #end
\ No newline at end of file
@@ -0,0 +1,21 @@
+package miniaudio;
+
+#if cpp
+import cpp.RawConstPointer;
+import cpp.UInt8;
+
+@:keep
+@:unreflective
+@:structAccess
+@:include('vector')
+@:native('std::vector<const unsigned char*>')
+extern class StdVectorBytes
+{
+    @:native('std::vector<const unsigned char*>')
+    static function create() : StdVectorBytes;
+
+    function push_back(_bytes : RawConstPointer<UInt8>) : Void;
+
+    function size() : Int;
+}
+#end
\ No newline at end of file
@@ -0,0 +1,130 @@
+#ifndef MA_CONDUCTOR_H
+#define MA_CONDUCTOR_H
+
+/*
+	* Beats, steps and measures of the song, worked out from the same frame clock the mixer plays by, so they can't
+	* drift from the audio. The song is split into sections at every BPM/time signature change, and each section
+	* remembers where it starts in frames, beats, steps and measures, so any position is one multiply away.
+	* Ticks are placed in song frames, which is why changing the playback rate doesn't move them.
+
+	* A numerator/denominator time signature has `numerator` beats per measure and 16 / denominator steps per beat
+	* (4 for x/4), same as the game's charts.
+
+	* Needs miniaudio.h and ma_events.h included before it.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+class Conductor {
+public:
+	struct Position {
+		double beat = 0, step = 0, measure = 0, bpm = 0;
+		int beatsPerMeasure = 4, stepsPerBeat = 4;
+	};
+
+	/*
+	* `changes` holds timeMs, bpm, numerator, denominator for each change. An empty map turns the conductor off.
+	* Sorts and allocates, so the mixer builds a new conductor off the lock and swap()s it in under decoderMutex.
+	*/
+	void setMap(const double* changes, int count, double sampleRate) {
+		struct Change {
+			double timeMs, bpm;
+			int numerator, denominator;
+		};
+		std::vector<Change> sorted;
+		for (int i = 0; i < count; ++i) {
+			const double* change = changes + i * 4;
+			if (!(change[1] > 0)) continue;
+			sorted.push_back(Change{change[0], change[1], change[2] > 0 ? (int)change[2] : 4, change[3] > 0 ? (int)change[3] : 4});
+		}
+		std::stable_sort(sorted.begin(), sorted.end(), [](const Change& a, const Change& b) {
+			return a.timeMs < b.timeMs;
+		});
+
+		sections.clear();
+		for (const Change& change : sorted) {
+			Section section;
+			section.frame = change.timeMs * 0.001 * sampleRate;
+			section.framesPerBeat = 60 * sampleRate / change.bpm;
+			section.bpm = change.bpm;
+			section.beatsPerMeasure = change.numerator;
+			section.stepsPerBeat = std::max(1, 16 / change.denominator);
+			if (!sections.empty()) {
+				const Section& previous = sections.back();
+				double beats = (section.frame - previous.frame) / previous.framesPerBeat;
+				section.beat = previous.beat + beats;
+				section.step = previous.step + beats * previous.stepsPerBeat;
+				section.measure = previous.measure + beats / previous.beatsPerMeasure;
+			}
+			sections.push_back(section);
+		}
+	}
+
+	/* Trades maps with `other`. Doesn't allocate or free, whatever `other` ends up with goes when it does. */
+	void swap(Conductor& other) {
+		sections.swap(other.sections);
+	}
+
+	bool active() const {
+		return !sections.empty();
+	}
+
+	/* Where `frame` is. Before the first change, the first section is extended backwards (negative beats). */
+	Position at(double frame) const {
+		Position position;
+		if (sections.empty()) return position;
+		const Section& section = sections[sectionIndex(frame)];
+		double beats = (frame - section.frame) / section.framesPerBeat;
+		position.beat = section.beat + beats;
+		position.step = section.step + beats * section.stepsPerBeat;
+		position.measure = section.measure + beats / section.beatsPerMeasure;
+		position.bpm = section.bpm;
+		position.beatsPerMeasure = section.beatsPerMeasure;
+		position.stepsPerBeat = section.stepsPerBeat;
+		return position;
+	}
+
+	/*
+	* Pushes an event of `type` for every whole beat (or step) that falls in [startFrame, endFrame), with the beat
+	* (or step) number as the index and the first frame at or after it as the frame.
+	*/
+	void pushTicks(EventQueue& queue, int type, bool steps, ma_uint64 startFrame, ma_uint64 endFrame) const {
+		if (sections.empty() || endFrame <= startFrame) return;
+		for (size_t s = sectionIndex((double)startFrame); s < sections.size(); ++s) {
+			const Section& section = sections[s];
+			double from = s == 0 ? (double)startFrame : std::max((double)startFrame, section.frame);
+			double to = s + 1 < sections.size() ? std::min((double)endFrame, sections[s + 1].frame) : (double)endFrame;
+			if (from >= (double)endFrame) break;
+			if (from >= to) continue;
+
+			double framesPerTick = steps ? section.framesPerBeat / section.stepsPerBeat : section.framesPerBeat;
+			double ticksAtSection = steps ? section.step : section.beat;
+			for (double tick = std::ceil(ticksAtSection + (from - section.frame) / framesPerTick);; ++tick) {
+				double frame = section.frame + (tick - ticksAtSection) * framesPerTick;
+				if (frame >= to) break;
+				if (frame < from) continue; // Rounding
+				queue.push(type, (int)tick, (ma_uint64)std::ceil(frame));
+			}
+		}
+	}
+
+private:
+	struct Section {
+		double frame = 0, framesPerBeat = 1, bpm = 0;
+		double beat = 0, step = 0, measure = 0; // Where the section starts
+		int beatsPerMeasure = 4, stepsPerBeat = 4;
+	};
+	std::vector<Section> sections;
+
+	// The last section starting at or before `frame`, or the first one
+	size_t sectionIndex(double frame) const {
+		auto it = std::upper_bound(sections.begin(), sections.end(), frame, [](double f, const Section& section) {
+			return f < section.frame;
+		});
+		return it == sections.begin() ? 0 : (size_t)(it - sections.begin()) - 1;
+	}
+};
+
+#endif /* MA_CONDUCTOR_H */
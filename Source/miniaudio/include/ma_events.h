@@ -0,0 +1,115 @@
+#ifndef MA_EVENTS_H
+#define MA_EVENTS_H
+
+/*
+	* Things that happen at a specific point in the song, queued as they happen so the game doesn't have to poll for
+	* them (and can't miss one between two frames). The audio thread writes most of them, the game drains the queue
+	* once per frame.
+
+	* Needs miniaudio.h included before it.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <vector>
+
+/*
+* 0 = SONG_FINISHED (the longest stem ran out)
+* 1 = STEM_FINISHED (index = the stem)
+* 2 = UNDERRUN (index = 0 for a callback that took too long, 1 for a gap between callbacks)
+* 3 = SEEK_COMPLETED
+* 4 = LOOP_POINT (index = how many times it has looped, frame = the loop's end)
+* 5 = MARKER (index = the marker's id)
+* 6 = BEAT (index = the beat number, see ma_conductor.h)
+* 7 = STEP (index = the step number)
+*/
+struct MixerEvent {
+	int type = 0;
+	int index = -1;
+	ma_uint64 frame = 0; // PCM frame of the song it happened at
+};
+
+/*
+* Single producer, single consumer ring, lock-free. Any thread can push, but pushes have to be serialised (the mixer
+* does it under decoderMutex). If the game stops draining it, new events are dropped rather than overwriting ones it
+* hasn't seen.
+*/
+class EventQueue {
+public:
+	static constexpr int capacity = 256; // Power of 2
+	static constexpr int eventSize = 3; // Doubles per event in drain()
+
+	bool push(int type, int index, ma_uint64 frame) {
+		unsigned int write = writeIndex.load(std::memory_order_relaxed);
+		if (write - readIndex.load(std::memory_order_acquire) >= (unsigned int)capacity) return false;
+		MixerEvent& event = events[write & (capacity - 1)];
+		event.type = type;
+		event.index = index;
+		event.frame = frame;
+		writeIndex.store(write + 1, std::memory_order_release);
+		return true;
+	}
+
+	/*
+	* Consumer. Writes type, index, frame for as many whole events as fit in `capacity` doubles and removes them.
+	* Returns how many it wrote, anything that didn't fit stays for the next call.
+	*/
+	int drain(double* out, int outCapacity) {
+		unsigned int read = readIndex.load(std::memory_order_relaxed);
+		unsigned int available = writeIndex.load(std::memory_order_acquire) - read;
+		int count = (int)std::min(available, (unsigned int)std::max(0, outCapacity / eventSize));
+		for (int i = 0; i < count; ++i) {
+			const MixerEvent& event = events[(read + i) & (capacity - 1)];
+			out[i * eventSize] = event.type;
+			out[i * eventSize + 1] = event.index;
+			out[i * eventSize + 2] = (double)event.frame;
+		}
+		readIndex.store(read + count, std::memory_order_release);
+		return count;
+	}
+
+	/* Consumer. Throws away everything queued, e.g. what's left over from the previous song. */
+	void clear() {
+		readIndex.store(writeIndex.load(std::memory_order_acquire), std::memory_order_release);
+	}
+
+private:
+	MixerEvent events[capacity];
+	std::atomic<unsigned int> writeIndex{0}, readIndex{0};
+};
+
+/*
+* Frames the game wants to hear about, sorted. Only touched with decoderMutex held.
+*/
+class MarkerList {
+public:
+	void add(int id, ma_uint64 frame) {
+		Marker marker{frame, id};
+		markers.insert(std::upper_bound(markers.begin(), markers.end(), marker), marker);
+	}
+	void clear() {
+		markers.clear();
+	}
+
+	/* Pushes a MARKER event for every marker in [startFrame, endFrame). */
+	void pushHits(EventQueue& queue, ma_uint64 startFrame, ma_uint64 endFrame) const {
+		if (endFrame <= startFrame) return; // Seeked back, or didn't move
+		auto first = std::lower_bound(markers.begin(), markers.end(), Marker{startFrame, INT_MIN});
+		for (auto it = first; it != markers.end() && it->frame < endFrame; ++it) {
+			queue.push(5, it->id, it->frame);
+		}
+	}
+
+private:
+	struct Marker {
+		ma_uint64 frame;
+		int id;
+		bool operator<(const Marker& other) const {
+			return frame < other.frame || (frame == other.frame && id < other.id);
+		}
+	};
+	std::vector<Marker> markers;
+};
+
+#endif /* MA_EVENTS_H */
@@ -0,0 +1,333 @@
+#ifndef MA_LOOP_H
+#define MA_LOOP_H
+
+/*
+	* An A-B loop for practice mode, wrapped by the audio thread on the exact frame instead of the game seeking when it
+	* notices it went past the end.
+
+	* The start of the loop (up to maxWindowSeconds of it, so usually the whole loop) is decoded into memory on a worker
+	* thread, and the loop only engages once that's done. From then on the stems are read through read(): at the end
+	* it carries on from the window rather than seeking the decoders, so looping costs nothing while the whole loop
+	* fits. A longer loop can't keep all of it, so past the window each stem reads from one of two spare decoders (tails)
+	* that the worker parks exactly where the window ends, by decoding up to there like the window itself rather than
+	* seeking. At every wrap the stem hands the tail it played to the end back to the worker and takes the other one,
+	* so the audio thread never seeks and the window runs into the tail sample for sample. Only if the worker hasn't
+	* got a tail there yet (a very slow decoder and a loop barely longer than the window) does the wrap seek the stem's
+	* own decoder instead, which is slow and lands roughly where the window ends.
+
+	* With a crossfade, the last crossfadeFrames before the end are blended into the first ones of the window and the
+	* loop carries on after them. Everything happens before the stretcher, so it wraps the same at any rate.
+
+	* Needs miniaudio.h, ma_resampler.h and ma_sources.h included before it.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+class LoopRegion {
+public:
+	static constexpr double maxWindowSeconds = 30;
+
+	~LoopRegion() {
+		cancel();
+	}
+
+	/*
+	* With decoderMutex held, since the audio thread reads all of this. Sets up [startFrame, endFrame) for
+	* `stemCount` stems, then launch() decodes it once the mutex is released. Call stop() and cancel() first if there
+	* was a loop before.
+	*/
+	void configure(size_t stemCount, ma_uint32 channels, ma_uint32 sampleRate, ma_uint64 startFrame, ma_uint64 endFrame, ma_uint32 crossfadeFrames) {
+		loopStart = startFrame;
+		loopEnd = endFrame;
+		crossfade = crossfadeFrames;
+		windowFrames = std::min<ma_uint64>(endFrame - startFrame, (ma_uint64)(maxWindowSeconds * sampleRate));
+		loopChannels = channels;
+		stems = std::vector<Stem>(stemCount);
+		wrapCount = 0;
+		cancelled = false;
+		configured = true;
+	}
+
+	/*
+	* Without decoderMutex held, after configure(). Starts decoding the start of the loop for every stem in the
+	* background. For a loop longer than the window the worker then stays up, parking tails until cancel().
+	*/
+	void launch(const std::vector<StemSource>& sources, ma_uint32 sampleRate) {
+		worker = std::thread([this, sources, sampleRate]() {
+			for (size_t i = 0; i < sources.size() && i < stems.size() && !cancelled; ++i) {
+				decodeWindow(sources[i], sampleRate, stems[i]);
+			}
+			if (cancelled) return;
+			ready.store(true, std::memory_order_release);
+
+			while (longLoop() && !cancelled) {
+				for (size_t i = 0; i < sources.size() && i < stems.size() && !cancelled; ++i) {
+					for (Tail& tail : stems[i].tails) {
+						if (tail.state.load(std::memory_order_acquire) == tailStale) parkTail(sources[i], sampleRate, tail);
+					}
+				}
+				std::this_thread::sleep_for(std::chrono::milliseconds(20)); // A whole pass of the loop to get one back
+			}
+		});
+	}
+
+	/*
+	* With decoderMutex held, or while the audio thread isn't running. The audio thread neither engages nor reads
+	* through the loop after this, so cancel() can free it.
+	*/
+	void stop() {
+		configured = false;
+		isEngaged = false;
+	}
+
+	/* Without decoderMutex held, after stop(): waits for the worker and frees the loop. */
+	void cancel() {
+		cancelled = true;
+		if (worker.joinable()) worker.join();
+		for (Stem& stem : stems) {
+			for (Tail& tail : stem.tails) {
+				if (tail.open) ma_decoder_uninit(&tail.decoder);
+			}
+		}
+		stems.clear();
+		ready.store(false, std::memory_order_relaxed);
+	}
+
+	/* Set, whether or not it's ready. */
+	bool active() const {
+		return configured;
+	}
+	bool canEngage() const {
+		return configured && !isEngaged && ready.load(std::memory_order_acquire);
+	}
+	bool engaged() const {
+		return isEngaged;
+	}
+
+	/* With decoderMutex held. Every stem is at song frame `position`, reads from here on go through the loop. */
+	void engage(ma_uint64 position, ma_uint32 countedStem) {
+		for (Stem& stem : stems) {
+			stem.position = position;
+			stem.inWindow = false;
+			releaseTail(stem);
+		}
+		wrapStem = countedStem;
+		isEngaged = true;
+	}
+
+	/* With decoderMutex held, after the decoders were seeked to `position`. They're read again from there. */
+	void seek(ma_uint64 position) {
+		for (Stem& stem : stems) {
+			stem.position = position;
+			stem.inWindow = false;
+			releaseTail(stem);
+		}
+	}
+
+	/* With decoderMutex held. Whether every stem has a tail parked for its next wrap, or needs none, so none will seek. */
+	bool tailsParked() const {
+		for (const Stem& stem : stems) {
+			bool parked = !longLoop();
+			for (const Tail& tail : stem.tails) {
+				parked = parked || tail.state.load(std::memory_order_acquire) == tailReady;
+			}
+			if (!parked) return false;
+		}
+		return true;
+	}
+
+	/* The song frame stem `index` reads next. Only meaningful while engaged. */
+	ma_uint64 position(ma_uint32 index) const {
+		return stems[index].position;
+	}
+
+	/* How many times the loop has wrapped, counted on one stem. */
+	ma_uint32 wraps() const {
+		return wrapCount;
+	}
+	ma_uint64 startFrame() const {
+		return loopStart;
+	}
+	ma_uint64 endFrame() const {
+		return loopEnd;
+	}
+	/* Where playback carries on after a wrap. */
+	ma_uint64 resumeFrame() const {
+		return loopStart + crossfade;
+	}
+
+	/*
+	* Audio thread, with decoderMutex held. Reads up to frameCount frames of stem `index` into pFrames (interleaved),
+	* wrapping at the end of the loop. Before the end a stem that runs out early is padded with silence so it keeps time
+	* with the others. Only returns less than frameCount once the stem is past both the loop and its own end.
+	*/
+	ma_uint64 read(ma_uint32 index, ma_decoder* pDecoder, float* pFrames, ma_uint64 frameCount) {
+		Stem& stem = stems[index];
+		ma_uint64 done = 0;
+		while (done < frameCount) {
+			float* pOut = pFrames + done * loopChannels;
+			ma_uint64 want = frameCount - done;
+			bool beforeEnd = stem.position < loopEnd;
+			if (beforeEnd) want = std::min(want, loopEnd - stem.position);
+
+			ma_uint64 got = 0;
+			if (stem.inWindow) {
+				ma_uint64 offset = stem.position - loopStart;
+				got = std::min(want, windowFrames - offset);
+				memcpy(pOut, stem.window.data() + offset * loopChannels, sizeof(float) * got * loopChannels);
+			} else {
+				if (stem.tail < 0) {
+					ma_decoder_read_pcm_frames(pDecoder, pOut, want, &got);
+				} else if (stem.tails[stem.tail].open) {
+					ma_decoder_read_pcm_frames(&stem.tails[stem.tail].decoder, pOut, want, &got);
+				}
+				if (got < want && beforeEnd) {
+					memset(pOut + got * loopChannels, 0, sizeof(float) * (want - got) * loopChannels);
+					got = want;
+				}
+				if (got == 0) break; // Really over
+			}
+
+			if (beforeEnd) blendCrossfade(stem, pOut, got);
+			stem.position += got;
+			done += got;
+
+			if (beforeEnd && stem.position == loopEnd) {
+				wrap(stem, pDecoder, index);
+			} else if (stem.inWindow && stem.position == loopStart + windowFrames) {
+				stem.inWindow = false; // A tail (or the stem's decoder) picks up right here
+			}
+		}
+		return done;
+	}
+
+private:
+	/*
+	* Stale: the worker's, to (re)open and park at the end of the window. Ready: parked there, the audio thread takes it
+	* at the next wrap. Playing: the audio thread reads it until the wrap after that hands it back.
+	*/
+	enum TailState { tailStale, tailReady, tailPlaying };
+
+	struct Tail {
+		ma_decoder decoder;
+		bool open = false; // Published with the state, by whichever thread owns it
+		std::atomic<int> state{tailStale};
+	};
+
+	struct Stem {
+		std::vector<float> window; // [loopStart, loopStart + windowFrames), interleaved
+		ma_uint64 position = 0;
+		bool inWindow = false;
+		Tail tails[2]; // Only for a loop longer than the window
+		int tail = -1; // The one read after the window, -1 = the stem's own decoder
+	};
+
+	std::vector<Stem> stems;
+	ma_uint64 loopStart = 0, loopEnd = 0, windowFrames = 0;
+	ma_uint32 crossfade = 0, loopChannels = 2;
+	ma_uint32 wrapStem = 0, wrapCount = 0;
+	bool configured = false, isEngaged = false;
+
+	std::thread worker;
+	std::atomic<bool> cancelled{false};
+	std::atomic<bool> ready{false};
+
+	bool longLoop() const {
+		return windowFrames < loopEnd - loopStart;
+	}
+
+	/*
+	* Opens `source` and decodes up to `frame` rather than seeking there: a seek through the resampler lands a few
+	* dozen frames off what the decoders play, and everything here has to line up with them sample for sample.
+	* Returns whether it got there, the decoder is left open either way unless it failed to open.
+	*/
+	bool openAt(const StemSource& source, ma_uint32 sampleRate, ma_decoder* pDecoder, ma_uint64 frame, bool& opened) {
+		ma_decoder_config config = polyphase_decoder_config_init(ma_format_f32, loopChannels, sampleRate);
+		opened = source.open(&config, pDecoder) == MA_SUCCESS;
+		if (!opened) {
+			printf("Loop: failed to load %s.\n", source.path.c_str());
+			return false;
+		}
+		float skip[4096];
+		ma_uint64 skipBlock = 4096 / loopChannels;
+		ma_uint64 skipped = 0;
+		while (skipped < frame && !cancelled) {
+			ma_uint64 framesRead = 0;
+			ma_decoder_read_pcm_frames(pDecoder, skip, std::min(skipBlock, frame - skipped), &framesRead);
+			if (framesRead == 0) break;
+			skipped += framesRead;
+		}
+		return skipped == frame && !cancelled;
+	}
+
+	// A long loop keeps the decoder as its first tail, it's left right where the window ends
+	void decodeWindow(const StemSource& source, ma_uint32 sampleRate, Stem& stem) {
+		stem.window.assign(windowFrames * loopChannels, 0); // Stays silent past the end of a shorter stem
+		ma_decoder local;
+		Tail& first = stem.tails[0];
+		ma_decoder* pDecoder = longLoop() ? &first.decoder : &local;
+		bool opened = false;
+		if (openAt(source, sampleRate, pDecoder, loopStart, opened)) {
+			ma_decoder_read_pcm_frames(pDecoder, stem.window.data(), windowFrames, NULL);
+		}
+		if (!longLoop()) {
+			if (opened) ma_decoder_uninit(&local);
+			return;
+		}
+		first.open = opened;
+		first.state.store(tailReady, std::memory_order_release);
+	}
+
+	// Worker, for a tail that's stale
+	void parkTail(const StemSource& source, ma_uint32 sampleRate, Tail& tail) {
+		if (tail.open) ma_decoder_uninit(&tail.decoder);
+		openAt(source, sampleRate, &tail.decoder, loopStart + windowFrames, tail.open);
+		if (!cancelled) tail.state.store(tailReady, std::memory_order_release);
+	}
+
+	void releaseTail(Stem& stem) {
+		if (stem.tail < 0) return;
+		stem.tails[stem.tail].state.store(tailStale, std::memory_order_release);
+		stem.tail = -1;
+	}
+
+	// The last `crossfade` frames before the end fade out while the start of the window fades in
+	void blendCrossfade(const Stem& stem, float* pOut, ma_uint64 frameCount) {
+		if (crossfade == 0 || stem.position + frameCount <= loopEnd - crossfade) return;
+		for (ma_uint64 f = 0; f < frameCount; ++f) {
+			ma_uint64 position = stem.position + f;
+			if (position < loopEnd - crossfade) continue;
+			ma_uint64 k = position - (loopEnd - crossfade);
+			float fadeIn = ((float)k + 0.5f) / crossfade;
+			const float* pStart = stem.window.data() + k * loopChannels;
+			for (ma_uint32 c = 0; c < loopChannels; ++c) {
+				float& sample = pOut[f * loopChannels + c];
+				sample = sample * (1 - fadeIn) + pStart[c] * fadeIn;
+			}
+		}
+	}
+
+	void wrap(Stem& stem, ma_decoder* pDecoder, ma_uint32 index) {
+		stem.position = resumeFrame();
+		stem.inWindow = true;
+		if (longLoop()) {
+			// The tail that played up to the end goes back to the worker, the other one picks up where the window ends
+			releaseTail(stem);
+			for (int t = 0; t < 2 && stem.tail < 0; ++t) {
+				if (stem.tails[t].state.load(std::memory_order_acquire) == tailReady) {
+					stem.tails[t].state.store(tailPlaying, std::memory_order_relaxed);
+					stem.tail = t;
+				}
+			}
+			if (stem.tail < 0) ma_decoder_seek_to_pcm_frame(pDecoder, loopStart + windowFrames);
+		}
+		if (index == wrapStem) ++wrapCount;
+	}
+};
+
+#endif /* MA_LOOP_H */
@@ -0,0 +1,163 @@
+#ifndef MA_METERS_H
+#define MA_METERS_H
+
+/*
+	* Level meters for the UI, one per stem plus one for the whole mix.
+	* The audio thread only folds samples into short blocks (peak + mean square), the envelopes run once per block,
+	* so metering costs a couple of operations per sample. Readings are handed over through a triple buffer: the
+	* audio thread never waits for the reader, and the reader always sees a whole set from the same callback.
+
+	* Needs signalsmith-stretch's dsp/envelopes.h included before it.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+/*
+* Single writer, single reader, lock-free. The writer fills back() and publish()es it, the reader calls acquire()
+* to pick up the newest published slot (if any) and reads front(). Neither side ever touches the other's slot.
+*/
+template<typename T>
+class TripleBuffer {
+public:
+	T& back() {
+		return slots[backIndex];
+	}
+	void publish() {
+		int spare = shared.exchange(backIndex | freshBit, std::memory_order_acq_rel);
+		backIndex = spare & indexMask;
+	}
+
+	// Returns true if front() changed
+	bool acquire() {
+		if (!(shared.load(std::memory_order_relaxed) & freshBit)) return false;
+		int spare = shared.exchange(frontIndex, std::memory_order_acq_rel);
+		frontIndex = spare & indexMask;
+		return true;
+	}
+	const T& front() const {
+		return slots[frontIndex];
+	}
+
+	// Not thread-safe, only while nothing is reading or writing
+	void reset(const T& value) {
+		for (T& slot : slots) slot = value;
+		backIndex = 0;
+		frontIndex = 1;
+		shared = 2;
+	}
+
+private:
+	static constexpr int indexMask = 3, freshBit = 4;
+	T slots[3];
+	int backIndex = 0, frontIndex = 1;
+	std::atomic<int> shared{2}; // Index of the spare slot, plus freshBit if it was published since the last acquire()
+};
+
+struct MeterReading {
+	float peak = 0; // Decays linearly back to silence
+	float hold = 0; // Loudest peak of the last second
+	float rms = 0; // Over the last 300ms
+};
+
+class StemMeters {
+public:
+	static constexpr int blockFrames = 64;
+
+	/*
+	* Not thread-safe, call before the device starts pulling audio.
+	*/
+	void configure(int meterCount, double sampleRate) {
+		double blockRate = sampleRate / blockFrames;
+		meters.clear();
+		for (int i = 0; i < meterCount; ++i) {
+			meters.emplace_back(new Meter((int)std::ceil(blockRate * peakDecaySeconds), (int)std::ceil(blockRate * holdSeconds), (int)std::ceil(blockRate * rmsSeconds)));
+		}
+		readings.reset(std::vector<MeterReading>(meterCount));
+	}
+
+	/*
+	* Audio thread. Frame i, channel c of `data` is at data[i * frameStride + c], and gets multiplied by `gain`.
+	* NULL data is silence, so meters of stems that stopped still fall back down.
+	*/
+	void add(int meter, const float* data, ma_uint32 frames, int channels, int frameStride, float gain) {
+		if (meter < 0 || meter >= (int)meters.size()) return;
+		Meter& m = *meters[meter];
+		float absGain = std::abs(gain), squareGain = gain * gain / channels;
+
+		for (ma_uint32 i = 0; i < frames; ++i) {
+			if (data != NULL) {
+				const float* frame = data + i * frameStride;
+				for (int c = 0; c < channels; ++c) {
+					float v = frame[c];
+					m.blockPeak = std::max(m.blockPeak, std::abs(v) * absGain);
+					m.blockSquares += v * v * squareGain;
+				}
+			}
+			if (++m.blockCount == blockFrames) {
+				m.reading.peak = m.peak(m.blockPeak);
+				m.reading.hold = m.hold(m.blockPeak);
+				m.reading.rms = std::sqrt(std::max(0.0f, m.meanSquare(m.blockSquares / blockFrames)));
+				m.blockPeak = m.blockSquares = 0;
+				m.blockCount = 0;
+			}
+		}
+	}
+
+	/*
+	* Audio thread, once per callback after every add().
+	*/
+	void publish() {
+		std::vector<MeterReading>& slot = readings.back();
+		for (size_t i = 0; i < meters.size() && i < slot.size(); ++i) {
+			slot[i] = meters[i]->reading;
+		}
+		readings.publish();
+	}
+
+	/*
+	* Audio thread. The reading as of the last whole block, before it's published.
+	*/
+	MeterReading latest(int meter) const {
+		if (meter < 0 || meter >= (int)meters.size()) return MeterReading();
+		return meters[meter]->reading;
+	}
+
+	/*
+	* Reader thread. Writes peak, hold, rms for as many whole meters as fit, returns how many meters there are.
+	*/
+	int read(double* out, int capacity) {
+		readings.acquire();
+		const std::vector<MeterReading>& slot = readings.front();
+		for (size_t i = 0; i < slot.size() && (int)(i * 3 + 3) <= capacity; ++i) {
+			out[i * 3] = slot[i].peak;
+			out[i * 3 + 1] = slot[i].hold;
+			out[i * 3 + 2] = slot[i].rms;
+		}
+		return (int)slot.size();
+	}
+
+private:
+	static constexpr double peakDecaySeconds = 1.5, holdSeconds = 1, rmsSeconds = 0.3;
+
+	struct Meter {
+		signalsmith::envelopes::PeakDecayLinear<float> peak;
+		signalsmith::envelopes::PeakHold<float> hold;
+		signalsmith::envelopes::BoxFilter<float> meanSquare;
+		float blockPeak = 0, blockSquares = 0;
+		int blockCount = 0;
+		MeterReading reading;
+
+		Meter(int peakBlocks, int holdBlocks, int rmsBlocks) : peak(peakBlocks), hold(holdBlocks), meanSquare(rmsBlocks) {
+			peak.reset(0);
+			hold.reset(0);
+		}
+	};
+	std::vector<std::unique_ptr<Meter>> meters;
+	TripleBuffer<std::vector<MeterReading>> readings;
+};
+
+#endif /* MA_METERS_H */
@@ -0,0 +1,93 @@
+#ifndef MA_MIXER_H
+#define MA_MIXER_H
+
+/*
+	* The mixer engine's C interface, implemented once in ma_mixer.cpp. Both Haxe bindings forward straight to it
+	* (include/ma_thing.h for hxcpp, ma_thing_hl.cpp for HashLink), and anything else that wants the engine (a
+	* headless test, a benchmark) can link it through this header alone.
+	* Plain C types only, no C++ crosses this line.
+
+	* Times are in milliseconds, frames are PCM frames at 44.1kHz.
+*/
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Loading, every load replaces the previous song */
+void mixer_load_files(const char* const* paths, int count);
+void mixer_load_from_memory(const void* const* data, const int* sizes, int count);
+void mixer_destroy(void);
+
+int mixer_mount_pack(const char* path);
+void mixer_unmount_pack(void);
+int mixer_add_pack_entry(const char* name, int64_t offset, int64_t size);
+
+/* Transport */
+void mixer_start(void);
+void mixer_stop(void);
+int mixer_stopped(void);
+int mixer_get_state(void);
+double mixer_get_playback_position(void);
+double mixer_get_duration(void);
+void mixer_seek_to_pcm_frame(int64_t pos);
+int mixer_set_loop(int64_t startFrame, int64_t endFrame, int crossfadeFrames);
+void mixer_clear_loop(void);
+
+/* Playback rate */
+void mixer_set_playback_rate(float value);
+void mixer_set_stretch_preset(int preset);
+void mixer_set_rate_mode(int mode);
+void mixer_set_stretch_seed(int seed);
+void mixer_set_prerender_rates(const float* rates, int count);
+
+/* Stems and the mix bus */
+void mixer_deactivate_stem(int index);
+void mixer_set_stem_volume(int index, double volume);
+void mixer_set_stem_pan(int index, double pan);
+void mixer_set_stem_mute(int index, int muted);
+void mixer_set_stem_filter(int index, int type, double frequency, double gainDb, double q);
+void mixer_set_reverb(int mode, double send, double roomMs, double decaySeconds, double dampingHz);
+
+/* Scheduled on song frames */
+int mixer_schedule_change(int type, int index, double value, int64_t frame);
+void mixer_clear_schedule(void);
+
+/* Polled by the game */
+int mixer_get_stem_meters(double* out, int capacity);
+int mixer_get_snapshot(double* out, int capacity);
+int mixer_get_telemetry_json(char* out, int capacity);
+void mixer_reset_telemetry(void);
+int mixer_poll_events(double* out, int capacity);
+void mixer_add_marker(int id, int64_t frame);
+void mixer_clear_markers(void);
+void mixer_set_conductor_map(const double* changes, int count);
+void mixer_set_conductor_ticks(int mode);
+
+/* Sound effects, mixed after the music */
+int mixer_load_sfx(const char* path);
+int mixer_load_sfx_from_memory(const void* data, int size);
+void mixer_unload_sfx(int id);
+int mixer_play_sfx(int id, double gain, double pan, int64_t frame);
+void mixer_stop_sfx(void);
+
+/* Song select previews, on their own device */
+int mixer_preview_files(const char* const* paths, int count, int64_t startFrame, int fadeFrames);
+void mixer_stop_preview(int fadeFrames);
+void mixer_close_preview(void);
+
+/* Waveforms */
+void mixer_set_waveform_mode(int mode);
+const float* mixer_get_stem_pcm(int index);
+int mixer_get_stem_frames(int index);
+int mixer_get_stem_peak_levels(int index);
+const float* mixer_get_stem_peaks(int index, int level);
+int mixer_get_stem_peak_count(int index, int level);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MA_MIXER_H */
\ No newline at end of file
@@ -0,0 +1,185 @@
+#ifndef MA_PRERENDER_H
+#define MA_PRERENDER_H
+
+/*
+	* Renders the mixed song through the offline stretcher at a few fixed playback rates, on worker threads.
+	* Once a rate is ready, playing at that rate is a plain buffer read - no STFT on the audio thread at all.
+	* Any other rate still gets stretched live.
+
+	* Needs miniaudio.h, signalsmith-stretch.h, ma_resampler.h and ma_sources.h included before it.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct PrerenderedRate {
+	float rate = 1;
+	std::vector<float> pcm; // Interleaved, starts at song frame 0 (stretch latency already trimmed off)
+	ma_uint64 frameCount = 0;
+	std::atomic<int> ready{0};
+};
+
+class PrerenderCache {
+public:
+	~PrerenderCache() {
+		cancel();
+	}
+
+	/*
+	* Starts rendering in the background. `onReady` is called from a worker thread each time a rate finishes.
+	* The stems are re-opened from `sources`, since the playback decoders belong to the audio thread.
+	* A negative `seed` seeds the stretchers randomly.
+	*/
+	void start(const std::vector<StemSource>& sources, const std::vector<float>& rates, ma_uint32 channels, ma_uint32 sampleRate, long seed, std::function<void()> onReady) {
+		cancel();
+		if (sources.empty() || rates.empty()) return;
+
+		cancelled = false;
+		variants.clear();
+		for (float rate : rates) {
+			if (rate <= 0 || std::abs(rate - 1) < rateTolerance) continue; // 1x never goes through the stretcher anyway
+			std::unique_ptr<PrerenderedRate> variant(new PrerenderedRate());
+			variant->rate = rate;
+			variants.push_back(std::move(variant));
+		}
+		if (variants.empty()) return;
+
+		worker = std::thread([this, sources, channels, sampleRate, seed, onReady]() {
+			std::vector<float> source;
+			ma_uint64 sourceFrames = decodeMix(sources, channels, sampleRate, source);
+			if (sourceFrames == 0 || cancelled) return;
+
+			// One thread per rate, they only share the (read-only) source mix
+			std::vector<std::thread> renderers;
+			for (auto& variant : variants) {
+				PrerenderedRate* target = variant.get();
+				renderers.emplace_back([this, &source, sourceFrames, target, channels, sampleRate, seed, onReady]() {
+					if (render(source.data(), sourceFrames, channels, sampleRate, seed, *target) && !cancelled) {
+						target->ready = 1;
+						if (onReady) onReady();
+					}
+				});
+			}
+			for (auto& renderer : renderers) {
+				renderer.join();
+			}
+		});
+	}
+
+	/* Stops any rendering in progress and drops all the variants. Don't call this while the audio thread might be reading one. */
+	void cancel() {
+		cancelled = true;
+		if (worker.joinable()) worker.join();
+		variants.clear();
+	}
+
+	/* Returns the finished variant for this rate, or NULL if there isn't one (yet). */
+	PrerenderedRate* find(float rate) {
+		for (auto& variant : variants) {
+			if (variant->ready && std::abs(variant->rate - rate) < rateTolerance) {
+				return variant.get();
+			}
+		}
+		return NULL;
+	}
+
+private:
+	static constexpr float rateTolerance = 0.005f; // Speeds are nudged in 0.1 steps, so they pick up float error
+	static constexpr ma_uint32 renderBlockFrames = 1024;
+
+	std::vector<std::unique_ptr<PrerenderedRate>> variants;
+	std::thread worker;
+	std::atomic<bool> cancelled{false};
+
+	ma_uint64 decodeMix(const std::vector<StemSource>& sources, ma_uint32 channels, ma_uint32 sampleRate, std::vector<float>& mix) {
+		ma_decoder_config config = polyphase_decoder_config_init(ma_format_f32, channels, sampleRate);
+		std::vector<float> temp(renderBlockFrames * channels);
+		ma_uint64 mixFrames = 0;
+
+		for (const StemSource& source : sources) {
+			ma_decoder decoder;
+			if (source.open(&config, &decoder) != MA_SUCCESS) {
+				printf("Pre-render: failed to load %s.\n", source.path.c_str());
+				return 0;
+			}
+
+			ma_uint64 length = 0;
+			ma_decoder_get_length_in_pcm_frames(&decoder, &length);
+			if (length * channels > mix.size()) mix.resize(length * channels, 0);
+
+			ma_uint64 cursor = 0;
+			while (!cancelled) {
+				ma_uint64 framesRead = 0;
+				ma_result result = ma_decoder_read_pcm_frames(&decoder, temp.data(), renderBlockFrames, &framesRead);
+				if (framesRead == 0) break;
+
+				if ((cursor + framesRead) * channels > mix.size()) mix.resize((cursor + framesRead) * channels, 0); // Unknown/wrong length
+				float* out = mix.data() + cursor * channels;
+				for (ma_uint64 i = 0; i < framesRead * channels; ++i) {
+					out[i] += temp[i];
+				}
+				cursor += framesRead;
+
+				if (result != MA_SUCCESS) break;
+			}
+			ma_decoder_uninit(&decoder);
+			if (cursor > mixFrames) mixFrames = cursor;
+		}
+		return mixFrames;
+	}
+
+	bool render(const float* source, ma_uint64 sourceFrames, ma_uint32 channels, ma_uint32 sampleRate, long seed, PrerenderedRate& variant) {
+		signalsmith::stretch::SignalsmithStretch stretch(seed >= 0 ? seed : (long)std::random_device{}());
+		stretch.presetDefault((int)channels, (float)sampleRate); // We're not in a hurry, so use the best quality
+
+		const double rate = variant.rate;
+		// Input frame 0 comes out after half a block (the analysis) plus half a block at the output rate (the synthesis)
+		const double blockSamples = stretch.blockSamples();
+		const ma_uint64 latencyFrames = (ma_uint64)std::llround(blockSamples * 0.5 + blockSamples * 0.5 / rate);
+		const ma_uint64 outputFrames = (ma_uint64)std::ceil(sourceFrames / rate);
+		const ma_uint64 totalFrames = latencyFrames + outputFrames;
+
+		variant.pcm.assign(outputFrames * channels, 0);
+		variant.frameCount = outputFrames;
+
+		std::vector<float> input(((size_t)std::ceil(renderBlockFrames * rate) + 2) * channels);
+		std::vector<float> output(renderBlockFrames * channels);
+
+		for (ma_uint64 outputStart = 0; outputStart < totalFrames; outputStart += renderBlockFrames) {
+			if (cancelled) return false;
+
+			// Positions are worked out from the running total, so rounding doesn't drift over a whole song
+			ma_uint64 outputBlock = (std::min)((ma_uint64)renderBlockFrames, totalFrames - outputStart);
+			ma_uint64 inputStart = (ma_uint64)std::llround(outputStart * rate);
+			ma_uint64 inputEnd = (ma_uint64)std::llround((outputStart + outputBlock) * rate);
+			ma_uint64 inputBlock = inputEnd - inputStart;
+
+			for (ma_uint64 i = 0; i < inputBlock; ++i) {
+				ma_uint64 frame = inputStart + i;
+				for (ma_uint32 c = 0; c < channels; ++c) {
+					input[i * channels + c] = frame < sourceFrames ? source[frame * channels + c] : 0;
+				}
+			}
+			stretch.process(input.data(), (int)inputBlock, output.data(), (int)outputBlock);
+
+			for (ma_uint64 i = 0; i < outputBlock; ++i) {
+				ma_uint64 frame = outputStart + i;
+				if (frame < latencyFrames) continue;
+				frame -= latencyFrames;
+				if (frame >= outputFrames) break;
+				for (ma_uint32 c = 0; c < channels; ++c) {
+					variant.pcm[frame * channels + c] = output[i * channels + c];
+				}
+			}
+		}
+		return true;
+	}
+};
+
+#endif /* MA_PRERENDER_H */
@@ -0,0 +1,319 @@
+#ifndef MA_PREVIEW_H
+#define MA_PREVIEW_H
+
+/*
+	* Song previews for the song select menu, played on a device of their own so nothing about the loaded song
+	* (or the lack of one) gets in the way. Highlighting a song opens its stems straight at the preview point, fades
+	* them in and fades out whatever was previewing before: no load, no seek, nothing to destroy.
+
+	* A fixed pool of slots holds the decoders. One worker thread opens them, so play() returns straight away and
+	* scrolling past ten songs only ever opens the last one: a request that's been replaced is dropped between stems.
+	* The decoders use the default linear resampler and ask the backend for a seek table (MP3 builds one from the
+	* frame headers), so opening one at a minute in is a few milliseconds rather than decoding the whole minute.
+
+	* The audio thread never locks. Each slot's state is atomic: it only reads slots that are playing and flips them
+	* to retired once they've faded out or run out, then hands them back with a flag and a notify. The worker closes
+	* retired decoders, so no file is ever closed on the audio thread. The lock is only between the game thread and
+	* the worker, and nothing gets built or copied while it's held.
+
+	* Needs miniaudio.h and ma_sources.h included before it.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class PreviewPlayer {
+public:
+	static constexpr int slotCount = 4; // One coming in, a few going out
+	static constexpr int maxStems = 8;
+	static constexpr ma_uint32 seekPoints = 1024;
+
+	~PreviewPlayer() {
+		close();
+	}
+
+	/*
+	* Game thread. Opens `sources` at `startFrame` in the background and fades them in over `fadeFrames`, fading out
+	* whatever's playing now. Replaces any preview that hasn't opened yet.
+	*/
+	void play(const std::vector<StemSource>& sources, ma_uint32 channels, ma_uint32 sampleRate, ma_uint64 startFrame, ma_uint32 fadeFrames) {
+		Request next; // The one it replaces is freed with this, after unlocking
+		next.sources.assign(sources.begin(), sources.begin() + std::min<size_t>(sources.size(), maxStems));
+		next.channels = channels;
+		next.sampleRate = sampleRate;
+		next.startFrame = startFrame;
+		next.fadeFrames = fadeFrames;
+
+		std::lock_guard<std::mutex> guard(lock);
+		if (!worker.joinable()) {
+			quitting = false;
+			worker = std::thread([this]() {
+				work();
+			});
+		}
+		fadeOutAll(fadeFrames);
+		std::swap(request, next);
+		++generation;
+		requestPending = true;
+		wake.notify_one();
+	}
+
+	/* Game thread. Fades out whatever's playing and drops a preview that hasn't opened yet. */
+	void stop(ma_uint32 fadeFrames) {
+		std::lock_guard<std::mutex> guard(lock);
+		fadeOutAll(fadeFrames);
+		++generation;
+		requestPending = false;
+		wake.notify_one(); // Tidy up what's already retired
+	}
+
+	/* Game thread. Stops the worker and closes every decoder. The audio thread mustn't be mixing any more. */
+	void close() {
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			quitting = true;
+			++generation;
+			wake.notify_one();
+		}
+		if (worker.joinable()) worker.join();
+		for (Slot& slot : slots) {
+			closeDecoders(slot);
+			slot.state.store(Slot::FREE, std::memory_order_relaxed);
+		}
+		requestPending = false;
+	}
+
+	/* Audio thread, lock-free. Adds every playing slot on top of `out` (interleaved, `channels` wide). */
+	void mix(float* out, ma_uint32 frameCount, ma_uint32 channels) {
+		bool retiredNow = false;
+		for (Slot& slot : slots) {
+			if (slot.state.load(std::memory_order_acquire) != Slot::PLAYING) continue;
+
+			ma_uint32 done = 0;
+			bool anyLeft = !slot.cut.load(std::memory_order_relaxed);
+			float gain = slot.gain.load(std::memory_order_relaxed), gainStep = 0;
+			while (done < frameCount && anyLeft) {
+				ma_uint32 blockFrames = std::min(frameCount - done, mixBlockSamples / channels);
+				std::fill(sum, sum + blockFrames * channels, 0.0f);
+				anyLeft = false;
+				for (int i = 0; i < slot.stemCount; ++i) {
+					if (!slot.stemActive[i]) continue;
+					ma_uint64 framesRead = 0;
+					ma_decoder_read_pcm_frames(&slot.decoders[i], stemBuffer, blockFrames, &framesRead);
+					for (ma_uint64 s = 0; s < framesRead * channels; ++s) {
+						sum[s] += stemBuffer[s];
+					}
+					if (framesRead < blockFrames) {
+						slot.stemActive[i] = false;
+					} else {
+						anyLeft = true;
+					}
+				}
+
+				float* dst = out + done * channels;
+				gainStep = slot.gainStep.load(std::memory_order_relaxed);
+				for (ma_uint32 f = 0; f < blockFrames; ++f) {
+					gain = std::max(0.0f, std::min(1.0f, gain + gainStep));
+					for (ma_uint32 c = 0; c < channels; ++c) {
+						dst[f * channels + c] += sum[f * channels + c] * gain;
+					}
+				}
+				done += blockFrames;
+				if (gainStep < 0 && gain <= 0) anyLeft = false; // Faded out
+			}
+			slot.gain.store(gain, std::memory_order_relaxed);
+			if (!anyLeft) {
+				slot.state.store(Slot::RETIRED, std::memory_order_release);
+				retiredNow = true;
+			}
+		}
+		if (retiredNow) {
+			retiredAny.store(true, std::memory_order_release);
+			wake.notify_one(); // Without the lock, so it can come too early: the worker also looks now and then
+		}
+	}
+
+	/* Whether anything is playing or about to. */
+	bool active() {
+		std::lock_guard<std::mutex> guard(lock);
+		if (requestPending) return true;
+		for (const Slot& slot : slots) {
+			int state = slot.state.load(std::memory_order_relaxed);
+			if (state == Slot::PLAYING || state == Slot::LOADING) return true;
+		}
+		return false;
+	}
+
+private:
+	static constexpr ma_uint32 mixBlockSamples = 4096;
+	static constexpr int retiredCheckMs = 100; // In case the audio thread's notify came before the worker waited
+
+	/*
+	* Only the audio thread takes a slot out of PLAYING (to RETIRED), only the worker moves it on from the others, with
+	* the lock held. The decoders and stemActive belong to whichever of them the state says.
+	*/
+	struct Slot {
+		enum State { FREE, LOADING, PLAYING, RETIRED };
+		std::atomic<int> state{FREE};
+		ma_decoder decoders[maxStems]; // ma_decoders can't move once they're initialised
+		bool stemActive[maxStems];
+		int stemCount = 0;
+		std::atomic<float> gain{0}; // Written by the audio thread while it plays, read to pick the quietest
+		std::atomic<float> gainStep{0}; // Per frame, the game thread turns it around to fade out
+		std::atomic<bool> cut{false}; // The worker needs it back: retire it at the next callback
+	};
+	struct Request {
+		std::vector<StemSource> sources;
+		ma_uint32 channels = 2, sampleRate = 44100;
+		ma_uint64 startFrame = 0;
+		ma_uint32 fadeFrames = 0;
+	};
+
+	Slot slots[slotCount];
+	Request request;
+	bool requestPending = false, quitting = false;
+	std::atomic<bool> retiredAny{false};
+	unsigned int generation = 0;
+	std::mutex lock;
+	std::condition_variable wake;
+	std::thread worker;
+
+	float sum[mixBlockSamples];
+	float stemBuffer[mixBlockSamples];
+
+	// With the lock held
+	void fadeOutAll(ma_uint32 fadeFrames) {
+		for (Slot& slot : slots) {
+			if (slot.state.load(std::memory_order_relaxed) != Slot::PLAYING) continue;
+			slot.gainStep.store(-1.0f / std::max<ma_uint32>(1, fadeFrames), std::memory_order_relaxed);
+		}
+	}
+
+	// Without the lock, on a slot the audio thread isn't reading (retired or loading), or once the worker is gone.
+	// Whoever called it marks the slot free afterwards, with the lock held
+	void closeDecoders(Slot& slot) {
+		for (int i = 0; i < slot.stemCount; ++i) {
+			ma_decoder_uninit(&slot.decoders[i]);
+		}
+		slot.stemCount = 0;
+	}
+
+	void work() {
+		std::unique_lock<std::mutex> guard(lock);
+		for (;;) {
+			wake.wait_for(guard, std::chrono::milliseconds(retiredCheckMs), [this]() {
+				return quitting || requestPending || retiredAny.load(std::memory_order_acquire);
+			});
+			if (quitting) return;
+
+			// Close what the audio thread let go of, outside the lock
+			retiredAny.store(false, std::memory_order_relaxed);
+			Slot* retired[slotCount];
+			int retiredCount = 0;
+			for (Slot& slot : slots) {
+				if (slot.state.load(std::memory_order_acquire) == Slot::RETIRED) retired[retiredCount++] = &slot;
+			}
+			if (retiredCount > 0) {
+				guard.unlock();
+				for (int i = 0; i < retiredCount; ++i) {
+					closeDecoders(*retired[i]);
+				}
+				guard.lock();
+				for (int i = 0; i < retiredCount; ++i) {
+					retired[i]->state.store(Slot::FREE, std::memory_order_relaxed);
+				}
+			}
+			if (!requestPending) continue;
+
+			Request job;
+			std::swap(job, request);
+			unsigned int jobGeneration = generation;
+			requestPending = false;
+			Slot* slot = freeSlot(guard);
+			if (slot == NULL) return; // Quitting
+			slot->state.store(Slot::LOADING, std::memory_order_relaxed);
+			slot->stemCount = 0;
+			guard.unlock();
+
+			bool opened = open(job, jobGeneration, *slot);
+
+			guard.lock();
+			if (opened && jobGeneration == generation) {
+				slot->gain.store(0, std::memory_order_relaxed);
+				slot->gainStep.store(1.0f / std::max<ma_uint32>(1, job.fadeFrames), std::memory_order_relaxed);
+				slot->cut.store(false, std::memory_order_relaxed);
+				slot->state.store(Slot::PLAYING, std::memory_order_release);
+			} else {
+				guard.unlock();
+				closeDecoders(*slot);
+				guard.lock();
+				slot->state.store(Slot::FREE, std::memory_order_relaxed);
+			}
+		}
+	}
+
+	/*
+	* With the lock held. A free slot, or else one that's on its way out: a retired one, or the quietest one playing,
+	* which the audio thread cuts and hands back first. NULL if the player closes while it waits for that.
+	*/
+	Slot* freeSlot(std::unique_lock<std::mutex>& guard) {
+		Slot* victim = NULL;
+		for (Slot& slot : slots) {
+			int state = slot.state.load(std::memory_order_acquire);
+			if (state == Slot::FREE) return &slot;
+			if (state == Slot::RETIRED) {
+				victim = &slot;
+			} else if (state == Slot::PLAYING && (victim == NULL || (victim->state.load(std::memory_order_relaxed) == Slot::PLAYING &&
+				slot.gain.load(std::memory_order_relaxed) < victim->gain.load(std::memory_order_relaxed)))) {
+				victim = &slot;
+			}
+		}
+		// There's only one worker, so at most one slot is loading and the rest are playing or retired
+		if (victim->state.load(std::memory_order_relaxed) == Slot::PLAYING) {
+			victim->cut.store(true, std::memory_order_relaxed);
+			while (!quitting && victim->state.load(std::memory_order_acquire) != Slot::RETIRED) {
+				wake.wait_for(guard, std::chrono::milliseconds(10));
+			}
+			if (quitting) return NULL;
+		}
+		victim->state.store(Slot::LOADING, std::memory_order_relaxed);
+		guard.unlock();
+		closeDecoders(*victim);
+		guard.lock();
+		return victim;
+	}
+
+	// Worker, without the lock. Gives up as soon as the request is replaced
+	bool open(const Request& job, unsigned int jobGeneration, Slot& slot) {
+		ma_decoder_config config = ma_decoder_config_init(ma_format_f32, job.channels, job.sampleRate);
+		config.seekPointCount = seekPoints;
+		for (const StemSource& source : job.sources) {
+			if (jobGeneration != currentGeneration()) return false;
+
+			ma_decoder& decoder = slot.decoders[slot.stemCount];
+			if (source.open(&config, &decoder) != MA_SUCCESS) {
+				printf("Preview: failed to load %s.\n", source.path.c_str());
+				continue;
+			}
+			if (ma_decoder_seek_to_pcm_frame(&decoder, job.startFrame) != MA_SUCCESS) {
+				ma_decoder_uninit(&decoder); // Shorter than the preview point
+				continue;
+			}
+			slot.stemActive[slot.stemCount] = true;
+			++slot.stemCount;
+		}
+		return slot.stemCount > 0;
+	}
+
+	unsigned int currentGeneration() {
+		std::lock_guard<std::mutex> guard(lock);
+		return generation;
+	}
+};
+
+#endif /* MA_PREVIEW_H */
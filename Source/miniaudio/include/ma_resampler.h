@@ -0,0 +1,126 @@
+#ifndef MA_RESAMPLER_H
+#define MA_RESAMPLER_H
+
+/*
+	* Plugs signalsmith's PolyphaseResampler into miniaudio as a custom resampling backend, so decoders whose files
+	* aren't at the device rate get converted with a proper windowed-sinc filter instead of ma_linear_resampler
+	* (which lets anything above ~10kHz alias back down audibly).
+	* miniaudio always runs custom backends in f32.
+
+	* Needs miniaudio.h and signalsmith-stretch's dsp/rates.h included before it.
+*/
+
+struct PolyphaseBackend {
+	signalsmith::rates::PolyphaseResampler<float> resampler;
+	ma_uint32 channels;
+};
+
+static ma_result polyphase_on_get_heap_size(void* pUserData, const ma_resampler_config* pConfig, size_t* pHeapSizeInBytes) {
+	(void)pUserData;
+	(void)pConfig;
+	*pHeapSizeInBytes = 0; // Allocates its own, see polyphase_on_init()
+	return MA_SUCCESS;
+}
+
+static ma_result polyphase_on_init(void* pUserData, const ma_resampler_config* pConfig, void* pHeap, ma_resampling_backend** ppBackend) {
+	(void)pUserData;
+	(void)pHeap;
+	if (pConfig->format != ma_format_f32 || pConfig->sampleRateIn == 0 || pConfig->sampleRateOut == 0) return MA_INVALID_ARGS;
+
+	PolyphaseBackend* backend = new PolyphaseBackend();
+	backend->channels = pConfig->channels;
+	backend->resampler.resize(pConfig->channels, 4096);
+	backend->resampler.setRatio((double)pConfig->sampleRateIn / pConfig->sampleRateOut);
+	*ppBackend = backend;
+	return MA_SUCCESS;
+}
+
+static void polyphase_on_uninit(void* pUserData, ma_resampling_backend* pBackend, const ma_allocation_callbacks* pAllocationCallbacks) {
+	(void)pUserData;
+	(void)pAllocationCallbacks;
+	delete (PolyphaseBackend*)pBackend;
+}
+
+static ma_result polyphase_on_process(void* pUserData, ma_resampling_backend* pBackend, const void* pFramesIn, ma_uint64* pFrameCountIn, void* pFramesOut, ma_uint64* pFrameCountOut) {
+	(void)pUserData;
+	PolyphaseBackend* backend = (PolyphaseBackend*)pBackend;
+	ma_uint64 totalIn = *pFrameCountIn, totalOut = *pFrameCountOut;
+	ma_uint64 usedIn = 0, writtenOut = 0;
+
+	// The resampler takes ints, miniaudio hands over 64-bit counts
+	while (usedIn < totalIn || writtenOut < totalOut) {
+		int frameCountIn = (int)std::min<ma_uint64>(totalIn - usedIn, 0x10000000);
+		int frameCountOut = (int)std::min<ma_uint64>(totalOut - writtenOut, 0x10000000);
+		const float* pIn = pFramesIn != NULL ? (const float*)pFramesIn + usedIn * backend->channels : NULL;
+		float* pOut = pFramesOut != NULL ? (float*)pFramesOut + writtenOut * backend->channels : NULL;
+		backend->resampler.processInterleaved(pIn, frameCountIn, pOut, frameCountOut);
+		usedIn += frameCountIn;
+		writtenOut += frameCountOut;
+		if (frameCountIn == 0 && frameCountOut == 0) break;
+	}
+
+	*pFrameCountIn = usedIn;
+	*pFrameCountOut = writtenOut;
+	return MA_SUCCESS;
+}
+
+static ma_result polyphase_on_set_rate(void* pUserData, ma_resampling_backend* pBackend, ma_uint32 sampleRateIn, ma_uint32 sampleRateOut) {
+	(void)pUserData;
+	if (sampleRateIn == 0 || sampleRateOut == 0) return MA_INVALID_ARGS;
+	((PolyphaseBackend*)pBackend)->resampler.setRatio((double)sampleRateIn / sampleRateOut);
+	return MA_SUCCESS;
+}
+
+static ma_uint64 polyphase_on_get_input_latency(void* pUserData, const ma_resampling_backend* pBackend) {
+	(void)pUserData;
+	return ((const PolyphaseBackend*)pBackend)->resampler.latency();
+}
+
+static ma_uint64 polyphase_on_get_output_latency(void* pUserData, const ma_resampling_backend* pBackend) {
+	(void)pUserData;
+	const PolyphaseBackend* backend = (const PolyphaseBackend*)pBackend;
+	return (ma_uint64)(backend->resampler.latency() / backend->resampler.ratio());
+}
+
+static ma_result polyphase_on_get_required_input_frame_count(void* pUserData, const ma_resampling_backend* pBackend, ma_uint64 outputFrameCount, ma_uint64* pInputFrameCount) {
+	(void)pUserData;
+	*pInputFrameCount = ((const PolyphaseBackend*)pBackend)->resampler.inputFor((int)std::min<ma_uint64>(outputFrameCount, 0x10000000));
+	return MA_SUCCESS;
+}
+
+static ma_result polyphase_on_get_expected_output_frame_count(void* pUserData, const ma_resampling_backend* pBackend, ma_uint64 inputFrameCount, ma_uint64* pOutputFrameCount) {
+	(void)pUserData;
+	*pOutputFrameCount = ((const PolyphaseBackend*)pBackend)->resampler.outputFor((int)std::min<ma_uint64>(inputFrameCount, 0x10000000));
+	return MA_SUCCESS;
+}
+
+static ma_result polyphase_on_reset(void* pUserData, ma_resampling_backend* pBackend) {
+	(void)pUserData;
+	((PolyphaseBackend*)pBackend)->resampler.reset();
+	return MA_SUCCESS;
+}
+
+static ma_resampling_backend_vtable g_polyphaseResamplerVTable = {
+	polyphase_on_get_heap_size,
+	polyphase_on_init,
+	polyphase_on_uninit,
+	polyphase_on_process,
+	polyphase_on_set_rate,
+	polyphase_on_get_input_latency,
+	polyphase_on_get_output_latency,
+	polyphase_on_get_required_input_frame_count,
+	polyphase_on_get_expected_output_frame_count,
+	polyphase_on_reset
+};
+
+/*
+* ma_decoder_config_init(), but resampling to the device rate through the polyphase backend.
+*/
+static inline ma_decoder_config polyphase_decoder_config_init(ma_format outputFormat, ma_uint32 outputChannels, ma_uint32 outputSampleRate) {
+	ma_decoder_config config = ma_decoder_config_init(outputFormat, outputChannels, outputSampleRate);
+	config.resampling.algorithm = ma_resample_algorithm_custom;
+	config.resampling.pBackendVTable = &g_polyphaseResamplerVTable;
+	return config;
+}
+
+#endif /* MA_RESAMPLER_H */
@@ -0,0 +1,268 @@
+#ifndef MA_REVERB_H
+#define MA_REVERB_H
+
+/*
+	* Reverb send for the mix bus, so it doesn't have to be baked into the songs.
+	* It's a feedback delay network (the signalsmith "let's write a reverb" layout): the stereo send is spread over
+	* 8 or 16 channels, diffused by a few delay + Hadamard steps, then fed through a Householder feedback loop.
+
+	* It works in blocks shorter than the shortest delay, so every delay read and write in a block is a contiguous span
+	* of a delay::Buffer, and the matrices run on Float4/Float8s holding consecutive samples of one channel.
+	* The wet path is one block (32 frames) late, which just adds to the pre-delay.
+
+	* Needs signalsmith-stretch.h (for delay.h and perf.h) and dsp/mix.h included before it.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+template<int channels>
+class FdnReverb {
+	static_assert(channels == 8 || channels == 16, "FdnReverb is specialised for 8 or 16 channels");
+#if SIGNALSMITH_PERF_SIMD8
+	using Vector = signalsmith::perf::Float8;
+#else
+	using Vector = signalsmith::perf::Float4;
+#endif
+public:
+	static constexpr int blockLength = 32; // Also the shortest allowed delay
+	static constexpr int diffusionSteps = 3;
+	static constexpr double maxRoomMs = 200;
+
+	FdnReverb() {
+		double maxRoomSamples = maxRoomMs * 0.001 * sampleRate;
+		for (int s = 0; s < diffusionSteps; ++s) {
+			diffusers[s].allocate(blockLength + (int)maxRoomSamples);
+		}
+		feedback.allocate(blockLength + (int)(maxRoomSamples * 2) + 1);
+		configure(100, 2, 6000);
+	}
+
+	/*
+	* Not real-time safe against process(), lock around both. Doesn't allocate.
+	* roomMs: the feedback delays are spread over 1-2x this. decaySeconds: RT60. dampingHz: where the tail gets darker.
+	*/
+	void configure(double roomMs, double decaySeconds, double dampingHz) {
+		double roomSamples = std::max(1.0, std::min(roomMs, (double)maxRoomMs)) * 0.001 * sampleRate;
+		std::mt19937 random(12345); // Fixed, so the same settings always sound the same
+		std::uniform_real_distribution<double> unit(0, 1);
+
+		// Each diffusion step spans twice the range of the one before, up to half the room
+		for (int s = 0; s < diffusionSteps; ++s) {
+			double range = roomSamples * 0.5 / (1 << (diffusionSteps - 1 - s));
+			int delays[channels];
+			for (int c = 0; c < channels; ++c) {
+				delays[c] = blockLength + (int)(range * (c + unit(random)) / channels);
+			}
+			diffusers[s].setDelays(delays);
+			for (int c = 0; c < channels; ++c) {
+				float flip = unit(random) < 0.5 ? -1.0f : 1.0f;
+				diffuserGains[s][c] = flip * signalsmith::mix::Hadamard<float, channels>::scalingFactor();
+				diffuserShuffle[s][c] = c;
+			}
+			std::shuffle(diffuserShuffle[s], diffuserShuffle[s] + channels, random);
+		}
+
+		int delays[channels];
+		decaySeconds = std::max(0.05, decaySeconds);
+		for (int c = 0; c < channels; ++c) {
+			double r = (c + unit(random) * 0.5) / channels;
+			delays[c] = std::max(blockLength, (int)(roomSamples * std::pow(2.0, r)));
+			// Every channel loses the same dB per second, whatever its delay
+			feedbackGains[c] = (float)std::pow(10.0, -3.0 * delays[c] / (decaySeconds * sampleRate));
+		}
+		feedback.setDelays(delays);
+
+		dampingCoeff = (float)(1 - std::exp(-2 * M_PI * std::max(20.0, dampingHz) / sampleRate));
+	}
+
+	void reset() {
+		for (int s = 0; s < diffusionSteps; ++s) diffusers[s].reset();
+		feedback.reset();
+		for (int c = 0; c < channels; ++c) damping[c] = 0;
+		memset(fifoIn, 0, sizeof(fifoIn));
+		memset(fifoOut, 0, sizeof(fifoOut));
+		fifoIndex = 0;
+	}
+
+	/*
+	* Adds the reverb of `send` times the interleaved stereo signal back onto it.
+	*/
+	void process(float* pStereo, ma_uint32 frameCount, float send) {
+		for (ma_uint32 i = 0; i < frameCount; ++i) {
+			float* pFrame = pStereo + i * 2;
+			fifoIn[0][fifoIndex] = pFrame[0] * send;
+			fifoIn[1][fifoIndex] = pFrame[1] * send;
+			pFrame[0] += fifoOut[0][fifoIndex];
+			pFrame[1] += fifoOut[1][fifoIndex];
+			if (++fifoIndex == blockLength) {
+				processBlock();
+				fifoIndex = 0;
+			}
+		}
+	}
+
+private:
+	static constexpr double sampleRate = 44100;
+
+	// One delay::Buffer per channel, read and written a whole block at a time
+	struct DelayBank {
+		signalsmith::delay::Buffer<float> lines[channels];
+		int delays[channels];
+
+		void allocate(int maxDelay) {
+			for (int c = 0; c < channels; ++c) {
+				lines[c].resize(maxDelay + blockLength);
+				delays[c] = blockLength;
+			}
+		}
+		void reset() {
+			for (int c = 0; c < channels; ++c) lines[c].reset();
+		}
+		void setDelays(const int* newDelays) {
+			for (int c = 0; c < channels; ++c) delays[c] = newDelays[c];
+		}
+
+		// The delays are at least a block, so this never reads anything written in the same block
+		void read(float out[channels][blockLength]) {
+			for (int c = 0; c < channels; ++c) {
+				copySpan(lines[c].view(-delays[c]), out[c], true);
+			}
+		}
+		void write(float in[channels][blockLength]) {
+			for (int c = 0; c < channels; ++c) {
+				copySpan(lines[c].view(), in[c], false);
+				lines[c] += blockLength;
+			}
+		}
+
+		// At most two memcpys, depending on where the ring buffer wraps
+		static void copySpan(typename signalsmith::delay::Buffer<float>::MutableView view, float* block, bool fromBuffer) {
+			int first = std::min(view.contiguous(), blockLength);
+			if (fromBuffer) {
+				memcpy(block, view.data(), sizeof(float) * first);
+				memcpy(block + first, view.data(first), sizeof(float) * (blockLength - first));
+			} else {
+				memcpy(view.data(), block, sizeof(float) * first);
+				memcpy(view.data(first), block + first, sizeof(float) * (blockLength - first));
+			}
+		}
+	};
+
+	DelayBank diffusers[diffusionSteps];
+	float diffuserGains[diffusionSteps][channels]; // Hadamard scaling, with a random polarity flip
+	int diffuserShuffle[diffusionSteps][channels];
+	DelayBank feedback;
+	float feedbackGains[channels];
+	float damping[channels];
+	float dampingCoeff = 1;
+
+	float fifoIn[2][blockLength];
+	float fifoOut[2][blockLength];
+	int fifoIndex = 0;
+
+	signalsmith::mix::StereoMultiMixer<float, channels> stereoMixer;
+
+	void processBlock() {
+		float multi[channels][blockLength];
+		float delayed[channels][blockLength];
+
+		for (int t = 0; t < blockLength; ++t) {
+			float stereo[2] = {fifoIn[0][t], fifoIn[1][t]};
+			float frame[channels];
+			stereoMixer.stereoToMulti(stereo, frame);
+			for (int c = 0; c < channels; ++c) multi[c][t] = frame[c];
+		}
+
+		// Diffusion: delay, Hadamard across the channels, shuffle and flip
+		for (int s = 0; s < diffusionSteps; ++s) {
+			diffusers[s].read(delayed);
+			diffusers[s].write(multi);
+			for (int t = 0; t < blockLength; t += Vector::size) {
+				Vector v[channels];
+				for (int c = 0; c < channels; ++c) v[c] = Vector::load(delayed[c] + t);
+				signalsmith::mix::Hadamard<Vector, channels>::unscaledInPlace(v);
+				for (int c = 0; c < channels; ++c) {
+					(v[c] * Vector::splat(diffuserGains[s][c])).store(multi[diffuserShuffle[s][c]] + t);
+				}
+			}
+		}
+
+		// Feedback loop: damp and decay what comes out of the delays, then mix it back in with the diffused input
+		feedback.read(delayed);
+		for (int c = 0; c < channels; ++c) {
+			float state = damping[c], gain = feedbackGains[c];
+			for (int t = 0; t < blockLength; ++t) {
+				state += (delayed[c][t] - state) * dampingCoeff;
+				delayed[c][t] = state * gain;
+			}
+			damping[c] = state;
+		}
+		float loop[channels][blockLength];
+		const Vector householderFactor = Vector::splat(-2.0f / channels); // Same matrix as mix::Householder
+		for (int t = 0; t < blockLength; t += Vector::size) {
+			Vector v[channels];
+			Vector sum = Vector::load(delayed[0] + t);
+			v[0] = sum;
+			for (int c = 1; c < channels; ++c) {
+				v[c] = Vector::load(delayed[c] + t);
+				sum = sum + v[c];
+			}
+			sum = sum * householderFactor;
+			for (int c = 0; c < channels; ++c) {
+				(v[c] + sum + Vector::load(multi[c] + t)).store(loop[c] + t);
+			}
+		}
+		feedback.write(loop);
+
+		float outputScale = stereoMixer.scalingFactor2();
+		for (int t = 0; t < blockLength; ++t) {
+			float frame[channels];
+			for (int c = 0; c < channels; ++c) frame[c] = delayed[c][t];
+			float stereo[2];
+			stereoMixer.multiToStereo(frame, stereo);
+			fifoOut[0][t] = stereo[0] * outputScale;
+			fifoOut[1][t] = stereo[1] * outputScale;
+		}
+	}
+};
+
+/*
+* Both sizes are allocated up front, so switching between them never allocates.
+* 0 = OFF
+* 1 = LIGHT (8 channels)
+* 2 = DENSE (16 channels, smoother tail, roughly twice the cost)
+*/
+class ReverbBus {
+public:
+	void configure(int newMode, double send, double roomMs, double decaySeconds, double dampingHz) {
+		if (newMode != mode) {
+			light.reset();
+			dense.reset();
+		}
+		mode = newMode;
+		sendLevel = (float)send;
+		light.configure(roomMs, decaySeconds, dampingHz);
+		dense.configure(roomMs, decaySeconds, dampingHz);
+	}
+	ma_bool32 active() const {
+		return mode != 0 && sendLevel != 0;
+	}
+	void process(float* pStereo, ma_uint32 frameCount) {
+		if (mode == 1) {
+			light.process(pStereo, frameCount, sendLevel);
+		} else if (mode == 2) {
+			dense.process(pStereo, frameCount, sendLevel);
+		}
+	}
+
+private:
+	int mode = 0;
+	float sendLevel = 0;
+	FdnReverb<8> light;
+	FdnReverb<16> dense;
+};
+
+#endif /* MA_REVERB_H */
@@ -0,0 +1,218 @@
+#ifndef MA_SFX_H
+#define MA_SFX_H
+
+/*
+	* One-shot sound effects (hitsounds, miss sounds) mixed into the music's own device callback, after the music has
+	* been stretched, so they come out with one buffer of latency and ignore the playback rate.
+
+	* Samples are decoded up front into memory at the mixer's format, so playing one is a copy. The game thread triggers
+	* them through a lock-free ring of commands the audio thread drains at the start of every callback: no lock, no
+	* allocation. A fixed pool of voices plays them; when every voice is busy the one triggered longest ago is stolen.
+
+	* A voice either starts as soon as possible (the next callback) or on a frame of the song, placed inside the callback
+	* that plays that frame, so it lines up with the music whatever the rate. Song-timed voices that haven't started yet
+	* are dropped on a seek.
+
+	* Needs miniaudio.h and ma_sources.h included before it.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+struct SfxSample {
+	std::vector<float> pcm; // Interleaved
+	ma_uint64 frameCount = 0;
+
+	/* Decodes a whole file. Slow, call it off the audio thread. */
+	bool decode(const StemSource& source, ma_uint32 channels, ma_uint32 sampleRate) {
+		ma_decoder_config config = polyphase_decoder_config_init(ma_format_f32, channels, sampleRate);
+		ma_decoder decoder;
+		if (source.open(&config, &decoder) != MA_SUCCESS) {
+			printf("SFX: failed to load %s.\n", source.path.c_str());
+			return false;
+		}
+		ma_uint64 length = 0;
+		ma_decoder_get_length_in_pcm_frames(&decoder, &length);
+		pcm.reserve(length * channels);
+
+		float temp[4096];
+		ma_uint32 blockFrames = 4096 / channels;
+		for (;;) {
+			ma_uint64 framesRead = 0;
+			ma_result result = ma_decoder_read_pcm_frames(&decoder, temp, blockFrames, &framesRead);
+			pcm.insert(pcm.end(), temp, temp + framesRead * channels);
+			frameCount += framesRead;
+			if (result != MA_SUCCESS || framesRead == 0) break;
+		}
+		ma_decoder_uninit(&decoder);
+		return frameCount > 0;
+	}
+};
+
+class SfxPool {
+public:
+	static constexpr int maxSamples = 128;
+	static constexpr int voiceCount = 32;
+	static constexpr int commandCapacity = 256; // Power of 2
+
+	/*
+	* Takes a decoded sample and returns its id, or -1 if every slot is taken.
+	* install() and unload() swap out what the audio thread reads, call them with decoderMutex held.
+	*/
+	int install(std::unique_ptr<SfxSample> sample) {
+		for (int i = 0; i < maxSamples; ++i) {
+			if (samples[i] == nullptr) {
+				samples[i] = std::move(sample);
+				return i;
+			}
+		}
+		printf("SFX: no free sample slots.\n");
+		return -1;
+	}
+
+	void unload(int id) {
+		if (id < 0 || id >= maxSamples) return;
+		for (Voice& voice : voices) {
+			if (voice.sample == samples[id].get()) voice.sample = NULL;
+		}
+		samples[id].reset();
+	}
+
+	/*
+	* Producer (the game thread), lock-free. `songFrame` < 0 plays it as soon as possible. `pan` goes from -1 (left)
+	* to 1 (right). Returns false if the queue is full, which only happens if the audio thread isn't running.
+	*/
+	bool play(int id, float gain, float pan, ma_int64 songFrame) {
+		return pushCommand(Command{id, gain, pan, songFrame});
+	}
+
+	/* Producer. Silences every voice, started or not. */
+	bool stopAll() {
+		return pushCommand(Command{-1, 0, 0, -1});
+	}
+
+	/*
+	* Audio thread, with decoderMutex held. Starts whatever was triggered and adds every voice on top of `out`.
+	* [startFrame, endFrame) is the part of the song this callback played (equal if it didn't move), `seeked` whether
+	* a seek happened during it.
+	*/
+	void mix(float* out, ma_uint32 frameCount, ma_uint32 channels, ma_uint64 startFrame, ma_uint64 endFrame, bool seeked) {
+		drainCommands(seeked);
+		if (frameCount == 0) return;
+
+		for (Voice& voice : voices) {
+			if (voice.sample == NULL) continue;
+
+			ma_uint32 offset = 0;
+			if (voice.songFrame >= 0) {
+				if (endFrame <= startFrame || (ma_uint64)voice.songFrame >= endFrame) continue; // Not there yet
+				if ((ma_uint64)voice.songFrame > startFrame) {
+					offset = (ma_uint32)((double)((ma_uint64)voice.songFrame - startFrame) * frameCount / (double)(endFrame - startFrame));
+					offset = std::min(offset, frameCount - 1);
+				}
+				voice.songFrame = -1; // Started
+			}
+
+			ma_uint32 frames = (ma_uint32)std::min<ma_uint64>(frameCount - offset, voice.sample->frameCount - voice.cursor);
+			const float* in = voice.sample->pcm.data() + voice.cursor * channels;
+			float* dst = out + offset * channels;
+			if (channels == 2) {
+				for (ma_uint32 f = 0; f < frames; ++f) {
+					dst[f * 2] += in[f * 2] * voice.gainLeft;
+					dst[f * 2 + 1] += in[f * 2 + 1] * voice.gainRight;
+				}
+			} else {
+				for (ma_uint32 i = 0; i < frames * channels; ++i) {
+					dst[i] += in[i] * voice.gain;
+				}
+			}
+			voice.cursor += frames;
+			if (voice.cursor >= voice.sample->frameCount) voice.sample = NULL;
+		}
+	}
+
+	/* Consumer side, e.g. on load while the device isn't running. Drops every voice and anything still queued. */
+	void reset() {
+		for (Voice& voice : voices) {
+			voice.sample = NULL;
+		}
+		readIndex.store(writeIndex.load(std::memory_order_acquire), std::memory_order_release);
+	}
+
+private:
+	struct Command {
+		int id; // -1 = stop everything
+		float gain, pan;
+		ma_int64 songFrame;
+	};
+	struct Voice {
+		const SfxSample* sample = NULL; // NULL = free
+		ma_uint64 cursor = 0;
+		ma_int64 songFrame = -1; // Where it starts, -1 once it has
+		float gain = 1, gainLeft = 1, gainRight = 1;
+		ma_uint64 age = 0; // When it was triggered, for stealing
+	};
+
+	std::unique_ptr<SfxSample> samples[maxSamples];
+	Voice voices[voiceCount];
+	ma_uint64 triggerCount = 0;
+
+	Command commands[commandCapacity];
+	std::atomic<unsigned int> writeIndex{0}, readIndex{0};
+
+	bool pushCommand(const Command& command) {
+		unsigned int write = writeIndex.load(std::memory_order_relaxed);
+		if (write - readIndex.load(std::memory_order_acquire) >= (unsigned int)commandCapacity) return false;
+		commands[write & (commandCapacity - 1)] = command;
+		writeIndex.store(write + 1, std::memory_order_release);
+		return true;
+	}
+
+	void drainCommands(bool seeked) {
+		if (seeked) {
+			for (Voice& voice : voices) {
+				if (voice.songFrame >= 0) voice.sample = NULL;
+			}
+		}
+
+		unsigned int read = readIndex.load(std::memory_order_relaxed);
+		unsigned int write = writeIndex.load(std::memory_order_acquire);
+		for (; read != write; ++read) {
+			const Command& command = commands[read & (commandCapacity - 1)];
+			if (command.id < 0) {
+				for (Voice& voice : voices) {
+					voice.sample = NULL;
+				}
+				continue;
+			}
+			if (command.id >= maxSamples || samples[command.id] == nullptr) continue;
+
+			Voice& voice = freeVoice();
+			voice.sample = samples[command.id].get();
+			voice.cursor = 0;
+			voice.songFrame = command.songFrame;
+			voice.age = triggerCount++;
+			// Equal power, scaled so a centred voice plays at the sample's own level
+			float angle = (std::max(-1.0f, std::min(1.0f, command.pan)) + 1) * 0.25f * 3.14159265f;
+			voice.gain = command.gain;
+			voice.gainLeft = command.gain * std::cos(angle) * 1.41421356f;
+			voice.gainRight = command.gain * std::sin(angle) * 1.41421356f;
+		}
+		readIndex.store(read, std::memory_order_release);
+	}
+
+	// A free voice, or the one triggered longest ago
+	Voice& freeVoice() {
+		Voice* oldest = &voices[0];
+		for (Voice& voice : voices) {
+			if (voice.sample == NULL) return voice;
+			if (voice.age < oldest->age) oldest = &voice;
+		}
+		return *oldest;
+	}
+};
+
+#endif /* MA_SFX_H */
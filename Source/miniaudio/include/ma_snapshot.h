@@ -0,0 +1,140 @@
+#ifndef MA_SNAPSHOT_H
+#define MA_SNAPSHOT_H
+
+/*
+	* Everything the game polls every frame, in one reading. The audio thread publishes a snapshot at the end of each
+	* callback (and the control functions publish one when they move things while it isn't running), and the game reads
+	* the newest one through a triple buffer: one native call, no mutex, and the position, state and levels in it
+	* always belong together.
+
+	* Needs ma_meters.h and ma_conductor.h included before it.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+struct StemSnapshot {
+	ma_bool32 active = MA_FALSE;
+	float volume = 1;
+	MeterReading levels;
+};
+
+struct MixerSnapshot {
+	double startPositionMs = 0; // Where the decoders were when the callback started...
+	double positionMs = 0; // ...and where it left them, same as getPlaybackPosition()
+	double periodSeconds = 0; // How long the audio from that callback plays for, 0 if it didn't come from one
+	double durationMs = 0;
+	double rate = 1;
+	int state = 3;
+	ma_uint32 lateCallbacks = 0;
+	ma_uint32 callbackGaps = 0;
+	Conductor::Position conductor; // At startPositionMs
+	std::chrono::steady_clock::time_point publishedAt;
+	std::vector<StemSnapshot> stems; // One per stem, then one for the whole mix
+};
+
+/*
+* Layout of read(), in doubles:
+* 0 = position (ms)
+* 1 = time (ms, interpolated between callbacks)
+* 2 = state (see MIXER_STATE)
+* 3 = playback rate
+* 4 = duration (ms)
+* 5 = late callbacks
+* 6 = callback gaps
+* 7 = stem count
+* 8 = beat (interpolated like the time, 0 without a conductor map)
+* 9 = step
+* 10 = measure
+* 11 = bpm
+* Then active, volume, peak, hold, rms for every stem, and for the whole mix last.
+*/
+class SnapshotPublisher {
+public:
+	static constexpr int headerSize = 12, stemSize = 5;
+
+	/*
+	* Not thread-safe, call before the device starts pulling audio.
+	*/
+	void configure(int stemCount) {
+		MixerSnapshot empty;
+		empty.stems.resize(stemCount + 1);
+		snapshots.reset(empty);
+		levels.assign(stemCount + 1, MeterReading());
+	}
+
+	/*
+	* Writer side: fill in all of back() (it holds whatever was published two snapshots ago) and publish() it.
+	* Any thread can write, but the writes have to be serialised (the mixer does it under decoderMutex).
+	*/
+	MixerSnapshot& back() {
+		return snapshots.back();
+	}
+
+	/*
+	* Audio thread only, after the meters have been fed for the callback. Snapshots published from other threads
+	* keep the levels from the last call.
+	*/
+	void updateLevels(const StemMeters& meters) {
+		for (size_t i = 0; i < levels.size(); ++i) {
+			levels[i] = meters.latest((int)i);
+		}
+	}
+
+	void publish() {
+		MixerSnapshot& snapshot = snapshots.back();
+		for (size_t i = 0; i < snapshot.stems.size() && i < levels.size(); ++i) {
+			snapshot.stems[i].levels = levels[i];
+		}
+		snapshot.publishedAt = std::chrono::steady_clock::now();
+		snapshots.publish();
+	}
+
+	/*
+	* Reader thread (only one). Writes as much of the layout above as fits in `capacity` doubles, returns the full size.
+	*/
+	int read(double* out, int capacity) {
+		snapshots.acquire();
+		const MixerSnapshot& snapshot = snapshots.front();
+		int stemCount = std::max(0, (int)snapshot.stems.size() - 1);
+		int size = headerSize + (int)snapshot.stems.size() * stemSize;
+		if (out == NULL) return size;
+
+		// While playing, walk from the callback's start position to its end position over the time its audio lasts
+		double progress = 1;
+		if (snapshot.state == 1 && snapshot.periodSeconds > 0) {
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - snapshot.publishedAt;
+			progress = std::min(1.0, elapsed.count() / snapshot.periodSeconds);
+		}
+		double timeMs = snapshot.startPositionMs + (snapshot.positionMs - snapshot.startPositionMs) * progress;
+		const Conductor::Position& conductor = snapshot.conductor;
+		double beats = (timeMs - snapshot.startPositionMs) * conductor.bpm / 60000; // A BPM change inside one callback is off until the next
+
+		double header[headerSize] = {
+			snapshot.positionMs, timeMs, (double)snapshot.state, snapshot.rate, snapshot.durationMs,
+			(double)snapshot.lateCallbacks, (double)snapshot.callbackGaps, (double)stemCount,
+			conductor.beat + beats, conductor.step + beats * conductor.stepsPerBeat,
+			conductor.measure + beats / conductor.beatsPerMeasure, conductor.bpm
+		};
+		int written = 0;
+		for (int i = 0; i < headerSize && written < capacity; ++i) {
+			out[written++] = header[i];
+		}
+		for (size_t i = 0; i < snapshot.stems.size() && written + stemSize <= capacity; ++i) {
+			const StemSnapshot& stem = snapshot.stems[i];
+			out[written++] = stem.active ? 1 : 0;
+			out[written++] = stem.volume;
+			out[written++] = stem.levels.peak;
+			out[written++] = stem.levels.hold;
+			out[written++] = stem.levels.rms;
+		}
+		return size;
+	}
+
+private:
+	TripleBuffer<MixerSnapshot> snapshots;
+	std::vector<MeterReading> levels; // Writer side
+};
+
+#endif /* MA_SNAPSHOT_H */
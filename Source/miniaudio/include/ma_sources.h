@@ -0,0 +1,244 @@
+#ifndef MA_SOURCES_H
+#define MA_SOURCES_H
+
+/*
+	* Where a stem's bytes come from: a loose file, a file inside the mounted pack, or memory the caller owns.
+	* Every decoder for a song (playback, pre-render, waveforms) is opened through StemSource, so all of them work
+	* whichever one it is.
+
+	* The pack is one big archive file, mapped into memory once. Files inside it are read through a custom ma_vfs, so
+	* opening one is a map lookup rather than an open() and seeking is moving a cursor. The archive format is the
+	* caller's business, it just tells us where each file sits (addEntry()).
+
+	* Needs miniaudio.h included before it.
+*/
+
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+
+#if defined(_WIN32)
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+/*
+* A read-only memory mapping of a whole file.
+*/
+class MappedFile {
+public:
+	~MappedFile() {
+		close();
+	}
+
+	bool open(const char* path) {
+		close();
+#if defined(_WIN32)
+		// Paths come in as UTF-8
+		int wideLength = MultiByteToWideChar(CP_UTF8, 0, path, -1, NULL, 0);
+		if (wideLength <= 0) return false;
+		std::wstring widePath(wideLength, L'\0');
+		MultiByteToWideChar(CP_UTF8, 0, path, -1, &widePath[0], wideLength);
+
+		file = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (file == INVALID_HANDLE_VALUE) return false;
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+			close();
+			return false;
+		}
+		mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping == NULL) {
+			close();
+			return false;
+		}
+		bytes = (const ma_uint8*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (bytes == NULL) {
+			close();
+			return false;
+		}
+		length = (ma_uint64)fileSize.QuadPart;
+#else
+		fd = ::open(path, O_RDONLY);
+		if (fd < 0) return false;
+		struct stat info;
+		if (fstat(fd, &info) != 0 || info.st_size == 0) {
+			close();
+			return false;
+		}
+		void* view = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		if (view == MAP_FAILED) {
+			close();
+			return false;
+		}
+		bytes = (const ma_uint8*)view;
+		length = (ma_uint64)info.st_size;
+#endif
+		return true;
+	}
+
+	void close() {
+#if defined(_WIN32)
+		if (bytes != NULL) UnmapViewOfFile(bytes);
+		if (mapping != NULL) CloseHandle(mapping);
+		if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+		mapping = NULL;
+		file = INVALID_HANDLE_VALUE;
+#else
+		if (bytes != NULL) munmap((void*)bytes, (size_t)length);
+		if (fd >= 0) ::close(fd);
+		fd = -1;
+#endif
+		bytes = NULL;
+		length = 0;
+	}
+
+	const ma_uint8* data() const {
+		return bytes;
+	}
+	ma_uint64 size() const {
+		return length;
+	}
+
+private:
+	const ma_uint8* bytes = NULL;
+	ma_uint64 length = 0;
+#if defined(_WIN32)
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = NULL;
+#else
+	int fd = -1;
+#endif
+};
+
+/*
+* An ma_vfs over the mapped pack. Only reads, and only the files it was told about.
+* Mount and add entries before loading anything from it, and don't unmount while a song from it is loaded.
+*/
+class PackVfs {
+public:
+	PackVfs() {
+		callbacks.onOpen = onOpen;
+		callbacks.onOpenW = NULL;
+		callbacks.onClose = onClose;
+		callbacks.onRead = onRead;
+		callbacks.onWrite = NULL;
+		callbacks.onSeek = onSeek;
+		callbacks.onTell = onTell;
+		callbacks.onInfo = onInfo;
+	}
+
+	bool mount(const char* path) {
+		std::lock_guard<std::mutex> lock(mutex);
+		entries.clear();
+		return file.open(path);
+	}
+	void unmount() {
+		std::lock_guard<std::mutex> lock(mutex);
+		entries.clear();
+		file.close();
+	}
+
+	/* Registers a file at `offset` in the pack. Returns false if it doesn't fit inside the pack. */
+	bool addEntry(const char* name, ma_uint64 offset, ma_uint64 size) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (file.data() == NULL || offset > file.size() || size > file.size() - offset) return false;
+		entries[name] = Entry{offset, size};
+		return true;
+	}
+	bool contains(const std::string& name) {
+		std::lock_guard<std::mutex> lock(mutex);
+		return entries.count(name) != 0;
+	}
+
+	ma_vfs* vfs() {
+		return this; // miniaudio passes this back into the callbacks, which must be the first member
+	}
+
+private:
+	ma_vfs_callbacks callbacks;
+
+	struct Entry {
+		ma_uint64 offset, size;
+	};
+	struct OpenFile {
+		const ma_uint8* data;
+		ma_int64 size;
+		ma_int64 cursor;
+	};
+
+	MappedFile file;
+	std::map<std::string, Entry> entries;
+	std::mutex mutex; // Only for the entries, reads go straight to the mapping
+
+	static ma_result onOpen(ma_vfs* pVFS, const char* pFilePath, ma_uint32 openMode, ma_vfs_file* pFile) {
+		PackVfs* pack = (PackVfs*)pVFS;
+		if (pFile == NULL) return MA_INVALID_ARGS;
+		*pFile = NULL;
+		if ((openMode & MA_OPEN_MODE_WRITE) != 0) return MA_ACCESS_DENIED;
+
+		std::lock_guard<std::mutex> lock(pack->mutex);
+		auto found = pack->entries.find(pFilePath);
+		if (found == pack->entries.end()) return MA_DOES_NOT_EXIST;
+		*pFile = new OpenFile{pack->file.data() + found->second.offset, (ma_int64)found->second.size, 0};
+		return MA_SUCCESS;
+	}
+	static ma_result onClose(ma_vfs* pVFS, ma_vfs_file file) {
+		(void)pVFS;
+		delete (OpenFile*)file;
+		return MA_SUCCESS;
+	}
+	static ma_result onRead(ma_vfs* pVFS, ma_vfs_file file, void* pDst, size_t sizeInBytes, size_t* pBytesRead) {
+		(void)pVFS;
+		OpenFile* openFile = (OpenFile*)file;
+		ma_int64 available = openFile->size - openFile->cursor;
+		size_t bytesRead = (ma_int64)sizeInBytes < available ? sizeInBytes : (size_t)available;
+		memcpy(pDst, openFile->data + openFile->cursor, bytesRead);
+		openFile->cursor += bytesRead;
+		if (pBytesRead != NULL) *pBytesRead = bytesRead;
+		return bytesRead == 0 && sizeInBytes > 0 ? MA_AT_END : MA_SUCCESS;
+	}
+	static ma_result onSeek(ma_vfs* pVFS, ma_vfs_file file, ma_int64 offset, ma_seek_origin origin) {
+		(void)pVFS;
+		OpenFile* openFile = (OpenFile*)file;
+		ma_int64 base = origin == ma_seek_origin_start ? 0 : (origin == ma_seek_origin_current ? openFile->cursor : openFile->size);
+		ma_int64 cursor = base + offset;
+		if (cursor < 0 || cursor > openFile->size) return MA_BAD_SEEK;
+		openFile->cursor = cursor;
+		return MA_SUCCESS;
+	}
+	static ma_result onTell(ma_vfs* pVFS, ma_vfs_file file, ma_int64* pCursor) {
+		(void)pVFS;
+		*pCursor = ((OpenFile*)file)->cursor;
+		return MA_SUCCESS;
+	}
+	static ma_result onInfo(ma_vfs* pVFS, ma_vfs_file file, ma_file_info* pInfo) {
+		(void)pVFS;
+		pInfo->sizeInBytes = (ma_uint64)((OpenFile*)file)->size;
+		return MA_SUCCESS;
+	}
+};
+
+struct StemSource {
+	std::string path; // Loose file or pack entry, or just a name for messages when it's in memory
+	PackVfs* pack = NULL; // Set if `path` is inside the pack
+	const void* data = NULL; // Caller-owned, has to outlive the song
+	size_t size = 0;
+
+	ma_result open(const ma_decoder_config* pConfig, ma_decoder* pDecoder) const {
+		if (data != NULL) {
+			return ma_decoder_init_memory(data, size, pConfig, pDecoder);
+		}
+		if (pack != NULL) {
+			return ma_decoder_init_vfs(pack->vfs(), path.c_str(), pConfig, pDecoder);
+		}
+		return ma_decoder_init_file(path.c_str(), pConfig, pDecoder);
+	}
+};
+
+#endif /* MA_SOURCES_H */
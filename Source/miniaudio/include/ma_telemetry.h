@@ -0,0 +1,170 @@
+#ifndef MA_TELEMETRY_H
+#define MA_TELEMETRY_H
+
+/*
+	* How long the music callback takes, always on, so a report from a player's machine says how close it runs to
+	* its deadline and which part of it is to blame. Every callback lands in a log-scaled histogram (one per stage and
+	* one for the whole callback), and gets counted against the period it had to fill.
+
+	* Only the audio thread writes, and only with relaxed atomic stores, so it costs a few clock reads per callback
+	* and never waits on the game thread. Readers may see one callback half counted, which doesn't matter for a
+	* histogram. A reset is handed to the audio thread rather than done from outside, for the same reason.
+
+	* Needs miniaudio.h included before it.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+/*
+* 0 = DECODE (reading the stems: decoders, the loop window)
+* 1 = MIX (gains, EQ, summing and interleaving, whatever of the music isn't decode or stretch)
+* 2 = STRETCH (the stretcher or the varispeed resampler)
+* 3 = EFFECTS (reverb, meters, sound effects, events and the snapshot)
+*/
+class CallbackTelemetry {
+public:
+	static constexpr int stageCount = 4;
+	static constexpr int histogramCount = stageCount + 1; // The stages, then the whole callback
+	static constexpr int bucketCount = 24; // Bucket 0 is under 2us, bucket b from 2^b us, the last one has no end
+
+	/* Audio thread, first thing in a callback. */
+	void begin() {
+		if (resetRequested.exchange(false, std::memory_order_acquire)) clear();
+		std::fill(current, current + stageCount, 0.0);
+	}
+
+	/* Audio thread. Counts the time since `since` towards `stage` of this callback. */
+	void add(int stage, std::chrono::steady_clock::time_point since) {
+		current[stage] += std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+	}
+
+	/*
+	* Audio thread, last thing in a callback. The music was mixed between musicStart and musicEnd, everything after
+	* that counts as effects. `periodSeconds` is how much audio the callback produced, `gap` whether it started late
+	* (a likely underrun the callback itself couldn't see).
+	*/
+	void end(std::chrono::steady_clock::time_point callbackStart, std::chrono::steady_clock::time_point musicStart,
+		std::chrono::steady_clock::time_point musicEnd, double periodSeconds, bool gap) {
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		double music = std::chrono::duration<double>(musicEnd - musicStart).count();
+		current[1] = std::max(0.0, music - current[0] - current[2]);
+		current[3] = std::chrono::duration<double>(now - musicEnd).count();
+		double took = std::chrono::duration<double>(now - callbackStart).count();
+
+		for (int i = 0; i < stageCount; ++i) {
+			histograms[i].add(current[i]);
+		}
+		histograms[stageCount].add(took);
+
+		bump(callbacks);
+		if (took > periodSeconds * 0.5) bump(overHalf);
+		if (took > periodSeconds * 0.75) bump(overThreeQuarters);
+		if (took > periodSeconds) bump(missed);
+		if (gap) bump(gaps);
+		periodNs.store((ma_uint64)(periodSeconds * 1e9), std::memory_order_relaxed);
+	}
+
+	/* Any thread. Starts counting from scratch at the next callback. */
+	void reset() {
+		resetRequested.store(true, std::memory_order_release);
+	}
+
+	/* Any thread. Everything as one JSON object, times in microseconds. */
+	std::string json(ma_uint32 sampleRate, ma_uint32 channels) const {
+		static const char* names[histogramCount] = {"decode", "mix", "stretch", "effects", "callback"};
+		std::string out;
+		char number[64];
+
+		snprintf(number, sizeof(number), "{\"sampleRate\":%u,\"channels\":%u,", sampleRate, channels);
+		out += number;
+		snprintf(number, sizeof(number), "\"callbacks\":%llu,", load(callbacks));
+		out += number;
+		snprintf(number, sizeof(number), "\"periodUs\":%.1f,", load(periodNs) * 1e-3);
+		out += number;
+		snprintf(number, sizeof(number), "\"overHalf\":%llu,", load(overHalf));
+		out += number;
+		snprintf(number, sizeof(number), "\"overThreeQuarters\":%llu,", load(overThreeQuarters));
+		out += number;
+		snprintf(number, sizeof(number), "\"missed\":%llu,\"gaps\":%llu,", load(missed), load(gaps));
+		out += number;
+
+		out += "\"bucketsUs\":[0";
+		for (int b = 1; b < bucketCount; ++b) {
+			snprintf(number, sizeof(number), ",%llu", 1ull << b);
+			out += number;
+		}
+		out += "],\"stages\":{";
+		for (int i = 0; i < histogramCount; ++i) {
+			const Histogram& histogram = histograms[i];
+			ma_uint64 count = load(callbacks);
+			double totalUs = load(histogram.totalNs) * 1e-3;
+			snprintf(number, sizeof(number), "%s\"%s\":{\"meanUs\":%.2f,", i > 0 ? "," : "", names[i], count > 0 ? totalUs / count : 0.0);
+			out += number;
+			snprintf(number, sizeof(number), "\"maxUs\":%.2f,\"histogram\":[", load(histogram.maxNs) * 1e-3);
+			out += number;
+			for (int b = 0; b < bucketCount; ++b) {
+				snprintf(number, sizeof(number), "%s%llu", b > 0 ? "," : "", load(histogram.buckets[b]));
+				out += number;
+			}
+			out += "]}";
+		}
+		out += "}}";
+		return out;
+	}
+
+private:
+	struct Histogram {
+		std::atomic<ma_uint64> buckets[bucketCount];
+		std::atomic<ma_uint64> totalNs{0}, maxNs{0};
+
+		Histogram() {
+			for (std::atomic<ma_uint64>& bucket : buckets) {
+				bucket.store(0, std::memory_order_relaxed);
+			}
+		}
+
+		void add(double seconds) {
+			ma_uint64 ns = (ma_uint64)(seconds * 1e9);
+			ma_uint64 us = ns / 1000;
+			int bucket = 0;
+			while (bucket + 1 < bucketCount && us >= (2ull << bucket)) ++bucket;
+			bump(buckets[bucket]);
+			totalNs.store(totalNs.load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+			if (ns > maxNs.load(std::memory_order_relaxed)) maxNs.store(ns, std::memory_order_relaxed);
+		}
+	};
+
+	Histogram histograms[histogramCount];
+	std::atomic<ma_uint64> callbacks{0}, overHalf{0}, overThreeQuarters{0}, missed{0}, gaps{0}, periodNs{0};
+	std::atomic<bool> resetRequested{false};
+	double current[stageCount] = {}; // Audio thread only, seconds spent in each stage this callback
+
+	// Single writer, so a load and a store is enough and cheaper than fetch_add
+	static void bump(std::atomic<ma_uint64>& counter) {
+		counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	}
+	static unsigned long long load(const std::atomic<ma_uint64>& counter) {
+		return (unsigned long long)counter.load(std::memory_order_relaxed);
+	}
+
+	void clear() {
+		for (Histogram& histogram : histograms) {
+			for (std::atomic<ma_uint64>& bucket : histogram.buckets) {
+				bucket.store(0, std::memory_order_relaxed);
+			}
+			histogram.totalNs.store(0, std::memory_order_relaxed);
+			histogram.maxNs.store(0, std::memory_order_relaxed);
+		}
+		callbacks.store(0, std::memory_order_relaxed);
+		overHalf.store(0, std::memory_order_relaxed);
+		overThreeQuarters.store(0, std::memory_order_relaxed);
+		missed.store(0, std::memory_order_relaxed);
+		gaps.store(0, std::memory_order_relaxed);
+	}
+};
+
+#endif /* MA_TELEMETRY_H */
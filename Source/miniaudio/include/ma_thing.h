@@ -1,17 +1,63 @@
 #ifndef MA_THING_H
 #define MA_THING_H
+
+/*
+	* The hxcpp binding. MiniAudio.hx externs these names, and each one is an inline forward to the engine (see
+	* ma_mixer.h), so calling through here costs nothing over calling the engine itself.
+*/
+
 #include <vector>
+#include "ma_mixer.h"
 
-int getMixerState(void);
-double getPlaybackPosition(void);
-double getDuration(void);
-void seekToPCMFrame(int64_t pos);
-void deactivate_decoder(int index);
-void amplify_decoder(int index, double volume);
-void setPlaybackRate(float value);
-void destroy(void);
-void start(void);
-void stop(void);
-int stopped(void);
-void loadFiles(std::vector<const char*> argv);
+inline int getMixerState(void) { return mixer_get_state(); }
+inline double getPlaybackPosition(void) { return mixer_get_playback_position(); }
+inline double getDuration(void) { return mixer_get_duration(); }
+inline void seekToPCMFrame(int64_t pos) { mixer_seek_to_pcm_frame(pos); }
+inline int setLoop(int64_t startFrame, int64_t endFrame, int crossfadeFrames) { return mixer_set_loop(startFrame, endFrame, crossfadeFrames); }
+inline void clearLoop(void) { mixer_clear_loop(); }
+inline void deactivate_decoder(int index) { mixer_deactivate_stem(index); }
+inline void amplify_decoder(int index, double volume) { mixer_set_stem_volume(index, volume); }
+inline void setStemPan(int index, double pan) { mixer_set_stem_pan(index, pan); }
+inline void setStemMute(int index, int muted) { mixer_set_stem_mute(index, muted); }
+inline int scheduleChange(int type, int index, double value, int64_t frame) { return mixer_schedule_change(type, index, value, frame); }
+inline void clearSchedule(void) { mixer_clear_schedule(); }
+inline int getStemMeters(double* out, int capacity) { return mixer_get_stem_meters(out, capacity); }
+inline int getSnapshot(double* out, int capacity) { return mixer_get_snapshot(out, capacity); }
+inline int getTelemetryJson(unsigned char* out, int capacity) { return mixer_get_telemetry_json((char*)out, capacity); }
+inline void resetTelemetry(void) { mixer_reset_telemetry(); }
+inline int pollEvents(double* out, int capacity) { return mixer_poll_events(out, capacity); }
+inline void addMarker(int id, int64_t frame) { mixer_add_marker(id, frame); }
+inline void clearMarkers(void) { mixer_clear_markers(); }
+inline void setConductorMap(const double* changes, int count) { mixer_set_conductor_map(changes, count); }
+inline void setConductorTicks(int mode) { mixer_set_conductor_ticks(mode); }
+inline float* getStemPCM(int index) { return (float*)mixer_get_stem_pcm(index); }
+inline int getStemFrames(int index) { return mixer_get_stem_frames(index); }
+inline int getStemPeakLevels(int index) { return mixer_get_stem_peak_levels(index); }
+inline float* getStemPeaks(int index, int level) { return (float*)mixer_get_stem_peaks(index, level); }
+inline int getStemPeakCount(int index, int level) { return mixer_get_stem_peak_count(index, level); }
+inline void setStemFilter(int index, int type, double frequency, double gainDb, double q) { mixer_set_stem_filter(index, type, frequency, gainDb, q); }
+inline void setReverb(int mode, double send, double roomMs, double decaySeconds, double dampingHz) { mixer_set_reverb(mode, send, roomMs, decaySeconds, dampingHz); }
+inline void setPlaybackRate(float value) { mixer_set_playback_rate(value); }
+inline void setStretchPreset(int preset) { mixer_set_stretch_preset(preset); }
+inline void setRateMode(int mode) { mixer_set_rate_mode(mode); }
+inline void setStretchSeed(int seed) { mixer_set_stretch_seed(seed); }
+inline void setPrerenderRates(const float* rates, int count) { mixer_set_prerender_rates(rates, count); }
+inline void setWaveformMode(int mode) { mixer_set_waveform_mode(mode); }
+inline void destroy(void) { mixer_destroy(); }
+inline void start(void) { mixer_start(); }
+inline void stop(void) { mixer_stop(); }
+inline int stopped(void) { return mixer_stopped(); }
+inline void loadFiles(std::vector<const char*> argv) { mixer_load_files(argv.data(), (int)argv.size()); }
+inline void loadFromMemory(std::vector<const unsigned char*> data, const int* sizes) { mixer_load_from_memory((const void* const*)data.data(), sizes, (int)data.size()); }
+inline int mountPack(const char* path) { return mixer_mount_pack(path); }
+inline void unmountPack(void) { mixer_unmount_pack(); }
+inline int addPackEntry(const char* name, int64_t offset, int64_t size) { return mixer_add_pack_entry(name, offset, size); }
+inline int loadSfx(const char* path) { return mixer_load_sfx(path); }
+inline int loadSfxFromMemory(const unsigned char* data, int size) { return mixer_load_sfx_from_memory(data, size); }
+inline void unloadSfx(int id) { mixer_unload_sfx(id); }
+inline int playSfx(int id, double gain, double pan, int64_t frame) { return mixer_play_sfx(id, gain, pan, frame); }
+inline void stopSfx(void) { mixer_stop_sfx(); }
+inline int previewFiles(std::vector<const char*> argv, int64_t startFrame, int fadeFrames) { return mixer_preview_files(argv.data(), (int)argv.size(), startFrame, fadeFrames); }
+inline void stopPreview(int fadeFrames) { mixer_stop_preview(fadeFrames); }
+inline void closePreview(void) { mixer_close_preview(); }
 #endif /* MA_THING_H */
\ No newline at end of file
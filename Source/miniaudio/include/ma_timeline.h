@@ -0,0 +1,111 @@
+#ifndef MA_TIMELINE_H
+#define MA_TIMELINE_H
+
+/*
+	* Stem and rate changes scheduled on frames of the song, for charts that drop a vocal out or ramp the speed on an
+	* exact beat. The audio thread splits its callback at the next change so it lands on its frame rather than at
+	* the start of whichever callback comes after it.
+
+	* The game thread hands changes over through a lock-free ring, the audio thread sorts them into a list that was
+	* allocated up front, so neither side locks or allocates.
+
+	* Needs miniaudio.h included before it.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+/*
+* 0 = VOLUME (index = the stem, value = linear volume)
+* 1 = MUTE (index = the stem, value = 1 to mute, 0 to unmute)
+* 2 = RATE (value = the playback rate)
+* 3 = PAN (index = the stem, value = -1 left to 1 right)
+*/
+struct TimelineChange {
+	ma_uint64 frame = 0;
+	int type = 0;
+	int index = 0;
+	float value = 0;
+};
+
+class Timeline {
+public:
+	static constexpr int queueCapacity = 1024; // Power of 2
+	static constexpr int maxPending = 4096;
+
+	Timeline() {
+		pending.reserve(maxPending);
+	}
+
+	/* Producer (the game thread). Returns false if the ring is full, which only happens if the audio thread isn't running. */
+	bool push(ma_uint64 frame, int type, int index, float value) {
+		return pushChange(TimelineChange{frame, type, index, value});
+	}
+
+	/* Producer. Drops every change that hasn't happened yet, including ones still in the ring. */
+	bool clear() {
+		return pushChange(TimelineChange{0, -1, 0, 0});
+	}
+
+	/*
+	* Consumer, with decoderMutex held. Sorts whatever came in through the ring into the pending list. Changes on the
+	* same frame keep the order they were scheduled in, and ones that don't fit in the list any more are dropped.
+	*/
+	void drain() {
+		unsigned int read = readIndex.load(std::memory_order_relaxed);
+		unsigned int write = writeIndex.load(std::memory_order_acquire);
+		for (; read != write; ++read) {
+			const TimelineChange& change = ring[read & (queueCapacity - 1)];
+			if (change.type < 0) {
+				pending.clear();
+				continue;
+			}
+			if (pending.size() >= (size_t)maxPending) continue;
+			// Latest first, so the next one due is always at the back
+			auto it = std::lower_bound(pending.begin(), pending.end(), change.frame, [](const TimelineChange& c, ma_uint64 frame) {
+				return c.frame > frame;
+			});
+			pending.insert(it, change);
+		}
+		readIndex.store(read, std::memory_order_release);
+	}
+
+	/* Consumer. The frame of the next pending change, false if there isn't one. */
+	bool next(ma_uint64& frame) const {
+		if (pending.empty()) return false;
+		frame = pending.back().frame;
+		return true;
+	}
+
+	/* Consumer. Hands every change due at or before `frame` to `apply`, oldest first, and forgets it. */
+	template<class Apply>
+	void applyDue(ma_uint64 frame, Apply apply) {
+		while (!pending.empty() && pending.back().frame <= frame) {
+			TimelineChange change = pending.back();
+			pending.pop_back();
+			apply(change);
+		}
+	}
+
+	/* Consumer side, e.g. on load. Forgets everything, pending or still in the ring. */
+	void reset() {
+		pending.clear();
+		readIndex.store(writeIndex.load(std::memory_order_acquire), std::memory_order_release);
+	}
+
+private:
+	std::vector<TimelineChange> pending;
+	TimelineChange ring[queueCapacity];
+	std::atomic<unsigned int> writeIndex{0}, readIndex{0};
+
+	bool pushChange(const TimelineChange& change) {
+		unsigned int write = writeIndex.load(std::memory_order_relaxed);
+		if (write - readIndex.load(std::memory_order_acquire) >= (unsigned int)queueCapacity) return false;
+		ring[write & (queueCapacity - 1)] = change;
+		writeIndex.store(write + 1, std::memory_order_release);
+		return true;
+	}
+};
+
+#endif /* MA_TIMELINE_H */
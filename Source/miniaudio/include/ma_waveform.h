@@ -0,0 +1,150 @@
+#ifndef MA_WAVEFORM_H
+#define MA_WAVEFORM_H
+
+/*
+	* Waveform data for editors, built on a worker thread once a song is loaded: a min/max peak pyramid per stem and,
+	* if asked for, the whole stem decoded into memory. Everything is written once and then only read, so the getters
+	* hand out pointers straight into it - nothing gets copied for the UI.
+
+	* Level 0 of the pyramid has one min/max pair per channel for every baseBucketFrames frames, each level above it
+	* halves that, down to a single bucket for the whole stem. Bucket b, channel c of a level is at (b * channels + c) * 2
+	* (min, then max).
+
+	* Needs miniaudio.h, ma_resampler.h and ma_sources.h included before it.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct StemWaveform {
+	std::vector<float> pcm; // Interleaved, empty unless the PCM was asked for
+	ma_uint64 frameCount = 0;
+	std::vector<std::vector<float>> peaks; // One per level
+	std::atomic<int> ready{0};
+};
+
+class WaveformCache {
+public:
+	static constexpr ma_uint32 baseBucketFrames = 64;
+
+	~WaveformCache() {
+		cancel();
+	}
+
+	/*
+	* Starts decoding `sources` in the background (with their own decoders, the playback ones belong to the audio thread).
+	* Stems become readable one at a time as they finish.
+	*/
+	void start(const std::vector<StemSource>& sources, ma_uint32 channels, ma_uint32 sampleRate, bool keepPcm) {
+		cancel();
+		if (sources.empty()) return;
+
+		cancelled = false;
+		waveformChannels = channels;
+		for (size_t i = 0; i < sources.size(); ++i) {
+			stems.emplace_back(new StemWaveform());
+		}
+
+		worker = std::thread([this, sources, channels, sampleRate, keepPcm]() {
+			for (size_t i = 0; i < sources.size() && !cancelled; ++i) {
+				if (build(sources[i], channels, sampleRate, keepPcm, *stems[i]) && !cancelled) {
+					stems[i]->ready.store(1, std::memory_order_release);
+				}
+			}
+		});
+	}
+
+	/* Stops any decoding in progress and frees everything, so nobody may still be holding a pointer from find(). */
+	void cancel() {
+		cancelled = true;
+		if (worker.joinable()) worker.join();
+		stems.clear();
+	}
+
+	/* The finished waveform for a stem, or NULL if it isn't ready (yet). */
+	const StemWaveform* find(int index) const {
+		if (index < 0 || index >= (int)stems.size()) return NULL;
+		const StemWaveform* stem = stems[index].get();
+		return stem->ready.load(std::memory_order_acquire) ? stem : NULL;
+	}
+
+	ma_uint32 channels() const {
+		return waveformChannels;
+	}
+
+private:
+	static constexpr ma_uint32 decodeBlockFrames = 4096; // A multiple of baseBucketFrames
+
+	std::vector<std::unique_ptr<StemWaveform>> stems;
+	std::thread worker;
+	std::atomic<bool> cancelled{false};
+	ma_uint32 waveformChannels = 0;
+
+	bool build(const StemSource& source, ma_uint32 channels, ma_uint32 sampleRate, bool keepPcm, StemWaveform& stem) {
+		ma_decoder_config config = polyphase_decoder_config_init(ma_format_f32, channels, sampleRate);
+		ma_decoder decoder;
+		if (source.open(&config, &decoder) != MA_SUCCESS) {
+			printf("Waveform: failed to load %s.\n", source.path.c_str());
+			return false;
+		}
+
+		ma_uint64 length = 0;
+		ma_decoder_get_length_in_pcm_frames(&decoder, &length);
+		if (keepPcm) stem.pcm.reserve(length * channels);
+		stem.peaks.emplace_back();
+		std::vector<float>& base = stem.peaks[0];
+		base.reserve((length / baseBucketFrames + 1) * channels * 2);
+
+		// Level 0 comes straight from the decoder, so the PCM never has to be kept just for the peaks
+		std::vector<float> temp(decodeBlockFrames * channels);
+		while (!cancelled) {
+			ma_uint64 framesRead = 0;
+			ma_result result = ma_decoder_read_pcm_frames(&decoder, temp.data(), decodeBlockFrames, &framesRead);
+			if (framesRead == 0) break;
+
+			if (keepPcm) stem.pcm.insert(stem.pcm.end(), temp.begin(), temp.begin() + framesRead * channels);
+			for (ma_uint64 start = 0; start < framesRead; start += baseBucketFrames) {
+				ma_uint64 end = std::min(framesRead, start + baseBucketFrames);
+				for (ma_uint32 c = 0; c < channels; ++c) {
+					float low = temp[start * channels + c], high = low;
+					for (ma_uint64 i = start + 1; i < end; ++i) {
+						float v = temp[i * channels + c];
+						low = std::min(low, v);
+						high = std::max(high, v);
+					}
+					base.push_back(low);
+					base.push_back(high);
+				}
+			}
+			stem.frameCount += framesRead;
+
+			if (result != MA_SUCCESS) break;
+		}
+		ma_decoder_uninit(&decoder);
+		if (cancelled || stem.frameCount == 0) return false;
+
+		// Each level merges pairs of buckets from the one below
+		while (stem.peaks.back().size() > channels * 2) {
+			const std::vector<float>& below = stem.peaks.back();
+			size_t belowBuckets = below.size() / (channels * 2);
+			std::vector<float> level;
+			level.reserve((belowBuckets + 1) / 2 * channels * 2);
+			for (size_t b = 0; b < belowBuckets; b += 2) {
+				for (ma_uint32 c = 0; c < channels; ++c) {
+					const float* first = below.data() + (b * channels + c) * 2;
+					const float* second = b + 1 < belowBuckets ? below.data() + ((b + 1) * channels + c) * 2 : first;
+					level.push_back(std::min(first[0], second[0]));
+					level.push_back(std::max(first[1], second[1]));
+				}
+			}
+			stem.peaks.push_back(std::move(level));
+		}
+		return true;
+	}
+};
+
+#endif /* MA_WAVEFORM_H */
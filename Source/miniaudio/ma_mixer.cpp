@@ -0,0 +1,1815 @@
+﻿/*
+	* If it weren't for ChatGPT's and Estrol's help the time-stretching shit wouldn't have been possible.
+	* Honestly thank fucking god cuz I'm ready to put this all together nicely.
+
+	Oh and Estrol has his own fork of signalsmith-stretch if you want to go check it out: https://github.com/Estrol/signalsmith-stretch
+	(It was updated recently as of the time when developing the time stretching implementation for fun)
+
+	* Note: Fuck hxcpp's externing shit I don't wanna deal with it for any longer
+
+	* This is the whole mixer, behind the plain C functions in include/ma_mixer.h. The Haxe bindings only forward to
+	* them: include/ma_thing.h for hxcpp, ma_thing_hl.cpp for HashLink.
+*/
+#include "include/ma_mixer.h"
+
+#include "signalsmith-stretch/signalsmith-stretch.h"
+#include "signalsmith-stretch/dsp/filters.h"
+#include "signalsmith-stretch/dsp/envelopes.h"
+#include "signalsmith-stretch/dsp/rates.h"
+#include "signalsmith-stretch/dsp/mix.h"
+
+#if defined(_WIN32)
+#define NOMINMAX // miniaudio pulls in windows.h, whose min/max macros break std::min/std::max in the headers below
+#endif
+#define MINIAUDIO_IMPLEMENTATION
+#include "miniaudio.h"
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "include/ma_resampler.h"
+#include "include/ma_sources.h"
+#include "include/ma_prerender.h"
+#include "include/ma_meters.h"
+#include "include/ma_reverb.h"
+#include "include/ma_events.h"
+#include "include/ma_conductor.h"
+#include "include/ma_snapshot.h"
+#include "include/ma_waveform.h"
+#include "include/ma_sfx.h"
+#include "include/ma_timeline.h"
+#include "include/ma_loop.h"
+#include "include/ma_preview.h"
+#include "include/ma_telemetry.h"
+
+/*
+For simplicity, this example requires the device to use floating point samples.
+*/
+#define SAMPLE_FORMAT   ma_format_f32
+#define CHANNEL_COUNT   2
+#define SAMPLE_RATE     44100
+
+signalsmith::stretch::SignalsmithStretch* stretch = nullptr;
+std::vector<float> primeData; // What primeStretch() seeks the stretcher with, see installStretch()
+double stretchInputCarry = 0; // The fraction of an input frame the last stretched chunk was owed, so short chunks still add up to the rate
+
+ma_uint32   g_decoderCount;
+ma_decoder* g_pDecoders;
+ma_bool32* g_pDecodersActive;
+ma_uint64* g_pDecoderLengths;
+int g_pLongestDecoderIndex;
+float*  g_pDecodersVolume;
+float*  g_pDecodersPan; // -1 (left) to 1 (right), as a balance: 0 leaves the stem as it is
+ma_bool32* g_pDecodersMuted; // Silent but still playing, so unlike deactivating it can come back in time
+float playbackRate = 1;
+
+/*
+* Rates to pre-render the song at once it's loaded. Empty = off, every rate is stretched live.
+*/
+std::vector<float> prerenderRates;
+std::vector<StemSource> g_loadedSources; // The pre-render and waveform workers open their own decoders
+PackVfs packVfs; // Mounted pack, mixer_load_files() looks in here before the file system
+PrerenderCache prerender;
+ma_bool32 g_prerenderEnabled = MA_FALSE;
+PrerenderedRate* g_pActivePrerender = NULL; // Set while playback reads from a pre-rendered variant instead of the decoders
+ma_uint64 prerenderCursor = 0; // Output frame within g_pActivePrerender
+ma_bool32 g_stemsDeactivated = MA_FALSE; // Pre-rendered audio is the plain mix, so any stem changes rule it out
+
+/*
+* Waveform data for editors, built in the background after every load (see ma_waveform.h).
+* 0 = OFF
+* 1 = PEAKS (a min/max pyramid per stem)
+* 2 = PEAKS_AND_PCM (also keeps every stem decoded in memory, about 10MB per stem-minute)
+*/
+int WAVEFORM_MODE = 0;
+WaveformCache waveforms;
+
+/*
+* Per-stem EQ, one biquad per stem channel. Stem i's channels are filters i * CHANNEL_COUNT + c.
+* 0 = OFF
+* 1 = HIGH_PASS
+* 2 = LOW_PASS
+* 3 = LOW_SHELF
+* 4 = HIGH_SHELF
+* 5 = PEAK
+*/
+signalsmith::filters::BiquadBank stemEq;
+int* g_pStemFilterTypes = NULL;
+ma_bool32 g_stemEqActive = MA_FALSE; // Only mixed through the bank while at least one stem has a filter
+std::vector<float> stemEqScratch; // Lane-interleaved, STEM_EQ_BLOCK frames of stemEq.stride() floats
+#define STEM_EQ_BLOCK 1024
+
+/*
+* One meter per stem (post volume and EQ), then one for the whole mix at index g_decoderCount.
+*/
+StemMeters stemMeters;
+
+ReverbBus reverb; // Send on the whole mix, see mixer_set_reverb()
+
+/*
+* What mixer_get_snapshot() hands out. The callback timing below is only touched with decoderMutex held.
+*/
+SnapshotPublisher snapshots;
+ma_uint32 g_lateCallbacks = 0; // Callbacks that took longer than the audio they produced
+ma_uint32 g_callbackGaps = 0; // Callbacks that started more than twice the previous one's length after it
+std::chrono::steady_clock::time_point lastCallbackStart;
+double lastCallbackPeriod = 0; // 0 = no callback since mixer_start()
+
+/*
+* Callback timing histograms, kept across songs until mixer_reset_telemetry(). See mixer_get_telemetry_json().
+*/
+CallbackTelemetry telemetry;
+
+/*
+* What mixer_poll_events() hands out. Everything that pushes does it with decoderMutex held, which keeps it single-producer.
+*/
+EventQueue events;
+MarkerList markers;
+Conductor conductor; // BPM map of the loaded song, see mixer_set_conductor_map()
+
+/*
+* Which conductor ticks go into the event queue.
+* 0 = OFF
+* 1 = BEATS
+* 2 = BEATS_AND_STEPS
+*/
+int CONDUCTOR_TICKS = 0;
+/*
+* Sound effects, mixed on top of the music after the meters, so those stay music only. See mixer_load_sfx().
+*/
+SfxPool sfx;
+
+/*
+* Stem and rate changes on exact frames, see mixer_schedule_change(). Drained and applied by the audio thread only.
+*/
+Timeline timeline;
+
+/*
+* Practice loop, see mixer_set_loop(). Engaged by the audio thread once its window is decoded.
+*/
+LoopRegion loop;
+
+/*
+* Song select previews, on a device of their own that stays open between songs, see mixer_preview_files().
+*/
+PreviewPlayer preview;
+ma_device previewDevice;
+ma_bool32 g_previewOpen = MA_FALSE;
+
+std::vector<ma_uint32> endedStems; // Audio thread only, stems that ran out during the current callback
+ma_uint32 g_seekCount = 0; // So a callback can tell it was seeked across
+
+/*
+* 0 = CHEAPER (100ms blocks, the original behaviour)
+* 1 = DEFAULT (120ms blocks)
+* 2 = LOW_LATENCY (60ms blocks)
+* 3 = LOWEST_LATENCY (40ms blocks)
+* 4 = ADAPTIVE (picks one of the above per playback rate, all pre-allocated)
+*/
+int STRETCH_PRESET = 0;
+
+/*
+* Seed for the stretcher's random per-bin time factors. Negative = random on every stretcher (the original behaviour),
+* anything else makes the stretched output reproducible.
+*/
+int STRETCH_SEED = -1;
+
+/*
+* What the playback rate does:
+* 0 = STRETCH (changes the tempo but keeps the pitch, the original behaviour)
+* 1 = VARISPEED (tempo and pitch together, like speeding up a record). Much cheaper, just a resampler.
+*/
+int RATE_MODE = 0;
+signalsmith::rates::PolyphaseResampler<float> varispeed(CHANNEL_COUNT, 4096);
+
+/*
+* 0 = UNDEFINED
+* 1 = PLAYING
+* 2 = STOPPED
+* 3 = FINISHED
+*/
+int MIXER_STATE = 3;
+
+/*
+* 0 = false
+* 1 = true
+*/
+int exists = 0;
+
+ma_result result;
+ma_decoder_config decoderConfig;
+ma_device_config deviceConfig;
+ma_device device;
+ma_uint32 iDecoder;
+
+/*
+* IMPORTANT!
+* When I decoded an mp3 and a flac at the same time and seeked the app crashes so running with mutexes fixes this.
+*/
+ma_mutex decoderMutex;
+ma_bool32 decoderMutexReady = MA_FALSE; // ma_mutex is a HANDLE on Windows but a struct elsewhere, so it can't be compared with NULL
+
+signalsmith::stretch::SignalsmithStretch* createStretch() {
+	signalsmith::stretch::SignalsmithStretch* newStretch = STRETCH_SEED >= 0 ? new signalsmith::stretch::SignalsmithStretch(STRETCH_SEED) : new signalsmith::stretch::SignalsmithStretch();
+	switch (STRETCH_PRESET) {
+		case 1: newStretch->presetDefault(CHANNEL_COUNT, SAMPLE_RATE); break;
+		case 2: newStretch->presetLowLatency(CHANNEL_COUNT, SAMPLE_RATE); break;
+		case 3: newStretch->presetLowestLatency(CHANNEL_COUNT, SAMPLE_RATE); break;
+		case 4: newStretch->presetAdaptive(CHANNEL_COUNT, SAMPLE_RATE); break;
+		default: newStretch->presetCheaper(CHANNEL_COUNT, SAMPLE_RATE); break;
+	}
+	return newStretch;
+}
+
+/*
+* Feeds the stretcher what comes just before the decoder cursor, so it doesn't start from stale history.
+* Call with decoderMutex held.
+*/
+void primeStretch() {
+	stretchInputCarry = 0;
+	if (stretch == nullptr || playbackRate == 1.0f || exists == 0) return;
+
+	// The timeline primes from the audio thread, so this only fills what installStretch() sized for the largest latency
+	int latencyFrames = stretch->inputLatency();
+	std::fill(primeData.begin(), primeData.begin() + latencyFrames * CHANNEL_COUNT, 0.0f);
+
+	// only need to seek from one decoder
+	ma_decoder* pDecoder = &g_pDecoders[g_pLongestDecoderIndex];
+	ma_uint64 cursor = 0;
+	ma_decoder_get_cursor_in_pcm_frames(pDecoder, &cursor);
+	ma_decoder_read_pcm_frames(pDecoder, primeData.data(), latencyFrames, NULL);
+	ma_decoder_seek_to_pcm_frame(pDecoder, cursor);
+
+	stretch->seek(primeData.data(), latencyFrames, playbackRate);
+}
+
+/*
+* Makes newStretch the live stretcher, adapted and primed for the current rate, and returns the one it replaced (to
+* delete after unlocking). Call with decoderMutex held, from the game thread: it may grow primeData.
+*/
+signalsmith::stretch::SignalsmithStretch* installStretch(signalsmith::stretch::SignalsmithStretch* newStretch) {
+	size_t primeSize = (size_t)newStretch->maxInputLatency() * CHANNEL_COUNT;
+	if (primeData.size() < primeSize) primeData.resize(primeSize);
+
+	signalsmith::stretch::SignalsmithStretch* oldStretch = stretch;
+	stretch = newStretch;
+	stretch->adapt(playbackRate); // Only does anything for the adaptive preset
+	primeStretch(); // It starts with no input history, same as after a seek
+	return oldStretch;
+}
+
+/*
+* Creates the stretcher the first time it could be needed, off the audio thread. Without decoderMutex held.
+*/
+void ensureStretch() {
+	if (stretch != nullptr) return;
+	signalsmith::stretch::SignalsmithStretch* newStretch = createStretch();
+
+	if (!decoderMutexReady) {
+		decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+	}
+	ma_mutex_lock(&decoderMutex);
+	if (stretch == nullptr) newStretch = installStretch(newStretch); // Hands back the null it replaced
+	ma_mutex_unlock(&decoderMutex);
+	delete newStretch; // Only if another thread got there first
+}
+
+ma_bool32 stemsAtDefaults() {
+	if (g_stemsDeactivated || g_stemEqActive || loop.active()) return MA_FALSE;
+	for (ma_uint32 i = 0; i < g_decoderCount; ++i) {
+		if (g_pDecodersVolume[i] != 1.0f || g_pDecodersPan[i] != 0.0f || g_pDecodersMuted[i]) return MA_FALSE;
+	}
+	return MA_TRUE;
+}
+
+/*
+* What stem `index` is multiplied by: its volume, unless it's muted.
+*/
+float stemGain(ma_uint32 index) {
+	return g_pDecodersMuted[index] ? 0.0f : g_pDecodersVolume[index];
+}
+
+/*
+* Same as stemGain() for one channel, with the pan on top.
+*/
+float stemChannelGain(ma_uint32 index, ma_uint32 channel) {
+	float pan = g_pDecodersPan[index];
+	float balance = 1;
+	if (CHANNEL_COUNT == 2) {
+		balance = channel == 0 ? (pan > 0 ? 1 - pan : 1) : (pan < 0 ? 1 + pan : 1);
+	}
+	return stemGain(index) * balance;
+}
+
+/*
+* Switches between a finished pre-rendered variant and live stretching without moving the playback position.
+* Call with decoderMutex held.
+*/
+void routePrerender() {
+	PrerenderedRate* target = NULL;
+	if (g_prerenderEnabled && playbackRate != 1.0f && RATE_MODE == 0 && stemsAtDefaults()) {
+		target = prerender.find(playbackRate);
+	}
+	if (target == g_pActivePrerender) return;
+
+	if (g_pActivePrerender != NULL) {
+		// The decoders were parked, pick them up from where the pre-rendered audio got to
+		ma_uint64 pos = (ma_uint64)(prerenderCursor * (double)g_pActivePrerender->rate);
+		for (ma_uint32 i = 0; i < g_decoderCount; ++i) {
+			ma_decoder_seek_to_pcm_frame(&g_pDecoders[i], pos);
+			g_pDecodersActive[i] = pos < g_pDecoderLengths[i] ? MA_TRUE : MA_FALSE;
+		}
+	}
+
+	if (target != NULL) {
+		ma_uint64 cursor = g_pDecoderLengths[g_pLongestDecoderIndex];
+		if (g_pDecodersActive[g_pLongestDecoderIndex] == MA_TRUE) {
+			ma_decoder_get_cursor_in_pcm_frames(&g_pDecoders[g_pLongestDecoderIndex], &cursor);
+		}
+		prerenderCursor = (ma_uint64)(cursor / (double)target->rate);
+	}
+
+	g_pActivePrerender = target;
+	if (target == NULL) {
+		primeStretch();
+	}
+}
+
+void onPrerenderReady() {
+	if (!decoderMutexReady) {
+		decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+	}
+	ma_mutex_lock(&decoderMutex);
+	if (exists == 1) {
+		routePrerender();
+	}
+	ma_mutex_unlock(&decoderMutex);
+}
+
+void startPrerender() {
+	if (prerenderRates.empty()) return;
+
+	if (!decoderMutexReady) {
+		decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+	}
+	ma_mutex_lock(&decoderMutex);
+	g_prerenderEnabled = MA_TRUE;
+	ma_mutex_unlock(&decoderMutex);
+
+	prerender.start(g_loadedSources, prerenderRates, CHANNEL_COUNT, SAMPLE_RATE, STRETCH_SEED, onPrerenderReady);
+}
+
+/*
+* Gets playback off the pre-rendered variants and then frees them. Must not be called with decoderMutex held,
+* since a worker that's just finishing needs it.
+*/
+void stopPrerender() {
+	if (!decoderMutexReady) {
+		decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+	}
+	ma_mutex_lock(&decoderMutex);
+	g_prerenderEnabled = MA_FALSE;
+	routePrerender();
+	ma_mutex_unlock(&decoderMutex);
+
+	prerender.cancel();
+}
+
+void startWaveforms() {
+	if (WAVEFORM_MODE == 0) return;
+	waveforms.start(g_loadedSources, CHANNEL_COUNT, SAMPLE_RATE, WAVEFORM_MODE == 2);
+}
+
+/*
+* Where playback is, in PCM frames (0 once the longest stem has run out). Call with decoderMutex held.
+*/
+ma_uint64 playbackFrame() {
+	if (loop.engaged() && g_pDecodersActive[g_pLongestDecoderIndex]) {
+		return loop.position(g_pLongestDecoderIndex); // The decoders may be parked while it plays from memory
+	}
+	ma_uint64 pos = 0;
+	PrerenderedRate* variant = g_pActivePrerender;
+	if (variant != NULL) {
+		pos = (ma_uint64)(prerenderCursor * (double)variant->rate); // The decoders are parked while it plays
+	} else if (g_pDecodersActive[g_pLongestDecoderIndex] == MA_TRUE) {
+		ma_decoder_get_cursor_in_pcm_frames(&g_pDecoders[g_pLongestDecoderIndex], &pos);
+	}
+	return pos;
+}
+
+/*
+* Fills in and publishes the next snapshot. startFrame and periodSeconds describe the callback it comes from,
+* anything else passes the current frame and 0. Call with decoderMutex held, only while a song is loaded.
+*/
+void publishSnapshot(ma_uint64 startFrame, double periodSeconds) {
+	MixerSnapshot& snapshot = snapshots.back();
+	snapshot.startPositionMs = (double)startFrame / (SAMPLE_RATE * 0.001);
+	snapshot.positionMs = (double)playbackFrame() / (SAMPLE_RATE * 0.001);
+	snapshot.periodSeconds = periodSeconds;
+	snapshot.durationMs = (double)g_pDecoderLengths[g_pLongestDecoderIndex] / (SAMPLE_RATE * 0.001);
+	snapshot.rate = playbackRate;
+	snapshot.state = MIXER_STATE;
+	snapshot.lateCallbacks = g_lateCallbacks;
+	snapshot.callbackGaps = g_callbackGaps;
+	snapshot.conductor = conductor.at((double)startFrame);
+	for (ma_uint32 i = 0; i < g_decoderCount && i < snapshot.stems.size(); ++i) {
+		snapshot.stems[i].active = g_pDecodersActive[i];
+		snapshot.stems[i].volume = g_pDecodersVolume[i];
+	}
+	if (g_decoderCount < snapshot.stems.size()) {
+		StemSnapshot& mix = snapshot.stems[g_decoderCount];
+		mix.active = g_pDecodersActive[g_pLongestDecoderIndex];
+		mix.volume = 1;
+	}
+	snapshots.publish();
+}
+
+/*
+* Counts the callbacks that probably let the device run dry: ones that took longer than the audio they produced,
+* and ones that started more than twice the previous one's length after it. Both get queued as UNDERRUN events at
+* startFrame. Returns whether this one came after a gap. Call with decoderMutex held.
+*/
+ma_bool32 countCallbackTiming(std::chrono::steady_clock::time_point callbackStart, double periodSeconds, ma_uint64 startFrame) {
+	std::chrono::duration<double> took = std::chrono::steady_clock::now() - callbackStart;
+	ma_bool32 gap = MA_FALSE;
+	if (took.count() > periodSeconds) {
+		++g_lateCallbacks;
+		events.push(2, 0, startFrame);
+	}
+	if (lastCallbackPeriod > 0) {
+		std::chrono::duration<double> sincePrevious = callbackStart - lastCallbackStart;
+		if (sincePrevious.count() > lastCallbackPeriod * 2) {
+			++g_callbackGaps;
+			events.push(2, 1, startFrame);
+			gap = MA_TRUE;
+		}
+	}
+	lastCallbackStart = callbackStart;
+	lastCallbackPeriod = periodSeconds;
+	return gap;
+}
+
+/*
+* A stem ran out. Audio thread only, its STEM_FINISHED event goes out at the end of the callback.
+*/
+void endStem(ma_uint32 index) {
+	if (!g_pDecodersActive[index]) return;
+	g_pDecodersActive[index] = MA_FALSE;
+	if (endedStems.size() < endedStems.capacity()) {
+		endedStems.push_back(index);
+	}
+}
+
+/*
+* Queues the markers played through, the loop wrapping and the stems (or song) that ended in a callback that started
+* at startFrame.
+* Call with decoderMutex held, from the audio thread.
+*/
+void pushSongHits(ma_uint64 startFrame, ma_uint64 endFrame) {
+	markers.pushHits(events, startFrame, endFrame);
+	if (CONDUCTOR_TICKS >= 1) {
+		conductor.pushTicks(events, 6, false, startFrame, endFrame);
+	}
+	if (CONDUCTOR_TICKS == 2) {
+		conductor.pushTicks(events, 7, true, startFrame, endFrame);
+	}
+}
+
+void pushCallbackEvents(ma_uint64 startFrame, ma_uint32 seekCount, ma_uint32 loopWraps, ma_bool32 songFinished) {
+	ma_uint64 songLength = g_pDecoderLengths[g_pLongestDecoderIndex];
+	ma_bool32 playing = g_pDecodersActive[g_pLongestDecoderIndex];
+	if ((playing || songFinished) && seekCount == g_seekCount) {
+		ma_uint64 endFrame = playing ? playbackFrame() : songLength;
+		if (loopWraps != loop.wraps()) {
+			// Up to the end of the loop, then on from where it carried on
+			pushSongHits(startFrame, loop.endFrame());
+			events.push(4, (int)loop.wraps(), loop.endFrame());
+			pushSongHits(loop.resumeFrame(), endFrame);
+		} else {
+			pushSongHits(startFrame, endFrame);
+		}
+	}
+
+	for (ma_uint32 index : endedStems) {
+		events.push(1, (int)index, g_pDecoderLengths[index]);
+	}
+	endedStems.clear();
+
+	if (songFinished) {
+		events.push(0, -1, songLength);
+	}
+}
+
+int mixer_get_state(void) {
+	return MIXER_STATE;
+}
+
+double mixer_get_playback_position(void) {
+	if (!decoderMutexReady) {
+		decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+	}
+	ma_mutex_lock(&decoderMutex);
+	ma_uint64 pos = playbackFrame();
+	ma_mutex_unlock(&decoderMutex);
+	return (double)pos / (SAMPLE_RATE * 0.001);
+}
+
+double mixer_get_duration(void) {
+	ma_uint64 length = 0;
+	if (g_pDecodersActive[g_pLongestDecoderIndex] == MA_TRUE) {
+		length = g_pDecoderLengths[g_pLongestDecoderIndex];
+	}
+	return (double)length / (SAMPLE_RATE * 0.001);
+}
+
+void mixer_seek_to_pcm_frame(int64_t pos) {
+	if (exists == 0) return;
+
+	if (!decoderMutexReady) {
+		decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+	}
+	ma_mutex_lock(&decoderMutex);
+	g_stemsDeactivated = MA_FALSE; // Seeking reactivates everything
+	for (iDecoder = 0; iDecoder < g_decoderCount; ++iDecoder) {
+		ma_decoder_seek_to_pcm_frame(&g_pDecoders[iDecoder], pos > 0 ? pos : 0);
+
+		// If we seek to before EOF, reactivate
+		if (pos < g_pDecoderLengths[iDecoder]) {
+			g_pDecodersActive[iDecoder] = MA_TRUE;
+		}
+	}
+	if (g_pActivePrerender != NULL) {
+		prerenderCursor = (ma_uint64)((pos > 0 ? pos : 0) / (double)g_pActivePrerender->rate);
+	}
+	if (loop.engaged()) {
+		ma_uint64 position = (ma_uint64)(pos > 0 ? pos : 0);
+		loop.seek(position);
+		for (iDecoder = 0; iDecoder < g_decoderCount && position < loop.endFrame(); ++iDecoder) {
+			g_pDecodersActive[iDecoder] = MA_TRUE; // Padded with silence until the loop wraps
+		}
+	}
+	varispeed.reset();
+	stretchInputCarry = 0;
+	routePrerender();
+	++g_seekCount;
+	events.push(3, -1, (ma_uint64)(pos > 0 ? pos : 0));
+	publishSnapshot(playbackFrame(), 0);
+	ma_mutex_unlock(&decoderMutex);
+}
+
+void freeThingies() {
+	free(g_pDecoders);
+	free(g_pDecodersActive);
+	free(g_pDecoderLengths);
+	free(g_pDecodersVolume);
+	free(g_pDecodersPan);
+	free(g_pDecodersMuted);
+	free(g_pStemFilterTypes);
+	g_pStemFilterTypes = NULL;
+}
+
+/*
+* Reads stem `index` from its decoder, or through the loop while it's engaged. Call with decoderMutex held.
+*/
+ma_result readStemFrames(ma_uint32 index, float* pFrames, ma_uint64 frameCount, ma_uint64* pFramesRead) {
+	std::chrono::steady_clock::time_point decodeStart = std::chrono::steady_clock::now();
+	ma_result result;
+	if (loop.engaged()) {
+		*pFramesRead = loop.read(index, &g_pDecoders[index], pFrames, frameCount);
+		result = *pFramesRead == frameCount ? MA_SUCCESS : MA_AT_END;
+	} else {
+		result = ma_decoder_read_pcm_frames(&g_pDecoders[index], pFrames, frameCount, pFramesRead);
+	}
+	telemetry.add(0, decodeStart);
+	return result;
+}
+
+ma_uint32 read_pcm_frames_f32(ma_uint32 index, float* pBuffer, ma_uint32 frameCount)
+{
+	float temp[4096];
+	ma_uint32 tempCapInFrames = 4096 / CHANNEL_COUNT;
+	ma_uint32 totalFramesRead = 0;
+	memset(temp, 0, sizeof(temp));
+	float gains[CHANNEL_COUNT];
+	for (ma_uint32 c = 0; c < CHANNEL_COUNT; ++c) {
+		gains[c] = stemChannelGain(index, c);
+	}
+
+	while (totalFramesRead < frameCount) {
+		ma_uint64 framesReadThisIteration;
+		ma_uint32 totalFramesRemaining = frameCount - totalFramesRead;
+		ma_uint32 framesToReadThisIteration = (totalFramesRemaining < tempCapInFrames) ? totalFramesRemaining : tempCapInFrames;
+
+		ma_result result = readStemFrames(index, temp, framesToReadThisIteration, &framesReadThisIteration);
+
+		if (result != MA_SUCCESS || framesReadThisIteration == 0) break;
+
+		for (ma_uint64 i = 0; i < framesReadThisIteration * CHANNEL_COUNT; ++i) {
+			pBuffer[totalFramesRead * CHANNEL_COUNT + i] += temp[i] * gains[i % CHANNEL_COUNT];
+		}
+		stemMeters.add(index, temp, (ma_uint32)framesReadThisIteration, CHANNEL_COUNT, CHANNEL_COUNT, stemGain(index));
+
+		totalFramesRead += (ma_uint32)framesReadThisIteration;
+
+		if (framesReadThisIteration < framesToReadThisIteration) break; // EOF
+	}
+
+	return totalFramesRead;
+}
+
+/*
+* Same as read_pcm_frames_f32(), but mixes into one buffer per channel for the stretcher.
+*/
+ma_uint32 read_pcm_frames_planar_f32(ma_uint32 index, float** ppChannels, ma_uint32 frameCount)
+{
+	float temp[4096];
+	ma_uint32 tempCapInFrames = 4096 / CHANNEL_COUNT;
+	ma_uint32 totalFramesRead = 0;
+	float gains[CHANNEL_COUNT];
+	for (ma_uint32 c = 0; c < CHANNEL_COUNT; ++c) {
+		gains[c] = stemChannelGain(index, c);
+	}
+
+	while (totalFramesRead < frameCount) {
+		ma_uint64 framesReadThisIteration;
+		ma_uint32 totalFramesRemaining = frameCount - totalFramesRead;
+		ma_uint32 framesToReadThisIteration = (totalFramesRemaining < tempCapInFrames) ? totalFramesRemaining : tempCapInFrames;
+
+		ma_result result = readStemFrames(index, temp, framesToReadThisIteration, &framesReadThisIteration);
+
+		if (result != MA_SUCCESS || framesReadThisIteration == 0) break;
+
+		for (ma_uint32 c = 0; c < CHANNEL_COUNT; ++c) {
+			float* pChannel = ppChannels[c] + totalFramesRead;
+			for (ma_uint64 i = 0; i < framesReadThisIteration; ++i) {
+				pChannel[i] += temp[i * CHANNEL_COUNT + c] * gains[c];
+			}
+		}
+		stemMeters.add(index, temp, (ma_uint32)framesReadThisIteration, CHANNEL_COUNT, CHANNEL_COUNT, stemGain(index));
+
+		totalFramesRead += (ma_uint32)framesReadThisIteration;
+
+		if (framesReadThisIteration < framesToReadThisIteration) break; // EOF
+	}
+
+	return totalFramesRead;
+}
+
+/*
+* Mixes the active stems through their EQ into one buffer per channel, overwriting it. The bank filters every stem
+* at once, so each block is read into the lane-interleaved scratch buffer first and only summed afterwards.
+*/
+void read_stems_eq_planar_f32(float** ppChannels, ma_uint32 frameCount)
+{
+	int stride = stemEq.stride();
+	float* scratch = stemEqScratch.data();
+	float temp[STEM_EQ_BLOCK * CHANNEL_COUNT];
+
+	for (ma_uint32 offset = 0; offset < frameCount;) {
+		ma_uint32 blockFrames = frameCount - offset < STEM_EQ_BLOCK ? frameCount - offset : STEM_EQ_BLOCK;
+		memset(scratch, 0, sizeof(float) * stride * blockFrames);
+
+		for (ma_uint32 i = 0; i < g_decoderCount; ++i) {
+			if (!g_pDecodersActive[i]) continue;
+
+			if (!decoderMutexReady) {
+				decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+			}
+			ma_mutex_lock(&decoderMutex);
+			ma_uint64 framesRead = 0;
+			readStemFrames(i, temp, blockFrames, &framesRead);
+			ma_mutex_unlock(&decoderMutex);
+			if (framesRead == 0) {
+				endStem(i);
+				continue;
+			}
+
+			float gains[CHANNEL_COUNT];
+			for (ma_uint32 c = 0; c < CHANNEL_COUNT; ++c) {
+				gains[c] = stemChannelGain(i, c);
+			}
+			float* pStem = scratch + i * CHANNEL_COUNT;
+			for (ma_uint64 f = 0; f < framesRead; ++f) {
+				for (ma_uint32 c = 0; c < CHANNEL_COUNT; ++c) {
+					pStem[f * stride + c] = temp[f * CHANNEL_COUNT + c] * gains[c];
+				}
+			}
+		}
+
+		stemEq.process(scratch, blockFrames);
+		for (ma_uint32 i = 0; i < g_decoderCount; ++i) {
+			stemMeters.add(i, scratch + i * CHANNEL_COUNT, blockFrames, CHANNEL_COUNT, stride, 1);
+		}
+
+		for (ma_uint32 c = 0; c < CHANNEL_COUNT; ++c) {
+			float* pChannel = ppChannels[c] + offset;
+			for (ma_uint32 f = 0; f < blockFrames; ++f) {
+				const float* pFrame = scratch + f * stride + c;
+				float sum = 0;
+				for (ma_uint32 i = 0; i < g_decoderCount; ++i) {
+					sum += pFrame[i * CHANNEL_COUNT];
+				}
+				pChannel[f] = sum;
+			}
+		}
+
+		offset += blockFrames;
+	}
+}
+
+/*
+* Mixes every stem into one buffer per channel (overwriting it), through the EQ bank if it's in use.
+*/
+void mix_stems_planar_f32(float** ppChannels, ma_uint32 frameCount)
+{
+	if (g_stemEqActive) {
+		read_stems_eq_planar_f32(ppChannels, frameCount);
+		return;
+	}
+
+	for (ma_uint32 c = 0; c < CHANNEL_COUNT; ++c) {
+		memset(ppChannels[c], 0, sizeof(float) * frameCount);
+	}
+	for (ma_uint32 i = 0; i < g_decoderCount; ++i) {
+		if (!g_pDecodersActive[i]) {
+			stemMeters.add(i, NULL, frameCount, CHANNEL_COUNT, CHANNEL_COUNT, 1);
+			continue;
+		}
+
+		if (!decoderMutexReady) {
+			decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+		}
+		ma_mutex_lock(&decoderMutex);
+		ma_uint32 framesRead = read_pcm_frames_planar_f32(i, ppChannels, frameCount);
+		ma_mutex_unlock(&decoderMutex);
+		if (frameCount > 0 && framesRead == 0) { // A short chunk can need no input at all, that's not the end
+			endStem(i);
+		}
+	}
+}
+
+/*
+* Copies the next frames of the active pre-rendered variant, if there is one. Call with decoderMutex held.
+*/
+ma_bool32 read_prerendered_f32(float* pOutput, ma_uint32 frameCount) {
+	PrerenderedRate* variant = g_pActivePrerender;
+	if (variant == NULL) return MA_FALSE;
+
+	ma_uint64 available = prerenderCursor < variant->frameCount ? variant->frameCount - prerenderCursor : 0;
+	ma_uint32 framesToCopy = available < frameCount ? (ma_uint32)available : frameCount;
+	memcpy(pOutput, variant->pcm.data() + prerenderCursor * CHANNEL_COUNT, sizeof(float) * framesToCopy * CHANNEL_COUNT);
+	memset(pOutput + framesToCopy * CHANNEL_COUNT, 0, sizeof(float) * (frameCount - framesToCopy) * CHANNEL_COUNT);
+	prerenderCursor += framesToCopy;
+
+	if (prerenderCursor >= variant->frameCount) {
+		// Same as all the decoders running dry
+		for (ma_uint32 i = 0; i < g_decoderCount; ++i) {
+			endStem(i);
+		}
+	}
+	return MA_TRUE;
+}
+
+/*
+* Starts reading through the loop from the current frame, now that its window is ready. Call with decoderMutex held,
+* from the audio thread.
+*/
+void engageLoop() {
+	if (!g_pDecodersActive[g_pLongestDecoderIndex]) return; // Finished, a seek brings it back
+	ma_uint64 position = playbackFrame();
+	if (!g_stemsDeactivated && position < loop.endFrame()) {
+		for (ma_uint32 i = 0; i < g_decoderCount; ++i) {
+			g_pDecodersActive[i] = MA_TRUE; // Ran out early, padded with silence until the loop wraps
+		}
+	}
+	loop.engage(position, g_pLongestDecoderIndex);
+}
+
+/*
+* Mixes the next frameCount frames of the music into pOutputF32 (overwriting it) with whatever rate and stem settings
+* are current. From the audio thread, without decoderMutex held.
+*/
+void mix_music_f32(float* pOutputF32, ma_uint32 frameCount)
+{
+	if (!decoderMutexReady) {
+		decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+	}
+	ma_mutex_lock(&decoderMutex);
+	ma_bool32 prerendered = read_prerendered_f32(pOutputF32, frameCount);
+	ma_mutex_unlock(&decoderMutex);
+
+	if (prerendered) {
+		// Nothing else to mix, the decoders stay parked until we drop back to live stretching
+		// The stems aren't heard separately here, so only the mix meter moves
+		for (ma_uint32 i = 0; i < g_decoderCount; ++i) {
+			stemMeters.add(i, NULL, frameCount, CHANNEL_COUNT, CHANNEL_COUNT, 1);
+		}
+	} else if (playbackRate == 1.0f && g_stemEqActive) {
+		float mix[CHANNEL_COUNT][4096];
+		float* mixChannels[CHANNEL_COUNT];
+		for (ma_uint32 c = 0; c < CHANNEL_COUNT; ++c) {
+			mixChannels[c] = mix[c];
+		}
+
+		for (ma_uint32 offset = 0; offset < frameCount; offset += 4096) {
+			ma_uint32 chunkFrames = frameCount - offset < 4096 ? frameCount - offset : 4096;
+			read_stems_eq_planar_f32(mixChannels, chunkFrames);
+			signalsmith::perf::interleave(mixChannels, pOutputF32 + offset * CHANNEL_COUNT, CHANNEL_COUNT, chunkFrames);
+		}
+	} else if (playbackRate == 1.0f) {
+		memset(pOutputF32, 0, sizeof(float) * frameCount * CHANNEL_COUNT);
+
+		for (ma_uint32 i = 0; i < g_decoderCount; ++i) {
+			if (!g_pDecodersActive[i]) {
+				stemMeters.add(i, NULL, frameCount, CHANNEL_COUNT, CHANNEL_COUNT, 1);
+				continue;
+			}
+
+			if (!decoderMutexReady) {
+				decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+			}
+			ma_mutex_lock(&decoderMutex);
+			ma_uint32 framesRead = read_pcm_frames_f32(i, pOutputF32, frameCount);
+			ma_mutex_unlock(&decoderMutex);
+			if (framesRead == 0) {
+				endStem(i);
+			}
+		}
+	} else if (RATE_MODE == 1) {
+		float inputMix[CHANNEL_COUNT][4096];
+		float resampledOutput[CHANNEL_COUNT][4096];
+		float* inputChannels[CHANNEL_COUNT];
+		float* outputChannels[CHANNEL_COUNT];
+		for (ma_uint32 c = 0; c < CHANNEL_COUNT; ++c) {
+			inputChannels[c] = inputMix[c];
+			outputChannels[c] = resampledOutput[c];
+		}
+
+		for (ma_uint32 offset = 0; offset < frameCount;) {
+			ma_uint32 chunkFrames = frameCount - offset < 4096 ? frameCount - offset : 4096;
+
+			if (!decoderMutexReady) {
+				decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+			}
+			ma_mutex_lock(&decoderMutex);
+			while (chunkFrames > 1 && varispeed.inputFor(chunkFrames) > 4096) chunkFrames /= 2;
+			ma_uint32 inputFrames = (ma_uint32)varispeed.inputFor(chunkFrames);
+			ma_mutex_unlock(&decoderMutex);
+
+			mix_stems_planar_f32(inputChannels, inputFrames);
+
+			ma_mutex_lock(&decoderMutex);
+			std::chrono::steady_clock::time_point stretchStart = std::chrono::steady_clock::now();
+			varispeed.process(inputChannels, inputFrames, outputChannels, chunkFrames);
+			telemetry.add(2, stretchStart);
+			ma_mutex_unlock(&decoderMutex);
+
+			signalsmith::perf::interleave(outputChannels, pOutputF32 + offset * CHANNEL_COUNT, CHANNEL_COUNT, chunkFrames);
+			offset += chunkFrames;
+		}
+	} else {
+		// Temp buffers, one per channel so the stretcher doesn't have to split them up again
+		float inputMix[CHANNEL_COUNT][4096];
+		float stretchedOutput[CHANNEL_COUNT][4096];
+		float* inputChannels[CHANNEL_COUNT];
+		float* outputChannels[CHANNEL_COUNT];
+
+		// Pre-stretch input size. The timeline can split a callback down to a frame or two, so the fraction left over
+		// is carried to the next chunk rather than dropped (which would read nothing at all for those)
+		if (!decoderMutexReady) {
+			decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+		}
+		ma_mutex_lock(&decoderMutex);
+		double framesWanted = frameCount * (double)playbackRate + stretchInputCarry;
+		ma_uint32 maxFramesToRead = framesWanted < 4096 ? (ma_uint32)framesWanted : 4096;
+		stretchInputCarry = framesWanted < 4096 ? framesWanted - maxFramesToRead : 0;
+		ma_mutex_unlock(&decoderMutex);
+
+		for (ma_uint32 c = 0; c < CHANNEL_COUNT; ++c) {
+			inputChannels[c] = inputMix[c];
+			outputChannels[c] = stretchedOutput[c];
+		}
+
+		mix_stems_planar_f32(inputChannels, maxFramesToRead);
+
+		ma_bool32 stretched = MA_FALSE;
+		if (g_pDecodersActive[g_pLongestDecoderIndex]) {
+			// mixer_set_stretch_preset() can swap the stretcher out from under us
+			if (!decoderMutexReady) {
+				decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+			}
+			ma_mutex_lock(&decoderMutex);
+			// Never created here, ensureStretch() does it on the game thread before a rate needs it. If that's somehow
+			// missed the chunk is silent rather than allocating a stretcher mid-callback
+			if (stretch != nullptr) {
+				std::chrono::steady_clock::time_point stretchStart = std::chrono::steady_clock::now();
+				stretch->processPlanar(
+					inputChannels,
+					maxFramesToRead,
+					outputChannels,
+					frameCount
+				);
+				telemetry.add(2, stretchStart);
+				stretched = MA_TRUE;
+			}
+			ma_mutex_unlock(&decoderMutex);
+		}
+
+		if (stretched) {
+			signalsmith::perf::interleave(outputChannels, pOutputF32, CHANNEL_COUNT, frameCount);
+		} else {
+			memset(pOutputF32, 0, sizeof(float) * frameCount * CHANNEL_COUNT);
+		}
+	}
+}
+
+/*
+* A rate change off the timeline. Unlike mixer_set_playback_rate() the stretcher isn't reset, it just carries on at the
+* new ratio, so a ramp of small changes stays smooth. Call with decoderMutex held.
+*/
+void applyTimelineRate(float value) {
+	if (value == playbackRate) return;
+	ma_bool32 fromUnity = playbackRate == 1.0f;
+	playbackRate = value;
+	varispeed.setRatio(playbackRate);
+	if (stretch != nullptr) {
+		stretch->adapt(playbackRate);
+		if (fromUnity) primeStretch(); // It sat out while we were at 1x
+	}
+}
+
+void applyTimelineChange(const TimelineChange& change) {
+	ma_bool32 validStem = change.index >= 0 && change.index < (int)g_decoderCount;
+	switch (change.type) {
+		case 0:
+			if (validStem) g_pDecodersVolume[change.index] = change.value;
+			break;
+		case 1:
+			if (validStem) g_pDecodersMuted[change.index] = change.value != 0 ? MA_TRUE : MA_FALSE;
+			break;
+		case 2:
+			if (change.value > 0) applyTimelineRate(change.value);
+			break;
+		case 3:
+			if (validStem) g_pDecodersPan[change.index] = std::max(-1.0f, std::min(1.0f, change.value));
+			break;
+	}
+	routePrerender();
+}
+
+/*
+* Applies the scheduled changes that are due at the current frame and returns how many of the next maxFrames output
+* frames can be mixed before the next one. Call with decoderMutex held, from the audio thread.
+*/
+ma_uint32 applyTimeline(ma_uint32 maxFrames) {
+	timeline.drain();
+	if (!g_pDecodersActive[g_pLongestDecoderIndex]) return maxFrames; // Finished, the song frame doesn't move
+
+	ma_uint64 now = playbackFrame();
+	timeline.applyDue(now, applyTimelineChange);
+	ma_uint64 next = 0;
+	if (!timeline.next(next)) return maxFrames;
+
+	// Output frames until the song gets there. Rounding up lands on it or less than a frame of input after it
+	double framesUntil = std::ceil((double)(next - now) / playbackRate);
+	return framesUntil < maxFrames ? (ma_uint32)std::max(1.0, framesUntil) : maxFrames;
+}
+
+void data_callback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount)
+{
+	float* pOutputF32 = (float*)pOutput;
+	std::chrono::steady_clock::time_point callbackStart = std::chrono::steady_clock::now();
+	telemetry.begin();
+
+	MA_ASSERT(pDevice->playback.format == SAMPLE_FORMAT);
+
+	if (!decoderMutexReady) {
+		decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+	}
+	ma_mutex_lock(&decoderMutex);
+	ma_uint64 startFrame = playbackFrame();
+	ma_uint32 seekCount = g_seekCount;
+	if (loop.canEngage()) {
+		engageLoop();
+		startFrame = playbackFrame();
+	}
+	ma_uint32 loopWraps = loop.wraps();
+	ma_mutex_unlock(&decoderMutex);
+
+	// Split at every scheduled change, so each one takes effect on its own frame
+	std::chrono::steady_clock::time_point musicStart = std::chrono::steady_clock::now();
+	for (ma_uint32 offset = 0; offset < frameCount;) {
+		ma_mutex_lock(&decoderMutex);
+		ma_uint32 chunkFrames = applyTimeline(frameCount - offset);
+		ma_mutex_unlock(&decoderMutex);
+
+		mix_music_f32(pOutputF32 + offset * CHANNEL_COUNT, chunkFrames);
+		offset += chunkFrames;
+	}
+	std::chrono::steady_clock::time_point musicEnd = std::chrono::steady_clock::now();
+
+	ma_bool32 songFinished = MA_FALSE;
+	if (!g_pDecodersActive[g_pLongestDecoderIndex]) {
+		// If you're reached this point, that means the song has been finished.
+		songFinished = MIXER_STATE != 3;
+		MIXER_STATE = 3;
+	}
+
+	if (!decoderMutexReady) {
+		decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+	}
+	ma_mutex_lock(&decoderMutex);
+	if (reverb.active()) {
+		reverb.process(pOutputF32, frameCount);
+	}
+
+	stemMeters.add(g_decoderCount, pOutputF32, frameCount, CHANNEL_COUNT, CHANNEL_COUNT, 1);
+	stemMeters.publish();
+
+	ma_bool32 seeked = seekCount != g_seekCount;
+	ma_uint64 endFrame = g_pDecodersActive[g_pLongestDecoderIndex] && !seeked ? playbackFrame() : startFrame;
+	if (loopWraps != loop.wraps() && endFrame != startFrame) {
+		// Split where the loop wrapped, like pushCallbackEvents(): up to its end, then on from where it carried on, at
+		// the output frame the wrap landed on
+		ma_uint64 beforeWrap = loop.endFrame() - std::min(startFrame, loop.endFrame());
+		ma_uint64 afterWrap = endFrame - std::min(loop.resumeFrame(), endFrame);
+		ma_uint32 wrapOffset = beforeWrap + afterWrap > 0 ? (ma_uint32)((double)beforeWrap * frameCount / (double)(beforeWrap + afterWrap)) : 0;
+		sfx.mix(pOutputF32, wrapOffset, CHANNEL_COUNT, startFrame, loop.endFrame(), seeked);
+		sfx.mix(pOutputF32 + wrapOffset * CHANNEL_COUNT, frameCount - wrapOffset, CHANNEL_COUNT, loop.resumeFrame(), endFrame, false);
+	} else {
+		sfx.mix(pOutputF32, frameCount, CHANNEL_COUNT, startFrame, endFrame, seeked);
+	}
+
+	double periodSeconds = (double)frameCount / SAMPLE_RATE;
+	ma_bool32 gap = countCallbackTiming(callbackStart, periodSeconds, startFrame);
+	pushCallbackEvents(startFrame, seekCount, loopWraps, songFinished);
+	snapshots.updateLevels(stemMeters);
+	if (loopWraps != loop.wraps()) {
+		// Pretend it started before the loop's resume point, so the snapshot's time doesn't run backwards
+		ma_uint64 beforeEnd = loop.endFrame() - std::min(startFrame, loop.endFrame());
+		startFrame = loop.resumeFrame() > beforeEnd ? loop.resumeFrame() - beforeEnd : 0;
+	}
+	publishSnapshot(startFrame, periodSeconds);
+	ma_mutex_unlock(&decoderMutex);
+
+	telemetry.end(callbackStart, musicStart, musicEnd, periodSeconds, gap != MA_FALSE);
+
+	(void)pInput;
+}
+
+void mixer_deactivate_stem(int index) {
+	if (exists == 0 || index < 0 || index >= (int)g_decoderCount) return;
+
+	if (!decoderMutexReady) {
+		decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+	}
+	ma_mutex_lock(&decoderMutex);
+	g_stemsDeactivated = MA_TRUE;
+	routePrerender();
+	g_pDecodersActive[index] = MA_FALSE;
+	ma_mutex_unlock(&decoderMutex);
+}
+
+void mixer_set_stem_volume(int index, double volume) {
+	if (exists == 0 || index < 0 || index >= (int)g_decoderCount) return;
+
+	if (!decoderMutexReady) {
+		decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+	}
+	ma_mutex_lock(&decoderMutex);
+	g_pDecodersVolume[index] = volume;
+	routePrerender();
+	ma_mutex_unlock(&decoderMutex);
+}
+
+/*
+* -1 (left) to 1 (right). Works as a balance, so a stereo stem panned left loses its right channel rather than
+* having it folded over.
+*/
+void mixer_set_stem_pan(int index, double pan) {
+	if (exists == 0 || index < 0 || index >= (int)g_decoderCount) return;
+
+	if (!decoderMutexReady) {
+		decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+	}
+	ma_mutex_lock(&decoderMutex);
+	g_pDecodersPan[index] = (float)std::max(-1.0, std::min(1.0, pan));
+	routePrerender();
+	ma_mutex_unlock(&decoderMutex);
+}
+
+/*
+* Silences a stem without stopping it, so unmuting brings it back in time (deactivating is for good, until a seek).
+*/
+void mixer_set_stem_mute(int index, int muted) {
+	if (exists == 0 || index < 0 || index >= (int)g_decoderCount) return;
+
+	if (!decoderMutexReady) {
+		decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+	}
+	ma_mutex_lock(&decoderMutex);
+	g_pDecodersMuted[index] = muted != 0 ? MA_TRUE : MA_FALSE;
+	routePrerender();
+	ma_mutex_unlock(&decoderMutex);
+}
+
+/*
+* Schedules a change (see TimelineChange for the types) on `frame` of the song. The audio thread splits its callback
+* there, so it's exact to the frame rather than to the callback. Changes whose frame has already been played happen
+* straight away, which also means seeking forward catches up on the ones skipped. Each one happens once, so after
+* seeking back schedule again whatever should repeat. The same goes for a loop: changes inside it only happen on its
+* first pass, later passes play with whatever they left behind. Lock-free (but the first rate change creates the stretcher),
+* returns 0 if the queue was full.
+* Cleared by loading a song.
+*/
+int mixer_schedule_change(int type, int index, double value, int64_t frame) {
+	if (type < 0 || type > 3) return 0;
+	if (type == 2 && RATE_MODE == 0) ensureStretch(); // So the audio thread doesn't have to when the rate changes
+	return timeline.push((ma_uint64)(frame > 0 ? frame : 0), type, index, (float)value) ? 1 : 0;
+}
+
+/* Drops every scheduled change that hasn't happened yet. */
+void mixer_clear_schedule(void) {
+	timeline.clear();
+}
+
+/*
+* Stops looping. Stems that were playing from the loop's memory get their decoders back to where it had got to, so
+* playback carries on from there. Must not be called with decoderMutex held, it waits for the loop's worker.
+*/
+void releaseLoop() {
+	if (!decoderMutexReady) {
+		decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+	}
+	ma_mutex_lock(&decoderMutex);
+	if (loop.engaged()) {
+		for (ma_uint32 i = 0; i < g_decoderCount; ++i) {
+			ma_uint64 position = std::min(loop.position(i), g_pDecoderLengths[i]);
+			ma_decoder_seek_to_pcm_frame(&g_pDecoders[i], position);
+			if (position >= g_pDecoderLengths[i]) g_pDecodersActive[i] = MA_FALSE;
+		}
+	}
+	loop.stop();
+	routePrerender();
+	ma_mutex_unlock(&decoderMutex);
+
+	loop.cancel();
+}
+
+/*
+* Loops [startFrame, endFrame) of the song, with a linear crossfade of crossfadeFrames (0 for a hard cut) into the
+* start. It engages as soon as its start is decoded, which takes a moment on a worker. Replaces any loop there was,
+* and loading a song clears it. Returns 0 if the region is too short or outside the song.
+* Markers and conductor ticks fire again on every pass, changes scheduled inside the loop only on the first (see
+* mixer_schedule_change()).
+*/
+int mixer_set_loop(int64_t startFrame, int64_t endFrame, int crossfadeFrames) {
+	if (exists == 0) return 0;
+	ma_uint64 songLength = g_pDecoderLengths[g_pLongestDecoderIndex];
+	ma_uint64 start = (ma_uint64)std::max<int64_t>(startFrame, 0);
+	ma_uint64 end = std::min((ma_uint64)std::max<int64_t>(endFrame, 0), songLength);
+	if (end <= start || end - start < 1024) {
+		printf("Loop region is too short.\n");
+		return 0;
+	}
+	// The crossfade reads the start of the window and playback resumes after it, so it can't take up much of the loop
+	ma_uint64 maxCrossfade = std::min<ma_uint64>((end - start) / 4, (ma_uint64)(0.1 * SAMPLE_RATE));
+	ma_uint32 crossfade = (ma_uint32)std::min<ma_uint64>((ma_uint64)std::max(crossfadeFrames, 0), maxCrossfade);
+
+	releaseLoop();
+	if (!decoderMutexReady) {
+		decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+	}
+	ma_mutex_lock(&decoderMutex);
+	loop.configure(g_loadedSources.size(), CHANNEL_COUNT, SAMPLE_RATE, start, end, crossfade);
+	routePrerender();
+	ma_mutex_unlock(&decoderMutex);
+	loop.launch(g_loadedSources, SAMPLE_RATE);
+	return 1;
+}
+
+void mixer_clear_loop(void) {
+	if (exists == 0) return;
+	releaseLoop();
+}
+
+/*
+* Copies the latest meter readings as peak, hold, rms per meter (stems, then the whole mix) into `out`, as many whole
+* meters as fit in `capacity` doubles. Returns the meter count, so call with capacity 0 first to size the buffer.
+* Never blocks the audio thread, it just hands over whatever it published last.
+*/
+int mixer_get_stem_meters(double* out, int capacity) {
+	if (exists == 0) return 0;
+	return stemMeters.read(out, out != NULL ? capacity : 0);
+}
+
+/*
+* Copies the newest snapshot into `out` (as many doubles as fit in `capacity`): position, interpolated time, state, rate,
+* duration, late callbacks, callback gaps and the stem count, then active, volume, peak, hold, rms for every stem and
+* for the whole mix (see ma_snapshot.h). Returns the size of a whole snapshot, so call with capacity 0 first to size
+* the buffer. Replaces the separate per-frame getters and never takes the mutex.
+*/
+int mixer_get_snapshot(double* out, int capacity) {
+	return snapshots.read(out, out != NULL ? capacity : 0);
+}
+
+/*
+* Writes the callback telemetry into `out` as a NUL-terminated JSON object (as much of it as fits in `capacity` bytes):
+* how many callbacks ran and how many took over half, three quarters and all of their period, how many came after a gap,
+* and a histogram of how long the decode, mix, stretch and effects stages and the whole callback took. Returns the
+* length of the whole JSON, so it only all fit if that's less than `capacity`. Never takes the mutex.
+*/
+int mixer_get_telemetry_json(char* out, int capacity) {
+	std::string json = telemetry.json(SAMPLE_RATE, CHANNEL_COUNT);
+	if (out != NULL && capacity > 0) {
+		size_t length = std::min(json.size(), (size_t)capacity - 1);
+		memcpy(out, json.data(), length);
+		out[length] = '\0';
+	}
+	return (int)json.size();
+}
+
+/* Starts the telemetry over from the next callback. */
+void mixer_reset_telemetry(void) {
+	telemetry.reset();
+}
+
+/*
+* Moves the queued events into `out` as type, index, frame (see ma_events.h), as many as fit in `capacity` doubles.
+* Returns how many events it wrote, call it once per frame and everything that happened since the last call comes out
+* in order. Never blocks the audio thread.
+*/
+int mixer_poll_events(double* out, int capacity) {
+	if (out == NULL) return 0;
+	return events.drain(out, capacity);
+}
+
+/*
+* Queues a MARKER event with `id` when playback passes `frame` (seeking over it doesn't count).
+* Cleared by loading a song.
+*/
+void mixer_add_marker(int id, int64_t frame) {
+	if (!decoderMutexReady) {
+		decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+	}
+	ma_mutex_lock(&decoderMutex);
+	markers.add(id, (ma_uint64)(frame > 0 ? frame : 0));
+	ma_mutex_unlock(&decoderMutex);
+}
+
+void mixer_clear_markers(void) {
+	if (!decoderMutexReady) {
+		decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+	}
+	ma_mutex_lock(&decoderMutex);
+	markers.clear();
+	ma_mutex_unlock(&decoderMutex);
+}
+
+/*
+* Replaces the loaded song's BPM map: timeMs, bpm, numerator, denominator for each of `count` changes. The beat, step
+* and measure then show up in the snapshot, and as events if mixer_set_conductor_ticks() asks for them.
+* Cleared by loading a song.
+*/
+void mixer_set_conductor_map(const double* changes, int count) {
+	Conductor next; // Built here, the old map is freed with it after unlocking
+	next.setMap(changes, changes != NULL ? count : 0, SAMPLE_RATE);
+	if (!decoderMutexReady) {
+		decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+	}
+	ma_mutex_lock(&decoderMutex);
+	conductor.swap(next);
+	if (exists == 1) {
+		publishSnapshot(playbackFrame(), 0);
+	}
+	ma_mutex_unlock(&decoderMutex);
+}
+
+void mixer_set_conductor_ticks(int mode) {
+	if (mode < 0 || mode > 2) mode = 0;
+	if (!decoderMutexReady) {
+		decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+	}
+	ma_mutex_lock(&decoderMutex);
+	CONDUCTOR_TICKS = mode;
+	ma_mutex_unlock(&decoderMutex);
+}
+
+/*
+* Read-only views straight into the waveform data, nothing is copied. They're NULL/0 until that stem has been decoded,
+* and stay valid until the next load, mixer_destroy() or mixer_set_waveform_mode().
+* PCM is interleaved stereo, mixer_get_stem_frames() frames long (only in mode 2). Peak level L has
+* mixer_get_stem_peak_count() buckets
+* of (64 << L) frames, each a min and a max per channel.
+*/
+const float* mixer_get_stem_pcm(int index) {
+	const StemWaveform* stem = waveforms.find(index);
+	return stem != NULL && !stem->pcm.empty() ? stem->pcm.data() : NULL;
+}
+
+int mixer_get_stem_frames(int index) {
+	const StemWaveform* stem = waveforms.find(index);
+	return stem != NULL ? (int)stem->frameCount : 0;
+}
+
+int mixer_get_stem_peak_levels(int index) {
+	const StemWaveform* stem = waveforms.find(index);
+	return stem != NULL ? (int)stem->peaks.size() : 0;
+}
+
+const float* mixer_get_stem_peaks(int index, int level) {
+	const StemWaveform* stem = waveforms.find(index);
+	if (stem == NULL || level < 0 || level >= (int)stem->peaks.size()) return NULL;
+	return stem->peaks[level].data();
+}
+
+int mixer_get_stem_peak_count(int index, int level) {
+	const StemWaveform* stem = waveforms.find(index);
+	if (stem == NULL || level < 0 || level >= (int)stem->peaks.size()) return 0;
+	return (int)(stem->peaks[level].size() / (waveforms.channels() * 2));
+}
+
+/*
+* Sets (or with type 0 removes) the EQ on both channels of a stem. Frequency is in Hz, gain in dB (shelves and peak only),
+* q <= 0 picks the default Q. Doesn't lock out the audio thread, the bank picks the new coefficients up on its next block.
+*/
+void mixer_set_stem_filter(int index, int type, double frequency, double gainDb, double q) {
+	if (exists == 0) return;
+	if (index < 0 || index >= (int)g_decoderCount) return;
+
+	signalsmith::filters::BiquadStatic<double> design;
+	double scaledFreq = frequency / SAMPLE_RATE;
+	if (q <= 0) q = signalsmith::filters::BiquadStatic<double>::defaultQ;
+	switch (type) {
+		case 1: design.highpassQ(scaledFreq, q); break;
+		case 2: design.lowpassQ(scaledFreq, q); break;
+		case 3: design.lowShelfDbQ(scaledFreq, gainDb, q); break;
+		case 4: design.highShelfDbQ(scaledFreq, gainDb, q); break;
+		case 5: design.peakDbQ(scaledFreq, gainDb, q); break;
+		default: type = 0; break; // Default-constructed is a pass-through
+	}
+	for (ma_uint32 c = 0; c < CHANNEL_COUNT; ++c) {
+		stemEq.queueCoefficients(index * CHANNEL_COUNT + c, design.coefficients());
+	}
+
+	g_pStemFilterTypes[index] = type;
+	ma_bool32 eqActive = MA_FALSE;
+	for (ma_uint32 i = 0; i < g_decoderCount; ++i) {
+		if (g_pStemFilterTypes[i] != 0) eqActive = MA_TRUE;
+	}
+
+	if (!decoderMutexReady) {
+		decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+	}
+	ma_mutex_lock(&decoderMutex);
+	g_stemEqActive = eqActive;
+	routePrerender();
+	ma_mutex_unlock(&decoderMutex);
+}
+
+/*
+* Reverb send on the mix bus. Mode 0 = off, 1 = light (8 channel FDN), 2 = dense (16 channel FDN).
+* send is the wet level, roomMs sets the delay lengths (up to 200), decaySeconds is the RT60 and dampingHz
+* is where the tail starts to roll off. Nothing gets allocated, both sizes are set up front.
+*/
+void mixer_set_reverb(int mode, double send, double roomMs, double decaySeconds, double dampingHz) {
+	if (!decoderMutexReady) {
+		decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+	}
+	ma_mutex_lock(&decoderMutex);
+	reverb.configure(mode, send, roomMs, decaySeconds, dampingHz);
+	ma_mutex_unlock(&decoderMutex);
+}
+
+void mixer_set_playback_rate(float value) {
+	if (exists == 0) return;
+	if (value == playbackRate) return; // No change
+
+	if (RATE_MODE == 0) ensureStretch();
+
+	if (!decoderMutexReady) {
+		decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+	}
+	ma_mutex_lock(&decoderMutex);
+	playbackRate = value;
+	varispeed.setRatio(playbackRate);
+	routePrerender();
+	// Reset stretch state with new rate. In varispeed it catches up in mixer_set_rate_mode() if we switch back
+	if (RATE_MODE == 0 && stretch != nullptr) {
+		stretch->adapt(playbackRate); // Only does anything for the adaptive preset
+		primeStretch();
+	}
+	ma_mutex_unlock(&decoderMutex);
+}
+
+void mixer_set_stretch_preset(int preset) {
+	if (preset == STRETCH_PRESET) return; // No change
+	STRETCH_PRESET = preset;
+	if (stretch == nullptr) return; // Picked up when the stretcher is first created
+
+	// Allocate and configure off the audio thread, then swap it in
+	signalsmith::stretch::SignalsmithStretch* newStretch = createStretch();
+
+	if (!decoderMutexReady) {
+		decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+	}
+	ma_mutex_lock(&decoderMutex);
+	signalsmith::stretch::SignalsmithStretch* oldStretch = installStretch(newStretch);
+	ma_mutex_unlock(&decoderMutex);
+	delete oldStretch;
+}
+
+void mixer_set_rate_mode(int mode) {
+	if (mode == RATE_MODE) return; // No change
+	if (mode == 0) ensureStretch();
+
+	if (!decoderMutexReady) {
+		decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+	}
+	ma_mutex_lock(&decoderMutex);
+	RATE_MODE = mode;
+	varispeed.reset();
+	if (RATE_MODE == 0 && stretch != nullptr) {
+		stretch->adapt(playbackRate);
+		primeStretch();
+	}
+	routePrerender();
+	ma_mutex_unlock(&decoderMutex);
+}
+
+void mixer_set_stretch_seed(int seed) {
+	if (seed == STRETCH_SEED) return; // No change
+	STRETCH_SEED = seed;
+	if (stretch == nullptr) return; // Picked up when the stretcher is first created
+
+	if (!decoderMutexReady) {
+		decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+	}
+	ma_mutex_lock(&decoderMutex);
+	stretch->setSeed(seed >= 0 ? seed : (long)std::random_device{}());
+	ma_mutex_unlock(&decoderMutex);
+}
+
+void mixer_set_prerender_rates(const float* rates, int count) {
+	std::vector<float> newRates;
+	if (rates != NULL && count > 0) {
+		newRates.assign(rates, rates + count);
+	}
+	if (newRates == prerenderRates) return; // No change
+
+	stopPrerender();
+	prerenderRates = newRates;
+	if (exists == 1) {
+		startPrerender();
+	}
+}
+
+/*
+* Changing it drops the old waveform data, so let go of any pointers from the getters first.
+*/
+void mixer_set_waveform_mode(int mode) {
+	if (mode == WAVEFORM_MODE) return; // No change
+	WAVEFORM_MODE = mode;
+	waveforms.cancel();
+	if (exists == 1) {
+		startWaveforms();
+	}
+}
+
+void mixer_start(void) {
+	if (exists == 0) return;
+	ma_device_start(&device);
+	MIXER_STATE = 1;
+
+	if (!decoderMutexReady) {
+		decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+	}
+	ma_mutex_lock(&decoderMutex);
+	lastCallbackPeriod = 0; // Not a gap, we were stopped
+	publishSnapshot(playbackFrame(), 0);
+	ma_mutex_unlock(&decoderMutex);
+}
+
+void mixer_stop(void) {
+	if (exists == 0) return;
+	ma_device_stop(&device);
+	MIXER_STATE = 2;
+
+	if (!decoderMutexReady) {
+		decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+	}
+	ma_mutex_lock(&decoderMutex);
+	publishSnapshot(playbackFrame(), 0);
+	ma_mutex_unlock(&decoderMutex);
+}
+
+int mixer_stopped(void) {
+	return MIXER_STATE == 3 ? 1 : 0;
+}
+
+void mixer_destroy(void) {
+	if (exists == 0) return;
+	exists = 0;
+	ma_device_uninit(&device);
+	stopPrerender();
+	waveforms.cancel();
+	loop.stop();
+	loop.cancel();
+
+	for (iDecoder = 0; iDecoder < g_decoderCount; ++iDecoder) {
+		ma_decoder_uninit(&g_pDecoders[iDecoder]);
+	}
+	freeThingies();
+}
+
+/*
+* Shared by every way of loading a song.
+*/
+void loadStems(const std::vector<StemSource>& sources)
+{
+	stopPrerender();
+	waveforms.cancel();
+	loop.stop(); // Loops belong to the song
+	loop.cancel();
+	g_loadedSources = sources;
+	g_stemsDeactivated = MA_FALSE;
+	prerenderCursor = 0;
+
+	g_decoderCount   = sources.size();
+	g_pDecoders      = (ma_decoder*)malloc(sizeof(*g_pDecoders)      * g_decoderCount);
+	g_pDecodersActive = (ma_bool32*)malloc(sizeof(ma_bool32) * g_decoderCount);
+	g_pDecoderLengths = (ma_uint64*)malloc(sizeof(ma_uint64) * g_decoderCount);
+	//g_pDecoderConfigs      = (ma_decoder_config*)malloc(sizeof(*g_pDecoderConfigs)      * g_decoderCount);
+	g_pDecodersVolume      = (float*)malloc(sizeof(*g_pDecodersVolume)      * g_decoderCount);
+	g_pDecodersPan         = (float*)calloc(g_decoderCount, sizeof(float));
+	g_pDecodersMuted       = (ma_bool32*)calloc(g_decoderCount, sizeof(ma_bool32));
+	g_pStemFilterTypes     = (int*)calloc(g_decoderCount, sizeof(int));
+	stemEq.resize(g_decoderCount * CHANNEL_COUNT);
+	stemEqScratch.assign(stemEq.stride() * STEM_EQ_BLOCK, 0);
+	g_stemEqActive = MA_FALSE;
+	stemMeters.configure(g_decoderCount + 1, SAMPLE_RATE);
+	snapshots.configure(g_decoderCount);
+	g_lateCallbacks = 0;
+	g_callbackGaps = 0;
+	events.clear();
+	markers.clear();
+	conductor.setMap(NULL, 0, SAMPLE_RATE);
+	if (!decoderMutexReady) {
+		decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+	}
+	ma_mutex_lock(&decoderMutex);
+	sfx.reset(); // Anything still scheduled was for the previous song
+	timeline.reset();
+	ma_mutex_unlock(&decoderMutex);
+	endedStems.clear();
+	endedStems.reserve(g_decoderCount);
+
+	ma_uint64 absoluteLengthOfSong = 0;
+	decoderConfig = polyphase_decoder_config_init(SAMPLE_FORMAT, CHANNEL_COUNT, SAMPLE_RATE);
+
+	for (iDecoder = 0; iDecoder < g_decoderCount; ++iDecoder) {
+		g_pDecodersVolume[iDecoder] = 1.0;
+
+		result = sources[iDecoder].open(&decoderConfig, &g_pDecoders[iDecoder]);
+		if (result != MA_SUCCESS) {
+			ma_uint32 iDecoder2;
+			for (iDecoder2 = 0; iDecoder2 < iDecoder; ++iDecoder2) {
+				ma_decoder_uninit(&g_pDecoders[iDecoder2]);
+			}
+			freeThingies();
+
+			printf("Failed to load %s.\n", sources[iDecoder].path.c_str());
+			exists = 0;
+			return;
+		}
+
+		ma_data_source_set_looping(&g_pDecoders[iDecoder], MA_FALSE);
+
+		g_pDecodersActive[iDecoder] = MA_TRUE;
+
+		ma_decoder_get_length_in_pcm_frames(&g_pDecoders[iDecoder], &g_pDecoderLengths[iDecoder]);
+
+		if (g_pDecoderLengths[iDecoder] > absoluteLengthOfSong) {
+			absoluteLengthOfSong = g_pDecoderLengths[iDecoder];
+			g_pLongestDecoderIndex = iDecoder;
+		}
+
+		exists = 1;
+	}
+
+	/* Create only a single device. The decoders will be mixed together in the callback. In this example the data format needs to be the same as the decoders. */
+	deviceConfig = ma_device_config_init(ma_device_type_playback);
+	deviceConfig.playback.format   = SAMPLE_FORMAT;
+	deviceConfig.playback.channels = CHANNEL_COUNT;
+	deviceConfig.sampleRate        = SAMPLE_RATE;
+	deviceConfig.dataCallback      = data_callback;
+	deviceConfig.pUserData         = NULL;
+
+	if (ma_device_init(NULL, &deviceConfig, &device) != MA_SUCCESS) {
+		for (iDecoder = 0; iDecoder < g_decoderCount; ++iDecoder) {
+			ma_decoder_uninit(&g_pDecoders[iDecoder]);
+		}
+		freeThingies();
+
+		printf("Failed to open playback device.\n");
+		return;
+	}
+
+	if (!decoderMutexReady) {
+		decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+	}
+	ma_mutex_lock(&decoderMutex);
+	publishSnapshot(0, 0);
+	ma_mutex_unlock(&decoderMutex);
+
+	startPrerender();
+	startWaveforms();
+}
+
+void mixer_load_files(const char* const* paths, int count)
+{
+	if (count <= 0) {
+		printf("No input files.\n");
+		return;
+	}
+
+	std::vector<StemSource> sources(count);
+	for (int i = 0; i < count; ++i) {
+		sources[i].path = paths[i];
+		if (packVfs.contains(sources[i].path)) sources[i].pack = &packVfs;
+	}
+	loadStems(sources);
+}
+
+/*
+* `data` holds one pointer per stem, `sizes` how many bytes each one is. Nothing gets copied, so the bytes have to
+* stay alive (and unchanged) until the next load or destroy.
+*/
+void mixer_load_from_memory(const void* const* data, const int* sizes, int count)
+{
+	if (count <= 0) {
+		printf("No input data.\n");
+		return;
+	}
+
+	std::vector<StemSource> sources(count);
+	for (int i = 0; i < count; ++i) {
+		sources[i].path = "memory stem " + std::to_string(i);
+		sources[i].data = data[i];
+		sources[i].size = (size_t)sizes[i];
+	}
+	loadStems(sources);
+}
+
+/*
+* Maps a pack file, replacing the one before (and its entries). Not while a song is loaded, it may be reading from it.
+*/
+int mixer_mount_pack(const char* path) {
+	if (exists == 1 || g_previewOpen) {
+		printf("Can't mount a pack while a song or preview is loaded.\n");
+		return 0;
+	}
+	if (!packVfs.mount(path)) {
+		printf("Failed to mount %s.\n", path);
+		return 0;
+	}
+	return 1;
+}
+
+void mixer_unmount_pack(void) {
+	if (exists == 1 || g_previewOpen) {
+		printf("Can't unmount the pack while a song or preview is loaded.\n");
+		return;
+	}
+	packVfs.unmount();
+}
+
+/*
+* Tells the mounted pack that the file `name` is `size` bytes at `offset` in it.
+*/
+int mixer_add_pack_entry(const char* name, int64_t offset, int64_t size) {
+	if (offset < 0 || size < 0 || !packVfs.addEntry(name, (ma_uint64)offset, (ma_uint64)size)) {
+		printf("Pack entry %s doesn't fit in the pack.\n", name);
+		return 0;
+	}
+	return 1;
+}
+
+int installSfx(const StemSource& source) {
+	std::unique_ptr<SfxSample> sample(new SfxSample());
+	if (!sample->decode(source, CHANNEL_COUNT, SAMPLE_RATE)) return -1;
+
+	if (!decoderMutexReady) {
+		decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+	}
+	ma_mutex_lock(&decoderMutex);
+	int id = sfx.install(std::move(sample));
+	ma_mutex_unlock(&decoderMutex);
+	return id;
+}
+
+/*
+* Decodes a whole sound effect (a loose file or a file in the mounted pack) into memory and returns its id for
+* mixer_play_sfx(), or -1. Sound effects stay loaded across songs until unloaded.
+*/
+int mixer_load_sfx(const char* path) {
+	StemSource source;
+	source.path = path;
+	if (packVfs.contains(source.path)) source.pack = &packVfs;
+	return installSfx(source);
+}
+
+/*
+* Same as mixer_load_sfx(), from an encoded file in memory. It's decoded straight away, so the bytes can go afterwards.
+*/
+int mixer_load_sfx_from_memory(const void* data, int size) {
+	if (data == NULL || size <= 0) return -1;
+	StemSource source;
+	source.path = "memory sound effect";
+	source.data = data;
+	source.size = (size_t)size;
+	return installSfx(source);
+}
+
+void mixer_unload_sfx(int id) {
+	if (!decoderMutexReady) {
+		decoderMutexReady = ma_mutex_init(&decoderMutex) == MA_SUCCESS;
+	}
+	ma_mutex_lock(&decoderMutex);
+	sfx.unload(id);
+	ma_mutex_unlock(&decoderMutex);
+}
+
+/*
+* Plays a loaded sound effect at `gain` (linear) and `pan` (-1 left to 1 right), either as soon as possible
+* (frame < 0) or when the song reaches `frame`. Never locks or allocates, so it's safe to call for every hit.
+* Only heard while a song's device is running. Returns 0 if the trigger queue was full.
+*/
+int mixer_play_sfx(int id, double gain, double pan, int64_t frame) {
+	return sfx.play(id, (float)gain, (float)pan, (ma_int64)frame) ? 1 : 0;
+}
+
+/* Cuts every sound effect, playing or scheduled. */
+void mixer_stop_sfx(void) {
+	sfx.stopAll();
+}
+
+void preview_callback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount)
+{
+	MA_ASSERT(pDevice->playback.format == SAMPLE_FORMAT);
+	preview.mix((float*)pOutput, frameCount, CHANNEL_COUNT);
+
+	(void)pInput;
+}
+
+/*
+* Previews a song from the song select menu: opens its stems (loose files or in the mounted pack) at `startFrame`
+* and fades them in over `fadeFrames`, fading out the last preview over the same time. Returns straight away, the
+* stems are opened on a worker and a preview replaced before it got there is never heard. Runs alongside (and
+* regardless of) the loaded song. The first one opens the preview device, which stays open until
+* mixer_close_preview(). Returns 0 if the device couldn't be opened.
+*/
+int mixer_preview_files(const char* const* paths, int count, int64_t startFrame, int fadeFrames) {
+	if (count <= 0) {
+		printf("No input files.\n");
+		return 0;
+	}
+
+	if (!g_previewOpen) {
+		ma_device_config config = ma_device_config_init(ma_device_type_playback);
+		config.playback.format   = SAMPLE_FORMAT;
+		config.playback.channels = CHANNEL_COUNT;
+		config.sampleRate        = SAMPLE_RATE;
+		config.dataCallback      = preview_callback;
+		config.pUserData         = NULL;
+		if (ma_device_init(NULL, &config, &previewDevice) != MA_SUCCESS) {
+			printf("Failed to open the preview device.\n");
+			return 0;
+		}
+		ma_device_start(&previewDevice);
+		g_previewOpen = MA_TRUE;
+	}
+
+	std::vector<StemSource> sources(count);
+	for (int i = 0; i < count; ++i) {
+		sources[i].path = paths[i];
+		if (packVfs.contains(sources[i].path)) sources[i].pack = &packVfs;
+	}
+	preview.play(sources, CHANNEL_COUNT, SAMPLE_RATE, (ma_uint64)std::max<int64_t>(0, startFrame), (ma_uint32)std::max(0, fadeFrames));
+	return 1;
+}
+
+/* Fades the preview out over `fadeFrames`, the device stays open for the next one. */
+void mixer_stop_preview(int fadeFrames) {
+	if (!g_previewOpen) return;
+	preview.stop((ma_uint32)std::max(0, fadeFrames));
+}
+
+/* Cuts the preview and closes its device, e.g. when leaving the menu. */
+void mixer_close_preview(void) {
+	if (!g_previewOpen) return;
+	ma_device_uninit(&previewDevice);
+	preview.close();
+	g_previewOpen = MA_FALSE;
+}
\ No newline at end of file
@@ -16,376 +16,268 @@
 
 #include <hl.h>
 
-#include "include/ma_thing.h"
+#include "include/ma_mixer.h"
 
-#include "signalsmith-stretch/signalsmith-stretch.h"
+/*
+	* The HashLink binding: every primitive unpacks HL's types and forwards to the engine (see ma_mixer.h),
+	* which is compiled in next to this file.
+*/
 
-#define MINIAUDIO_IMPLEMENTATION
-#include "miniaudio.h"
+HL_PRIM int HL_NAME(get_mixer_state)(_NO_ARG) {
+	return mixer_get_state();
+}
 
-#include <stdio.h>
-#include <vector>
+HL_PRIM double HL_NAME(get_playback_position)(_NO_ARG) {
+	return mixer_get_playback_position();
+}
 
-/*
-For simplicity, this example requires the device to use floating point samples.
-*/
-#define SAMPLE_FORMAT   ma_format_f32
-#define CHANNEL_COUNT   2
-#define SAMPLE_RATE     44100
+HL_PRIM double HL_NAME(get_duration)(_NO_ARG) {
+	return mixer_get_duration();
+}
 
-signalsmith::stretch::SignalsmithStretch* stretch = nullptr;
+HL_PRIM void HL_NAME(seek_to_pcm_frame)(int64 pos) {
+	mixer_seek_to_pcm_frame(pos);
+}
 
-ma_uint32   g_decoderCount;
-ma_decoder* g_pDecoders;
-ma_bool32* g_pDecodersActive;
-ma_uint64* g_pDecoderLengths;
-int g_pLongestDecoderIndex;
-float*  g_pDecodersVolume;
-float playbackRate = 1;
+HL_PRIM bool HL_NAME(set_loop)(int64 startFrame, int64 endFrame, int crossfadeFrames) {
+	return mixer_set_loop(startFrame, endFrame, crossfadeFrames) != 0;
+}
 
-/*
-* 0 = UNDEFINED
-* 1 = PLAYING
-* 2 = STOPPED
-* 3 = FINISHED
-*/
-int MIXER_STATE = 3;
+HL_PRIM void HL_NAME(clear_loop)(_NO_ARG) {
+	mixer_clear_loop();
+}
 
-/*
-* 0 = false
-* 1 = true
-*/
-int exists = 0;
+HL_PRIM void HL_NAME(deactivate_decoder_hl)(int index) {
+	mixer_deactivate_stem(index);
+}
 
-ma_result result;
-ma_decoder_config decoderConfig;
-ma_device_config deviceConfig;
-ma_device device;
-ma_uint32 iDecoder;
+HL_PRIM void HL_NAME(amplify_decoder_hl)(int index, double volume) {
+	mixer_set_stem_volume(index, volume);
+}
 
-/*
-* IMPORTANT!
-* When I decoded an mp3 and a flac at the same time and seeked the app crashes so running with mutexes fixes this.
-*/
-ma_mutex decoderMutex;
-
-void freeThingies() {
-	free(g_pDecoders);
-	free(g_pDecodersActive);
-	free(g_pDecoderLengths);
-	free(g_pDecodersVolume);
-}
-
-ma_uint32 read_pcm_frames_f32(ma_uint32 index, float* pBuffer, ma_uint32 frameCount)
-{
-	ma_decoder* pDecoder = &g_pDecoders[index];
-	float temp[4096];
-	ma_uint32 tempCapInFrames = 4096 / CHANNEL_COUNT;
-	ma_uint32 totalFramesRead = 0;
-	memset(temp, 0, sizeof(temp));
-
-	while (totalFramesRead < frameCount) {
-		ma_uint64 framesReadThisIteration;
-		ma_uint32 totalFramesRemaining = frameCount - totalFramesRead;
-		ma_uint32 framesToReadThisIteration = (totalFramesRemaining < tempCapInFrames) ? totalFramesRemaining : tempCapInFrames;
-
-		ma_result result = ma_decoder_read_pcm_frames(pDecoder, temp, framesToReadThisIteration, &framesReadThisIteration);
-
-		if (result != MA_SUCCESS || framesReadThisIteration == 0) break;
-
-		for (ma_uint64 i = 0; i < framesReadThisIteration * CHANNEL_COUNT; ++i) {
-			pBuffer[totalFramesRead * CHANNEL_COUNT + i] += temp[i] * g_pDecodersVolume[index];
-		}
-
-		totalFramesRead += (ma_uint32)framesReadThisIteration;
-
-		if (framesReadThisIteration < framesToReadThisIteration) break; // EOF
-	}
-
-	return totalFramesRead;
-}
-
-void data_callback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount)
-{
-	float* pOutputF32 = (float*)pOutput;
-
-	MA_ASSERT(pDevice->playback.format == SAMPLE_FORMAT);
-
-	if (playbackRate == 1.0f) {
-		memset(pOutputF32, 0, sizeof(float) * frameCount * CHANNEL_COUNT);
-
-		for (ma_uint32 i = 0; i < g_decoderCount; ++i) {
-			if (!g_pDecodersActive[i]) continue;
-
-			if (decoderMutex == NULL) {
-				ma_mutex_init(&decoderMutex);
-			}
-			ma_mutex_lock(&decoderMutex);
-			ma_uint32 framesRead = read_pcm_frames_f32(i, pOutputF32, frameCount);
-			ma_mutex_unlock(&decoderMutex);
-			if (framesRead == 0) {
-				g_pDecodersActive[i] = MA_FALSE;
-			}
-		}
-	} else {
-		// Temp buffers
-		float inputMix[4096 * CHANNEL_COUNT] = {0};
-		float stretchedOutput[4096 * CHANNEL_COUNT] = {0};
-
-		ma_uint32 maxFramesToRead = (ma_uint32)(frameCount * playbackRate); // pre-stretch input size
-		if (maxFramesToRead > 4096) maxFramesToRead = 4096;
-
-		for (ma_uint32 i = 0; i < g_decoderCount; ++i) {
-			if (!g_pDecodersActive[i]) continue;
-
-			if (decoderMutex == NULL) {
-				ma_mutex_init(&decoderMutex);
-			}
-			ma_mutex_lock(&decoderMutex);
-			ma_uint32 framesRead = read_pcm_frames_f32(i, inputMix, maxFramesToRead);
-			ma_mutex_unlock(&decoderMutex);
-			if (framesRead == 0) {
-				g_pDecodersActive[i] = MA_FALSE;
-			}
-		}
-
-		if (g_pDecodersActive[g_pLongestDecoderIndex]) {
-			if (stretch == nullptr) {
-				stretch = new signalsmith::stretch::SignalsmithStretch();
-				stretch->presetCheaper(CHANNEL_COUNT, SAMPLE_RATE);
-			}
-			stretch->process(
-				inputMix,
-				maxFramesToRead,
-				stretchedOutput,
-				frameCount
-			);
-
-			memcpy(pOutputF32, stretchedOutput, sizeof(float) * frameCount * CHANNEL_COUNT);
-		} else {
-			memset(pOutputF32, 0, sizeof(float) * frameCount * CHANNEL_COUNT);
-		}
-	}
-
-	if (!g_pDecodersActive[g_pLongestDecoderIndex]) {
-		// If you're reached this point, that means the song has been finished.
-		MIXER_STATE = 3;
-	}
-
-	(void)pInput;
+HL_PRIM void HL_NAME(set_stem_pan)(int index, double pan) {
+	mixer_set_stem_pan(index, pan);
 }
 
-HL_PRIM int HL_NAME(get_mixer_state)(_NO_ARG) {
-	return MIXER_STATE;
+HL_PRIM void HL_NAME(set_stem_mute)(int index, bool muted) {
+	mixer_set_stem_mute(index, muted ? 1 : 0);
 }
 
-HL_PRIM double HL_NAME(get_playback_position)(_NO_ARG) {
-	ma_uint64 pos = 0;
-	if (g_pDecodersActive[g_pLongestDecoderIndex] == MA_TRUE) {
-		if (decoderMutex == NULL) {
-			ma_mutex_init(&decoderMutex);
-		}
-		ma_mutex_lock(&decoderMutex);
-		ma_decoder_get_cursor_in_pcm_frames(&g_pDecoders[g_pLongestDecoderIndex], &pos);
-		ma_mutex_unlock(&decoderMutex);
-	}
-	return (double)pos / (SAMPLE_RATE * 0.001);
+HL_PRIM bool HL_NAME(schedule_change)(int type, int index, double value, int64 frame) {
+	return mixer_schedule_change(type, index, value, frame) != 0;
 }
 
-HL_PRIM double HL_NAME(get_duration)(_NO_ARG) {
-	ma_uint64 pos = 0;
-	if (g_pDecodersActive[g_pLongestDecoderIndex] == MA_TRUE) {
-		if (decoderMutex == NULL) {
-			ma_mutex_init(&decoderMutex);
-		}
-		ma_mutex_lock(&decoderMutex);
-		ma_decoder_get_cursor_in_pcm_frames(&g_pDecoders[g_pLongestDecoderIndex], &pos);
-		ma_mutex_unlock(&decoderMutex);
-	}
-	return (double)pos / (SAMPLE_RATE * 0.001);
-}
-
-HL_PRIM void HL_NAME(seek_to_pcm_frame)(ma_uint64 pos) {
-	if (exists == 0) return;
-
-	if (decoderMutex == NULL) {
-		ma_mutex_init(&decoderMutex);
-	}
-	ma_mutex_lock(&decoderMutex);
-	for (iDecoder = 0; iDecoder < g_decoderCount; ++iDecoder) {
-		ma_decoder_seek_to_pcm_frame(&g_pDecoders[iDecoder], pos > 0 ? pos : 0);
-
-		// If we seek to before EOF, reactivate
-		if (pos < g_pDecoderLengths[iDecoder]) {
-			g_pDecodersActive[iDecoder] = MA_TRUE;
-		}
-	}
-	ma_mutex_unlock(&decoderMutex);
-}
-
-/*HL_PRIM void HL_NAME(free_thingies)(_NO_ARG) {
-	free(g_pDecoders);
-	free(g_pDecodersActive);
-	free(g_pDecoderLengths);
-	free(g_pDecodersVolume);
-}*/
+HL_PRIM void HL_NAME(clear_schedule)(_NO_ARG) {
+	mixer_clear_schedule();
+}
 
-HL_PRIM void HL_NAME(deactivate_decoder_hl)(int index) {
-	if (index < g_decoderCount) {
-		g_pDecodersActive[index] = MA_FALSE;
-	}
+HL_PRIM int HL_NAME(get_stem_meters)(vbyte* out, int capacity) {
+	return mixer_get_stem_meters((double*)out, capacity);
 }
 
-HL_PRIM void HL_NAME(amplify_decoder_hl)(int index, double volume) {
-	if (index < g_decoderCount || index > 0) {
-		g_pDecodersVolume[index] = volume;
-	}
+HL_PRIM int HL_NAME(get_snapshot)(vbyte* out, int capacity) {
+	return mixer_get_snapshot((double*)out, capacity);
 }
 
-HL_PRIM void HL_NAME(setPlaybackRate)(float value) {
-	if (exists == 0) return;
-	if (value == playbackRate) return; // No change
+HL_PRIM int HL_NAME(get_telemetry_json)(vbyte* out, int capacity) {
+	return mixer_get_telemetry_json((char*)out, capacity);
+}
 
-	playbackRate = value;
+HL_PRIM void HL_NAME(reset_telemetry)(_NO_ARG) {
+	mixer_reset_telemetry();
+}
 
-	ma_decoder decoder = g_pDecoders[g_pLongestDecoderIndex];
+HL_PRIM int HL_NAME(poll_events)(vbyte* out, int capacity) {
+	return mixer_poll_events((double*)out, capacity);
+}
 
-	ma_uint64 cursor2 = 0;
-	if (g_pDecodersActive[g_pLongestDecoderIndex] == MA_TRUE) {
-		if (decoderMutex == NULL) {
-			ma_mutex_init(&decoderMutex);
-		}
-		ma_mutex_lock(&decoderMutex);
-		ma_decoder_get_cursor_in_pcm_frames(&decoder, &cursor2);
-		ma_mutex_unlock(&decoderMutex);
-	}
+HL_PRIM void HL_NAME(add_marker)(int id, int64 frame) {
+	mixer_add_marker(id, frame);
+}
 
-	// Reset stretch state with new rate
-	if (stretch == nullptr) {
-		stretch = new signalsmith::stretch::SignalsmithStretch();
-		stretch->presetCheaper(CHANNEL_COUNT, SAMPLE_RATE);
-	}
-	int latencyFrames = stretch->inputLatency();
-	std::vector<float> latencyData(latencyFrames * CHANNEL_COUNT);
+HL_PRIM void HL_NAME(clear_markers)(_NO_ARG) {
+	mixer_clear_markers();
+}
 
-	if (decoderMutex == NULL) {
-		ma_mutex_init(&decoderMutex);
-	}
-	ma_mutex_lock(&decoderMutex);
-	ma_decoder_read_pcm_frames(&decoder, latencyData.data(), latencyFrames, NULL);
-	ma_decoder_seek_to_pcm_frame(&decoder, cursor2);
-	ma_mutex_unlock(&decoderMutex);
+HL_PRIM void HL_NAME(set_conductor_map)(vbyte* changes, int count) {
+	mixer_set_conductor_map((const double*)changes, count);
+}
 
-	// only need to seek from one decoder
+HL_PRIM void HL_NAME(set_conductor_ticks)(int mode) {
+	mixer_set_conductor_ticks(mode);
+}
 
-	stretch->seek(latencyData.data(), latencyFrames, playbackRate);
+HL_PRIM vbyte* HL_NAME(get_stem_pcm)(int index) {
+	return (vbyte*)mixer_get_stem_pcm(index);
 }
 
-HL_PRIM void HL_NAME(start)(_NO_ARG) {
-	if (exists == 0) return;
-	ma_device_start(&device);
-	MIXER_STATE = 1;
+HL_PRIM int HL_NAME(get_stem_frames)(int index) {
+	return mixer_get_stem_frames(index);
 }
 
-HL_PRIM void HL_NAME(stop)(_NO_ARG) {
-	if (exists == 0) return;
-	ma_device_stop(&device);
-	MIXER_STATE = 2;
+HL_PRIM int HL_NAME(get_stem_peak_levels)(int index) {
+	return mixer_get_stem_peak_levels(index);
 }
 
-HL_PRIM bool HL_NAME(stopped)(_NO_ARG) {
-	return MIXER_STATE == 3;
+HL_PRIM vbyte* HL_NAME(get_stem_peaks)(int index, int level) {
+	return (vbyte*)mixer_get_stem_peaks(index, level);
 }
 
-HL_PRIM void HL_NAME(destroy)(_NO_ARG) {
-	if (exists == 0) return;
-	exists = 0;
-	ma_device_uninit(&device);
+HL_PRIM int HL_NAME(get_stem_peak_count)(int index, int level) {
+	return mixer_get_stem_peak_count(index, level);
+}
 
-	for (iDecoder = 0; iDecoder < g_decoderCount; ++iDecoder) {
-		ma_decoder_uninit(&g_pDecoders[iDecoder]);
-	}
-	freeThingies();
+HL_PRIM void HL_NAME(set_stem_filter)(int index, int type, double frequency, double gainDb, double q) {
+	mixer_set_stem_filter(index, type, frequency, gainDb, q);
 }
 
-HL_PRIM void HL_NAME(loadFiles)(varray* argv)
-{
-	if (argv->size == 0) {
-		printf("No input files.\n");
-		return;
-	}
+HL_PRIM void HL_NAME(set_reverb)(int mode, double send, double roomMs, double decaySeconds, double dampingHz) {
+	mixer_set_reverb(mode, send, roomMs, decaySeconds, dampingHz);
+}
 
-	g_decoderCount   = argv->size;
-	g_pDecoders      = (ma_decoder*)malloc(sizeof(*g_pDecoders)      * g_decoderCount);
-	g_pDecodersActive = (ma_bool32*)malloc(sizeof(ma_bool32) * g_decoderCount);
-	g_pDecoderLengths = (ma_uint64*)malloc(sizeof(ma_uint64) * g_decoderCount);
-	//g_pDecoderConfigs      = (ma_decoder_config*)malloc(sizeof(*g_pDecoderConfigs)      * g_decoderCount);
-	g_pDecodersVolume      = (float*)malloc(sizeof(*g_pDecodersVolume)      * g_decoderCount);
-	//g_pDecodersPan      = (float*)malloc(sizeof(*g_pDecodersPan)      * g_decoderCount);
+HL_PRIM void HL_NAME(setPlaybackRate)(float value) {
+	mixer_set_playback_rate(value);
+}
 
-	ma_uint64 absoluteLengthOfSong = 0;
-	decoderConfig = ma_decoder_config_init(SAMPLE_FORMAT, CHANNEL_COUNT, SAMPLE_RATE);
+HL_PRIM void HL_NAME(set_stretch_preset)(int preset) {
+	mixer_set_stretch_preset(preset);
+}
 
-	for (iDecoder = 0; iDecoder < g_decoderCount; ++iDecoder) {
-		const char* path = hl_aptr(argv, const char*)[iDecoder];
+HL_PRIM void HL_NAME(set_rate_mode)(int mode) {
+	mixer_set_rate_mode(mode);
+}
 
-		g_pDecodersVolume[iDecoder] = 1.0;
+HL_PRIM void HL_NAME(set_stretch_seed)(int seed) {
+	mixer_set_stretch_seed(seed);
+}
 
-		result = ma_decoder_init_file(path, &decoderConfig, &g_pDecoders[iDecoder]);
-		if (result != MA_SUCCESS) {
-			ma_uint32 iDecoder2;
-			for (iDecoder2 = 0; iDecoder2 < iDecoder; ++iDecoder2) {
-				ma_decoder_uninit(&g_pDecoders[iDecoder2]);
-			}
-			freeThingies();
+HL_PRIM void HL_NAME(set_prerender_rates)(vbyte* rates, int count) {
+	mixer_set_prerender_rates((const float*)rates, count);
+}
 
-			printf("Failed to load %s.\n", path);
-			exists = 0;
-			return;
-		}
+HL_PRIM void HL_NAME(set_waveform_mode)(int mode) {
+	mixer_set_waveform_mode(mode);
+}
 
-		ma_data_source_set_looping(&g_pDecoders[iDecoder], MA_FALSE);
+HL_PRIM void HL_NAME(start)(_NO_ARG) {
+	mixer_start();
+}
 
-		g_pDecodersActive[iDecoder] = MA_TRUE;
+HL_PRIM void HL_NAME(stop)(_NO_ARG) {
+	mixer_stop();
+}
 
-		ma_decoder_get_length_in_pcm_frames(&g_pDecoders[iDecoder], &g_pDecoderLengths[iDecoder]);
+HL_PRIM int HL_NAME(stopped)(_NO_ARG) {
+	return mixer_stopped();
+}
 
-		if (g_pDecoderLengths[iDecoder] > absoluteLengthOfSong) {
-			absoluteLengthOfSong = g_pDecoderLengths[iDecoder];
-			g_pLongestDecoderIndex = iDecoder;
-		}
+HL_PRIM void HL_NAME(destroy)(_NO_ARG) {
+	mixer_destroy();
+}
 
-		exists = 1;
-	}
+HL_PRIM void HL_NAME(loadFiles)(varray* argv) {
+	mixer_load_files(hl_aptr(argv, const char*), argv->size);
+}
 
-	/* Create only a single device. The decoders will be mixed together in the callback. In this example the data format needs to be the same as the decoders. */
-	deviceConfig = ma_device_config_init(ma_device_type_playback);
-	deviceConfig.playback.format   = SAMPLE_FORMAT;
-	deviceConfig.playback.channels = CHANNEL_COUNT;
-	deviceConfig.sampleRate        = SAMPLE_RATE;
-	deviceConfig.dataCallback      = data_callback;
-	deviceConfig.pUserData         = NULL;
+/*
+* `sizes` is an int32 per stem.
+*/
+HL_PRIM void HL_NAME(load_from_memory)(varray* data, vbyte* sizes) {
+	mixer_load_from_memory(hl_aptr(data, const void*), (const int*)sizes, data->size);
+}
 
-	if (ma_device_init(NULL, &deviceConfig, &device) != MA_SUCCESS) {
-		for (iDecoder = 0; iDecoder < g_decoderCount; ++iDecoder) {
-			ma_decoder_uninit(&g_pDecoders[iDecoder]);
-		}
-		freeThingies();
+HL_PRIM bool HL_NAME(mount_pack)(vbyte* path) {
+	return mixer_mount_pack((const char*)path) != 0;
+}
+
+HL_PRIM void HL_NAME(unmount_pack)(_NO_ARG) {
+	mixer_unmount_pack();
+}
+
+HL_PRIM bool HL_NAME(add_pack_entry)(vbyte* name, int64 offset, int64 size) {
+	return mixer_add_pack_entry((const char*)name, offset, size) != 0;
+}
+
+HL_PRIM int HL_NAME(load_sfx)(vbyte* path) {
+	return mixer_load_sfx((const char*)path);
+}
+
+HL_PRIM int HL_NAME(load_sfx_from_memory)(vbyte* data, int size) {
+	return mixer_load_sfx_from_memory(data, size);
+}
+
+HL_PRIM void HL_NAME(unload_sfx)(int id) {
+	mixer_unload_sfx(id);
+}
+
+HL_PRIM bool HL_NAME(play_sfx)(int id, double gain, double pan, int64 frame) {
+	return mixer_play_sfx(id, gain, pan, frame) != 0;
+}
+
+HL_PRIM void HL_NAME(stop_sfx)(_NO_ARG) {
+	mixer_stop_sfx();
+}
+
+HL_PRIM bool HL_NAME(preview_files)(varray* argv, int64_t startFrame, int fadeFrames) {
+	return mixer_preview_files(hl_aptr(argv, const char*), argv->size, startFrame, fadeFrames) != 0;
+}
+
+HL_PRIM void HL_NAME(stop_preview)(int fadeFrames) {
+	mixer_stop_preview(fadeFrames);
+}
 
-		printf("Failed to open playback device.\n");
-		return;
-	}
+HL_PRIM void HL_NAME(close_preview)(_NO_ARG) {
+	mixer_close_preview();
 }
 
 DEFINE_PRIM(_I32, get_mixer_state, _NO_ARG)
 DEFINE_PRIM(_F64, get_playback_position, _NO_ARG)
 DEFINE_PRIM(_F64, get_duration, _NO_ARG)
 DEFINE_PRIM(_VOID, seek_to_pcm_frame, _I64)
+DEFINE_PRIM(_BOOL, set_loop, _I64 _I64 _I32)
+DEFINE_PRIM(_VOID, clear_loop, _NO_ARG)
 DEFINE_PRIM(_VOID, deactivate_decoder_hl, _I32)
 DEFINE_PRIM(_VOID, amplify_decoder_hl, _I32 _F64)
+DEFINE_PRIM(_VOID, set_stem_pan, _I32 _F64)
+DEFINE_PRIM(_VOID, set_stem_mute, _I32 _BOOL)
+DEFINE_PRIM(_BOOL, schedule_change, _I32 _I32 _F64 _I64)
+DEFINE_PRIM(_VOID, clear_schedule, _NO_ARG)
+DEFINE_PRIM(_I32, get_stem_meters, _BYTES _I32)
+DEFINE_PRIM(_I32, get_snapshot, _BYTES _I32)
+DEFINE_PRIM(_I32, get_telemetry_json, _BYTES _I32)
+DEFINE_PRIM(_VOID, reset_telemetry, _NO_ARG)
+DEFINE_PRIM(_I32, poll_events, _BYTES _I32)
+DEFINE_PRIM(_VOID, add_marker, _I32 _I64)
+DEFINE_PRIM(_VOID, clear_markers, _NO_ARG)
+DEFINE_PRIM(_VOID, set_conductor_map, _BYTES _I32)
+DEFINE_PRIM(_VOID, set_conductor_ticks, _I32)
+DEFINE_PRIM(_BYTES, get_stem_pcm, _I32)
+DEFINE_PRIM(_I32, get_stem_frames, _I32)
+DEFINE_PRIM(_I32, get_stem_peak_levels, _I32)
+DEFINE_PRIM(_BYTES, get_stem_peaks, _I32 _I32)
+DEFINE_PRIM(_I32, get_stem_peak_count, _I32 _I32)
+DEFINE_PRIM(_VOID, set_stem_filter, _I32 _I32 _F64 _F64 _F64)
+DEFINE_PRIM(_VOID, set_reverb, _I32 _F64 _F64 _F64 _F64)
 DEFINE_PRIM(_VOID, setPlaybackRate, _F32)
+DEFINE_PRIM(_VOID, set_stretch_preset, _I32)
+DEFINE_PRIM(_VOID, set_rate_mode, _I32)
+DEFINE_PRIM(_VOID, set_stretch_seed, _I32)
+DEFINE_PRIM(_VOID, set_prerender_rates, _BYTES _I32)
+DEFINE_PRIM(_VOID, set_waveform_mode, _I32)
 DEFINE_PRIM(_VOID, start, _NO_ARG)
 DEFINE_PRIM(_VOID, stop, _NO_ARG)
 DEFINE_PRIM(_I32, stopped, _NO_ARG)
 DEFINE_PRIM(_VOID, destroy, _NO_ARG)
-DEFINE_PRIM(_VOID, loadFiles, _ARR)
\ No newline at end of file
+DEFINE_PRIM(_VOID, loadFiles, _ARR)
+DEFINE_PRIM(_VOID, load_from_memory, _ARR _BYTES)
+DEFINE_PRIM(_BOOL, mount_pack, _BYTES)
+DEFINE_PRIM(_VOID, unmount_pack, _NO_ARG)
+DEFINE_PRIM(_BOOL, add_pack_entry, _BYTES _I64 _I64)
+DEFINE_PRIM(_I32, load_sfx, _BYTES)
+DEFINE_PRIM(_I32, load_sfx_from_memory, _BYTES _I32)
+DEFINE_PRIM(_VOID, unload_sfx, _I32)
+DEFINE_PRIM(_BOOL, play_sfx, _I32 _F64 _F64 _I64)
+DEFINE_PRIM(_VOID, stop_sfx, _NO_ARG)
+DEFINE_PRIM(_BOOL, preview_files, _ARR _I64 _I32)
+DEFINE_PRIM(_VOID, stop_preview, _I32)
+DEFINE_PRIM(_VOID, close_preview, _NO_ARG)
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include <type_traits>
 
 #include <complex>
+#include "./perf.h"
 #include "./fft.h"
 #include "./windows.h"
 
@@ -38,12 +39,20 @@ namespace delay {
 		* `buffer[0]` to buffer[99]`
 
 		Although buffers are usually used with historical samples accessed using negative indices e.g. `buffer[-10]`, you could equally use it flipped around (moving the head backwards through the buffer using `--buffer`).
+
+		Storage is cache-aligned by default.  After `.reserve()`, resizing to anything up to that capacity doesn't allocate.
 	*/
-	template<typename Sample>
+	template<typename Sample, class Allocator=signalsmith::perf::AlignedAllocator<Sample>>
 	class Buffer {
 		unsigned bufferIndex;
 		unsigned bufferMask;
-		std::vector<Sample> buffer;
+		std::vector<Sample, Allocator> buffer;
+
+		static int roundedCapacity(int minCapacity) {
+			int bufferLength = 1;
+			while (bufferLength < minCapacity) bufferLength *= 2;
+			return bufferLength;
+		}
 	public:
 		Buffer(int minCapacity=0) {
 			resize(minCapacity);
@@ -56,8 +65,7 @@ namespace delay {
 		Buffer & operator =(Buffer &&other) = default;
 
 		void resize(int minCapacity, Sample value=Sample()) {
-			int bufferLength = 1;
-			while (bufferLength < minCapacity) bufferLength *= 2;
+			int bufferLength = roundedCapacity(minCapacity);
 			buffer.assign(bufferLength, value);
 			bufferMask = unsigned(bufferLength - 1);
 			bufferIndex = 0;
@@ -65,6 +73,10 @@ namespace delay {
 		void reset(Sample value=Sample()) {
 			buffer.assign(buffer.size(), value);
 		}
+		/// Allocates enough for any later `.resize()` up to this capacity
+		void reserve(int maxCapacity) {
+			buffer.reserve(roundedCapacity(maxCapacity));
+		}
 
 		/// Holds a view for a particular position in the buffer
 		template<bool isConst>
@@ -89,6 +101,14 @@ namespace delay {
 				return buffer->buffer[(bufferIndex + (unsigned)offset)&buffer->bufferMask];
 			}
 
+			/// Raw pointer to the sample at `offset`, which is valid for `.contiguous(offset)` samples before the storage wraps around
+			CSample * data(int offset=0) {
+				return buffer->buffer.data() + ((bufferIndex + (unsigned)offset)&buffer->bufferMask);
+			}
+			int contiguous(int offset=0) const {
+				return int(buffer->bufferMask + 1 - ((bufferIndex + (unsigned)offset)&buffer->bufferMask));
+			}
+
 			/// Write data into the buffer
 			template<typename Data>
 			void write(Data &&data, int length) {
@@ -194,13 +214,13 @@ namespace delay {
 		* `buffer[c]` returns a view for a single channel, which behaves like the single-channel `Buffer::View`.
 		* The constructor and `.resize()` take an additional first `channel` argument.
 	*/
-	template<typename Sample>
+	template<typename Sample, class Allocator=signalsmith::perf::AlignedAllocator<Sample>>
 	class MultiBuffer {
 		int channels, stride;
-		Buffer<Sample> buffer;
+		Buffer<Sample, Allocator> buffer;
 	public:
-		using ConstChannel = typename Buffer<Sample>::ConstView;
-		using MutableChannel = typename Buffer<Sample>::MutableView;
+		using ConstChannel = typename Buffer<Sample, Allocator>::ConstView;
+		using MutableChannel = typename Buffer<Sample, Allocator>::MutableView;
 
 		MultiBuffer(int channels=0, int capacity=0) : channels(channels), stride(capacity), buffer(channels*capacity) {}
 
@@ -212,6 +232,10 @@ namespace delay {
 		void reset(Sample value=Sample()) {
 			buffer.reset(value);
 		}
+		/// Allocates enough for any later `.resize()` up to these sizes
+		void reserve(int maxChannels, int maxCapacity) {
+			buffer.reserve(maxChannels*maxCapacity);
+		}
 
 		/// A reference-like multi-channel result for a particular sample index
 		template<bool isConst>
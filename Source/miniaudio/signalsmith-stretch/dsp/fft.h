@@ -6,8 +6,13 @@
 #include "./perf.h"
 
 #include <vector>
+#include <algorithm>
 #include <complex>
 #include <cmath>
+#include <type_traits>
+#include <map>
+#include <memory>
+#include <mutex>
 
 namespace signalsmith { namespace fft {
 	/**	@defgroup FFT FFT (complex and real)
@@ -55,6 +60,95 @@ namespace signalsmith { namespace fft {
 			};
 		}
 
+		// Several complex numbers at once, as separate real/imaginary vectors (`S` is `perf::Float4` or `perf::Float8`)
+		template<class S>
+		struct SplitComplex {
+			S real, imag;
+
+			SIGNALSMITH_INLINE static SplitComplex load(const std::complex<float> *pointer) {
+				SplitComplex result;
+				S::loadComplex(reinterpret_cast<const float *>(pointer), result.real, result.imag);
+				return result;
+			}
+			// Loads the `S::size` values ending at `pointer`, in reverse order
+			SIGNALSMITH_INLINE static SplitComplex loadReversed(const std::complex<float> *pointer) {
+				SplitComplex result = load(pointer + 1 - S::size);
+				return {result.real.reversed(), result.imag.reversed()};
+			}
+			SIGNALSMITH_INLINE void store(std::complex<float> *pointer) const {
+				S::storeComplex(reinterpret_cast<float *>(pointer), real, imag);
+			}
+			SIGNALSMITH_INLINE void storeReversed(std::complex<float> *pointer) const {
+				S::storeComplex(reinterpret_cast<float *>(pointer + 1 - S::size), real.reversed(), imag.reversed());
+			}
+			SIGNALSMITH_INLINE SplitComplex conj() const {
+				return {real, S::splat(0) - imag};
+			}
+
+			friend SIGNALSMITH_INLINE SplitComplex operator+(const SplitComplex &a, const SplitComplex &b) {
+				return {a.real + b.real, a.imag + b.imag};
+			}
+			friend SIGNALSMITH_INLINE SplitComplex operator-(const SplitComplex &a, const SplitComplex &b) {
+				return {a.real - b.real, a.imag - b.imag};
+			}
+			friend SIGNALSMITH_INLINE SplitComplex operator*(const SplitComplex &a, const S &b) {
+				return {a.real*b, a.imag*b};
+			}
+		};
+
+		template <bool conjugateSecond, class S>
+		SIGNALSMITH_INLINE SplitComplex<S> splitMul(const SplitComplex<S> &a, const S &bReal, const S &bImag) {
+			return conjugateSecond ? SplitComplex<S>{
+				bReal*a.real + bImag*a.imag,
+				bReal*a.imag - bImag*a.real
+			} : SplitComplex<S>{
+				a.real*bReal - a.imag*bImag,
+				a.real*bImag + a.imag*bReal
+			};
+		}
+
+		template<bool flipped, class S>
+		SIGNALSMITH_INLINE SplitComplex<S> splitAddI(const SplitComplex<S> &a, const SplitComplex<S> &b) {
+			return flipped ? SplitComplex<S>{
+				a.real + b.imag,
+				a.imag - b.real
+			} : SplitComplex<S>{
+				a.real - b.imag,
+				a.imag + b.real
+			};
+		}
+
+		// The raw pointer behind a pointer or `std::vector` (so the SIMD paths can use it), otherwise `nullptr`
+		template<typename T>
+		SIGNALSMITH_INLINE std::nullptr_t contiguous(const T &) {
+			return nullptr;
+		}
+		template<typename V>
+		SIGNALSMITH_INLINE V * contiguous(V *pointer) {
+			return pointer;
+		}
+		template<typename V, typename A>
+		SIGNALSMITH_INLINE V * contiguous(std::vector<V, A> &vector) {
+			return vector.data();
+		}
+		template<typename V, typename A>
+		SIGNALSMITH_INLINE const V * contiguous(const std::vector<V, A> &vector) {
+			return vector.data();
+		}
+		// Same, but always const - inputs are matched against `const V *`
+		template<typename T>
+		SIGNALSMITH_INLINE auto contiguousConst(const T &t) -> decltype(contiguous(t)) {
+			return contiguous(t);
+		}
+		template<typename V>
+		SIGNALSMITH_INLINE const V * contiguousConst(V *pointer) {
+			return pointer;
+		}
+		template<typename V, typename A>
+		SIGNALSMITH_INLINE const V * contiguousConst(std::vector<V, A> &vector) {
+			return vector.data();
+		}
+
 		// Use SFINAE to get an iterator from std::begin(), if supported - otherwise assume the value itself is an iterator
 		template<typename T, typename=void>
 		struct GetIterator {
@@ -71,7 +165,7 @@ namespace signalsmith { namespace fft {
 	}
 
 	/** Floating-point FFT implementation.
-	It is fast for 2^a * 3^b.
+	It is fast for 2^a * 3^b (and has a dedicated radix-5 step, so 5^c isn't too bad either).
 	Here are the peak and RMS errors for `float`/`double` computation:
 	\diagram{fft-errors.svg Simulated errors for pure-tone harmonic inputs\, compared to a theoretical upper bound from "Roundoff error analysis of the fast Fourier transform" (G. Ramos, 1971)}
 	*/
@@ -79,10 +173,10 @@ namespace signalsmith { namespace fft {
 	class FFT {
 		using complex = std::complex<V>;
 		size_t _size;
-		std::vector<complex> workingVector;
+		signalsmith::perf::AlignedVector<complex> workingVector;
 		
 		enum class StepType {
-			generic, step2, step3, step4
+			generic, step2, step3, step4, step5, step8
 		};
 		struct Step {
 			StepType type;
@@ -91,108 +185,212 @@ namespace signalsmith { namespace fft {
 			size_t innerRepeats;
 			size_t outerRepeats;
 			size_t twiddleIndex;
+			size_t rootsIndex; // generic steps only: the `factor`-th roots of unity, also in `twiddleVector`
+			size_t simdWidth; // picked in `setSimdPlan()`, 1 = scalar
+			size_t splitIndex; // into `splitTwiddlesReal`/`splitTwiddlesImag`
 		};
-		std::vector<size_t> factors;
-		std::vector<Step> plan;
-		std::vector<complex> twiddleVector;
+		static constexpr bool simdFloat = std::is_same<V, float>::value;
 		
-		struct PermutationPair {size_t from, to;};
-		std::vector<PermutationPair> permutation;
+		/* Everything worked out for a particular size.  This never changes once it's built, so FFTs of the same size share one (see `getPlan()`). */
+		struct Plan {
+			size_t size;
+			std::vector<size_t> factors;
+			std::vector<Step> steps;
+			signalsmith::perf::AlignedVector<complex> twiddleVector;
+			// The same twiddles as [factor][repeat] rather than [repeat][factor], real and imaginary parts separate, so vectors load contiguously
+			signalsmith::perf::AlignedVector<V> splitTwiddlesReal, splitTwiddlesImag;
 		
-		void addPlanSteps(size_t factorIndex, size_t start, size_t length, size_t repeats) {
-			if (factorIndex >= factors.size()) return;
+			struct PermutationPair {size_t from, to;};
+			std::vector<PermutationPair> permutation;
+			std::vector<size_t> permutationGather; // permuted[i] = input[permutationGather[i]]
+			bool wideSteps = false; // Some steps are 8 wide, so this CPU has AVX2 and the steps run through `runWideSteps()`
+
+			void addPlanSteps(size_t factorIndex, size_t start, size_t length, size_t repeats) {
+				if (factorIndex >= factors.size()) return;
 			
-			size_t factor = factors[factorIndex];
-			if (factorIndex + 1 < factors.size()) {
-				if (factors[factorIndex] == 2 && factors[factorIndex + 1] == 2) {
-					++factorIndex;
-					factor = 4;
+				size_t factor = factors[factorIndex];
+				if (factorIndex + 2 < factors.size() && factors[factorIndex] == 2 && factors[factorIndex + 1] == 2 && factors[factorIndex + 2] == 2) {
+					factorIndex += 2;
+					factor = 8;
+				} else if (factorIndex + 1 < factors.size()) {
+					if (factors[factorIndex] == 2 && factors[factorIndex + 1] == 2) {
+						++factorIndex;
+						factor = 4;
+					}
 				}
-			}
 
-			size_t subLength = length/factor;
-			Step mainStep{StepType::generic, factor, start, subLength, repeats, twiddleVector.size()};
+				size_t subLength = length/factor;
+				Step mainStep{StepType::generic, factor, start, subLength, repeats, twiddleVector.size(), 0, 1, 0};
 
-			if (factor == 2) mainStep.type = StepType::step2;
-			if (factor == 3) mainStep.type = StepType::step3;
-			if (factor == 4) mainStep.type = StepType::step4;
+				if (factor == 2) mainStep.type = StepType::step2;
+				if (factor == 3) mainStep.type = StepType::step3;
+				if (factor == 4) mainStep.type = StepType::step4;
+				if (factor == 5) mainStep.type = StepType::step5;
+				if (factor == 8) mainStep.type = StepType::step8;
 
-			// Twiddles
-			bool foundStep = false;
-			for (const Step &existingStep : plan) {
-				if (existingStep.factor == mainStep.factor && existingStep.innerRepeats == mainStep.innerRepeats) {
-					foundStep = true;
-					mainStep.twiddleIndex = existingStep.twiddleIndex;
-					break;
+				// Twiddles
+				bool foundStep = false;
+				for (const Step &existingStep : steps) {
+					if (existingStep.factor == mainStep.factor && existingStep.innerRepeats == mainStep.innerRepeats) {
+						foundStep = true;
+						mainStep.twiddleIndex = existingStep.twiddleIndex;
+						break;
+					}
 				}
-			}
-			if (!foundStep) {
-				for (size_t i = 0; i < subLength; ++i) {
-					for (size_t f = 0; f < factor; ++f) {
-						double phase = 2*M_PI*i*f/length;
-						V real = V(std::cos(phase));
-						V imag = V(-std::sin(phase));
-						complex twiddle = {real, imag};
-						twiddleVector.push_back(twiddle);
+				if (!foundStep) {
+					for (size_t i = 0; i < subLength; ++i) {
+						for (size_t f = 0; f < factor; ++f) {
+							double phase = 2*M_PI*i*f/length;
+							V real = V(std::cos(phase));
+							V imag = V(-std::sin(phase));
+							complex twiddle = {real, imag};
+							twiddleVector.push_back(twiddle);
+						}
 					}
 				}
-			}
-
-			if (repeats == 1 && sizeof(complex)*subLength > 65536) {
-				for (size_t i = 0; i < factor; ++i) {
-					addPlanSteps(factorIndex + 1, start + i*subLength, subLength, 1);
+				if (mainStep.type == StepType::generic) {
+					// The butterfly's own rotations, so the inner loop doesn't need any trig
+					bool foundRoots = false;
+					for (const Step &existingStep : steps) {
+						if (existingStep.type == StepType::generic && existingStep.factor == factor) {
+							foundRoots = true;
+							mainStep.rootsIndex = existingStep.rootsIndex;
+							break;
+						}
+					}
+					if (!foundRoots) {
+						mainStep.rootsIndex = twiddleVector.size();
+						for (size_t i = 0; i < factor; ++i) {
+							double phase = 2*M_PI*i/factor;
+							twiddleVector.push_back({V(std::cos(phase)), V(-std::sin(phase))});
+						}
+					}
 				}
-			} else {
-				addPlanSteps(factorIndex + 1, start, subLength, repeats*factor);
-			}
-			plan.push_back(mainStep);
-		}
-		void setPlan() {
-			factors.resize(0);
-			size_t size = _size, factor = 2;
-			while (size > 1) {
-				if (size%factor == 0) {
-					factors.push_back(factor);
-					size /= factor;
-				} else if (factor > sqrt(size)) {
-					factor = size;
+
+				if (repeats == 1 && sizeof(complex)*subLength > 65536) {
+					for (size_t i = 0; i < factor; ++i) {
+						addPlanSteps(factorIndex + 1, start + i*subLength, subLength, 1);
+					}
 				} else {
-					++factor;
+					addPlanSteps(factorIndex + 1, start, subLength, repeats*factor);
 				}
+				steps.push_back(mainStep);
 			}
+			void setPlan() {
+				factors.resize(0);
+				size_t remaining = size, factor = 2;
+				while (remaining > 1) {
+					if (remaining%factor == 0) {
+						factors.push_back(factor);
+						remaining /= factor;
+					} else if (factor > sqrt(remaining)) {
+						factor = remaining;
+					} else {
+						++factor;
+					}
+				}
 
-			plan.resize(0);
-			twiddleVector.resize(0);
-			addPlanSteps(0, 0, _size, 1);
+				steps.resize(0);
+				twiddleVector.resize(0);
+				addPlanSteps(0, 0, size, 1);
 			
-			permutation.resize(0);
-			permutation.push_back(PermutationPair{0, 0});
-			size_t indexLow = 0, indexHigh = factors.size();
-			size_t inputStepLow = _size, outputStepLow = 1;
-			size_t inputStepHigh = 1, outputStepHigh = _size;
-			while (outputStepLow*inputStepHigh < _size) {
-				size_t f, inputStep, outputStep;
-				if (outputStepLow <= inputStepHigh) {
-					f = factors[indexLow++];
-					inputStep = (inputStepLow /= f);
-					outputStep = outputStepLow;
-					outputStepLow *= f;
-				} else {
-					f = factors[--indexHigh];
-					inputStep = inputStepHigh;
-					inputStepHigh *= f;
-					outputStep = (outputStepHigh /= f);
+				permutation.resize(0);
+				permutation.push_back(PermutationPair{0, 0});
+				size_t indexLow = 0, indexHigh = factors.size();
+				size_t inputStepLow = size, outputStepLow = 1;
+				size_t inputStepHigh = 1, outputStepHigh = size;
+				while (outputStepLow*inputStepHigh < size) {
+					size_t f, inputStep, outputStep;
+					if (outputStepLow <= inputStepHigh) {
+						f = factors[indexLow++];
+						inputStep = (inputStepLow /= f);
+						outputStep = outputStepLow;
+						outputStepLow *= f;
+					} else {
+						f = factors[--indexHigh];
+						inputStep = inputStepHigh;
+						inputStepHigh *= f;
+						outputStep = (outputStepHigh /= f);
+					}
+					size_t oldSize = permutation.size();
+					for (size_t i = 1; i < f; ++i) {
+						for (size_t j = 0; j < oldSize; ++j) {
+							PermutationPair pair = permutation[j];
+							pair.from += i*inputStep;
+							pair.to += i*outputStep;
+							permutation.push_back(pair);
+						}
+					}
+				}
+				// Ordered by destination, so the writes are sequential
+				permutationGather.resize(permutation.size());
+				for (const PermutationPair &pair : permutation) {
+					permutationGather[pair.from] = pair.to;
 				}
-				size_t oldSize = permutation.size();
-				for (size_t i = 1; i < f; ++i) {
-					for (size_t j = 0; j < oldSize; ++j) {
-						PermutationPair pair = permutation[j];
-						pair.from += i*inputStep;
-						pair.to += i*outputStep;
-						permutation.push_back(pair);
+
+				setSimdPlan();
+			}
+
+			// Picks a vector width for each step, once per size, including whether this CPU can run the AVX2 ones
+			void setSimdPlan() {
+				splitTwiddlesReal.resize(0);
+				splitTwiddlesImag.resize(0);
+				const bool simd8 = signalsmith::perf::hasFloat8();
+				wideSteps = false;
+				for (size_t stepIndex = 0; stepIndex < steps.size(); ++stepIndex) {
+					Step &step = steps[stepIndex];
+					step.simdWidth = 1;
+					if (!simdFloat || step.type == StepType::generic) continue;
+
+					// Prefer a width which divides the stride exactly, otherwise the remainder is done by the scalar step
+					size_t stride = step.innerRepeats;
+					if (simd8 && stride%8 == 0) {
+						step.simdWidth = 8;
+					} else if (SIGNALSMITH_PERF_SIMD4 && stride%4 == 0) {
+						step.simdWidth = 4;
+					} else if (simd8 && stride >= 8) {
+						step.simdWidth = 8;
+					} else if (SIGNALSMITH_PERF_SIMD4 && stride >= 4) {
+						step.simdWidth = 4;
+					}
+					if (step.simdWidth == 1) continue;
+					if (step.simdWidth == 8) wideSteps = true;
+
+					bool foundTwiddles = false;
+					for (size_t i = 0; i < stepIndex; ++i) {
+						if (steps[i].simdWidth > 1 && steps[i].twiddleIndex == step.twiddleIndex) {
+							foundTwiddles = true;
+							step.splitIndex = steps[i].splitIndex;
+							break;
+						}
+					}
+					if (!foundTwiddles) {
+						step.splitIndex = splitTwiddlesReal.size();
+						for (size_t f = 0; f < step.factor; ++f) {
+							for (size_t i = 0; i < stride; ++i) {
+								const complex &twiddle = twiddleVector[step.twiddleIndex + i*step.factor + f];
+								splitTwiddlesReal.push_back(twiddle.real());
+								splitTwiddlesImag.push_back(twiddle.imag());
+							}
+						}
 					}
 				}
 			}
+
+			explicit Plan(size_t size) : size(size) {
+				setPlan();
+			}
+		};
+		std::shared_ptr<const Plan> sharedPlan;
+
+		// Process-wide, so building a second FFT (or stretcher) of a size we've already seen costs a map lookup
+		static std::shared_ptr<const Plan> getPlan(size_t size) {
+			static std::mutex mutex;
+			static std::map<size_t, std::shared_ptr<const Plan>> plans;
+			std::lock_guard<std::mutex> lock(mutex);
+			std::shared_ptr<const Plan> &plan = plans[size];
+			if (!plan) plan = std::make_shared<const Plan>(size);
+			return plan;
 		}
 
 		template<bool inverse, typename RandomAccessIterator>
@@ -203,7 +401,8 @@ namespace signalsmith { namespace fft {
 			for (size_t outerRepeat = 0; outerRepeat < step.outerRepeats; ++outerRepeat) {
 				RandomAccessIterator data = origData;
 				
-				const complex *twiddles = twiddleVector.data() + step.twiddleIndex;
+				const complex *twiddles = sharedPlan->twiddleVector.data() + step.twiddleIndex;
+				const complex *roots = sharedPlan->twiddleVector.data() + step.rootsIndex;
 				const size_t factor = step.factor;
 				for (size_t repeat = 0; repeat < step.innerRepeats; ++repeat) {
 					for (size_t i = 0; i < step.factor; ++i) {
@@ -211,12 +410,11 @@ namespace signalsmith { namespace fft {
 					}
 					for (size_t f = 0; f < factor; ++f) {
 						complex sum = working[0];
+						size_t rootIndex = 0; // (f*i)%factor, without the modulo
 						for (size_t i = 1; i < factor; ++i) {
-							double phase = 2*M_PI*f*i/factor;
-							V real = V(std::cos(phase));
-							V imag = V(-std::sin(phase));
-							complex twiddle = {real, imag};
-							sum += _fft_impl::complexMul<inverse>(working[i], twiddle);
+							rootIndex += f;
+							if (rootIndex >= factor) rootIndex -= factor;
+							sum += _fft_impl::complexMul<inverse>(working[i], roots[rootIndex]);
 						}
 						data[f*stride] = sum;
 					}
@@ -228,12 +426,12 @@ namespace signalsmith { namespace fft {
 		}
 
 		template<bool inverse, typename RandomAccessIterator>
-		SIGNALSMITH_INLINE void fftStep2(RandomAccessIterator &&origData, const Step &step) {
+		SIGNALSMITH_INLINE void fftStep2(RandomAccessIterator &&origData, const Step &step, size_t from=0) {
 			const size_t stride = step.innerRepeats;
-			const complex *origTwiddles = twiddleVector.data() + step.twiddleIndex;
+			const complex *origTwiddles = sharedPlan->twiddleVector.data() + step.twiddleIndex;
 			for (size_t outerRepeat = 0; outerRepeat < step.outerRepeats; ++outerRepeat) {
-				const complex* twiddles = origTwiddles;
-				for (RandomAccessIterator data = origData; data < origData + stride; ++data) {
+				const complex* twiddles = origTwiddles + from*2;
+				for (RandomAccessIterator data = origData + from; data < origData + stride; ++data) {
 					complex A = data[0];
 					complex B = _fft_impl::complexMul<inverse>(data[stride], twiddles[1]);
 					
@@ -246,14 +444,14 @@ namespace signalsmith { namespace fft {
 		}
 
 		template<bool inverse, typename RandomAccessIterator>
-		SIGNALSMITH_INLINE void fftStep3(RandomAccessIterator &&origData, const Step &step) {
+		SIGNALSMITH_INLINE void fftStep3(RandomAccessIterator &&origData, const Step &step, size_t from=0) {
 			constexpr complex factor3 = {V(-0.5), inverse ? V(0.8660254037844386) : V(-0.8660254037844386)};
 			const size_t stride = step.innerRepeats;
-			const complex *origTwiddles = twiddleVector.data() + step.twiddleIndex;
+			const complex *origTwiddles = sharedPlan->twiddleVector.data() + step.twiddleIndex;
 			
 			for (size_t outerRepeat = 0; outerRepeat < step.outerRepeats; ++outerRepeat) {
-				const complex* twiddles = origTwiddles;
-				for (RandomAccessIterator data = origData; data < origData + stride; ++data) {
+				const complex* twiddles = origTwiddles + from*3;
+				for (RandomAccessIterator data = origData + from; data < origData + stride; ++data) {
 					complex A = data[0];
 					complex B = _fft_impl::complexMul<inverse>(data[stride], twiddles[1]);
 					complex C = _fft_impl::complexMul<inverse>(data[stride*2], twiddles[2]);
@@ -272,13 +470,13 @@ namespace signalsmith { namespace fft {
 		}
 
 		template<bool inverse, typename RandomAccessIterator>
-		SIGNALSMITH_INLINE void fftStep4(RandomAccessIterator &&origData, const Step &step) {
+		SIGNALSMITH_INLINE void fftStep4(RandomAccessIterator &&origData, const Step &step, size_t from=0) {
 			const size_t stride = step.innerRepeats;
-			const complex *origTwiddles = twiddleVector.data() + step.twiddleIndex;
+			const complex *origTwiddles = sharedPlan->twiddleVector.data() + step.twiddleIndex;
 			
 			for (size_t outerRepeat = 0; outerRepeat < step.outerRepeats; ++outerRepeat) {
-				const complex* twiddles = origTwiddles;
-				for (RandomAccessIterator data = origData; data < origData + stride; ++data) {
+				const complex* twiddles = origTwiddles + from*4;
+				for (RandomAccessIterator data = origData + from; data < origData + stride; ++data) {
 					complex A = data[0];
 					complex C = _fft_impl::complexMul<inverse>(data[stride], twiddles[2]);
 					complex B = _fft_impl::complexMul<inverse>(data[stride*2], twiddles[1]);
@@ -297,35 +495,375 @@ namespace signalsmith { namespace fft {
 				origData += 4*stride;
 			}
 		}
+
+		template<bool inverse, typename RandomAccessIterator>
+		SIGNALSMITH_INLINE void fftStep5(RandomAccessIterator &&origData, const Step &step, size_t from=0) {
+			constexpr V cos1 = V(0.30901699437494745), cos2 = V(-0.8090169943749475);
+			constexpr V sin1 = V(0.9510565162951535), sin2 = V(0.5877852522924731);
+			const size_t stride = step.innerRepeats;
+			const complex *origTwiddles = sharedPlan->twiddleVector.data() + step.twiddleIndex;
+
+			for (size_t outerRepeat = 0; outerRepeat < step.outerRepeats; ++outerRepeat) {
+				const complex* twiddles = origTwiddles + from*5;
+				for (RandomAccessIterator data = origData + from; data < origData + stride; ++data) {
+					complex A = data[0];
+					complex B = _fft_impl::complexMul<inverse>(data[stride], twiddles[1]);
+					complex C = _fft_impl::complexMul<inverse>(data[stride*2], twiddles[2]);
+					complex D = _fft_impl::complexMul<inverse>(data[stride*3], twiddles[3]);
+					complex E = _fft_impl::complexMul<inverse>(data[stride*4], twiddles[4]);
+
+					complex sumBE = B + E, sumCD = C + D;
+					complex diffBE = B - E, diffCD = C - D;
+
+					complex real1 = A + sumBE*cos1 + sumCD*cos2;
+					complex real2 = A + sumBE*cos2 + sumCD*cos1;
+					complex imag1 = diffBE*sin1 + diffCD*sin2;
+					complex imag2 = diffBE*sin2 - diffCD*sin1;
+
+					data[0] = A + sumBE + sumCD;
+					data[stride] = _fft_impl::complexAddI<!inverse>(real1, imag1);
+					data[stride*2] = _fft_impl::complexAddI<!inverse>(real2, imag2);
+					data[stride*3] = _fft_impl::complexAddI<inverse>(real2, imag2);
+					data[stride*4] = _fft_impl::complexAddI<inverse>(real1, imag1);
+
+					twiddles += 5;
+				}
+				origData += 5*stride;
+			}
+		}
+
+		// Three radix-2 steps in one.  Like `fftStep4()`, the inputs arrive in bit-reversed order.
+		template<bool inverse, typename RandomAccessIterator>
+		SIGNALSMITH_INLINE void fftStep8(RandomAccessIterator &&origData, const Step &step, size_t from=0) {
+			constexpr V sqrtHalf = V(0.7071067811865476);
+			const size_t stride = step.innerRepeats;
+			const complex *origTwiddles = sharedPlan->twiddleVector.data() + step.twiddleIndex;
+
+			for (size_t outerRepeat = 0; outerRepeat < step.outerRepeats; ++outerRepeat) {
+				const complex* twiddles = origTwiddles + from*8;
+				for (RandomAccessIterator data = origData + from; data < origData + stride; ++data) {
+					complex x0 = data[0];
+					complex x4 = _fft_impl::complexMul<inverse>(data[stride], twiddles[4]);
+					complex x2 = _fft_impl::complexMul<inverse>(data[stride*2], twiddles[2]);
+					complex x6 = _fft_impl::complexMul<inverse>(data[stride*3], twiddles[6]);
+					complex x1 = _fft_impl::complexMul<inverse>(data[stride*4], twiddles[1]);
+					complex x5 = _fft_impl::complexMul<inverse>(data[stride*5], twiddles[5]);
+					complex x3 = _fft_impl::complexMul<inverse>(data[stride*6], twiddles[3]);
+					complex x7 = _fft_impl::complexMul<inverse>(data[stride*7], twiddles[7]);
+
+					// Radix-4 on the evens and the odds
+					complex sum04 = x0 + x4, diff04 = x0 - x4, sum26 = x2 + x6, diff26 = x2 - x6;
+					complex even0 = sum04 + sum26, even2 = sum04 - sum26;
+					complex even1 = _fft_impl::complexAddI<!inverse>(diff04, diff26);
+					complex even3 = _fft_impl::complexAddI<inverse>(diff04, diff26);
+
+					complex sum15 = x1 + x5, diff15 = x1 - x5, sum37 = x3 + x7, diff37 = x3 - x7;
+					complex odd0 = sum15 + sum37, odd2 = sum15 - sum37;
+					complex odd1 = _fft_impl::complexAddI<!inverse>(diff15, diff37);
+					complex odd3 = _fft_impl::complexAddI<inverse>(diff15, diff37);
+
+					// Rotate the odds by e^(-i*pi*k/4), then combine
+					V odd1Real = _fft_impl::complexReal(odd1), odd1Imag = _fft_impl::complexImag(odd1);
+					V odd3Real = _fft_impl::complexReal(odd3), odd3Imag = _fft_impl::complexImag(odd3);
+					odd1 = inverse ? complex{(odd1Real - odd1Imag)*sqrtHalf, (odd1Imag + odd1Real)*sqrtHalf} : complex{(odd1Real + odd1Imag)*sqrtHalf, (odd1Imag - odd1Real)*sqrtHalf};
+					odd3 = inverse ? complex{-(odd3Real + odd3Imag)*sqrtHalf, (odd3Real - odd3Imag)*sqrtHalf} : complex{(odd3Imag - odd3Real)*sqrtHalf, -(odd3Real + odd3Imag)*sqrtHalf};
+
+					data[0] = even0 + odd0;
+					data[stride] = even1 + odd1;
+					data[stride*2] = _fft_impl::complexAddI<!inverse>(even2, odd2);
+					data[stride*3] = even3 + odd3;
+					data[stride*4] = even0 - odd0;
+					data[stride*5] = even1 - odd1;
+					data[stride*6] = _fft_impl::complexAddI<inverse>(even2, odd2);
+					data[stride*7] = even3 - odd3;
+
+					twiddles += 8;
+				}
+				origData += 8*stride;
+			}
+		}
 		
+		/* SIMD versions of the steps above, `S::size` repeats at a time (see `setSimdPlan()`).
+		Any remainder of the stride is handed to the scalar step. */
+		template<bool inverse, class S>
+		SIGNALSMITH_INLINE void simdStep2(complex *origData, const Step &step) {
+			using Split = _fft_impl::SplitComplex<S>;
+			const size_t stride = step.innerRepeats, vectorEnd = stride - stride%S::size;
+			const V *twiddlesReal = sharedPlan->splitTwiddlesReal.data() + step.splitIndex, *twiddlesImag = sharedPlan->splitTwiddlesImag.data() + step.splitIndex;
+
+			complex *outerData = origData;
+			for (size_t outerRepeat = 0; outerRepeat < step.outerRepeats; ++outerRepeat) {
+				for (size_t i = 0; i < vectorEnd; i += S::size) {
+					complex *data = outerData + i;
+					Split A = Split::load(data);
+					Split B = _fft_impl::splitMul<inverse>(Split::load(data + stride), S::load(twiddlesReal + stride + i), S::load(twiddlesImag + stride + i));
+
+					(A + B).store(data);
+					(A - B).store(data + stride);
+				}
+				outerData += 2*stride;
+			}
+			if (vectorEnd < stride) fftStep2<inverse>(origData + 0, step, vectorEnd); // (an rvalue, since it takes the iterator by reference)
+		}
+
+		template<bool inverse, class S>
+		SIGNALSMITH_INLINE void simdStep3(complex *origData, const Step &step) {
+			using Split = _fft_impl::SplitComplex<S>;
+			const S factor3Real = S::splat(V(-0.5)), factor3Imag = S::splat(inverse ? V(0.8660254037844386) : V(-0.8660254037844386));
+			const size_t stride = step.innerRepeats, vectorEnd = stride - stride%S::size;
+			const V *twiddlesReal = sharedPlan->splitTwiddlesReal.data() + step.splitIndex, *twiddlesImag = sharedPlan->splitTwiddlesImag.data() + step.splitIndex;
+
+			complex *outerData = origData;
+			for (size_t outerRepeat = 0; outerRepeat < step.outerRepeats; ++outerRepeat) {
+				for (size_t i = 0; i < vectorEnd; i += S::size) {
+					complex *data = outerData + i;
+					Split A = Split::load(data);
+					Split B = _fft_impl::splitMul<inverse>(Split::load(data + stride), S::load(twiddlesReal + stride + i), S::load(twiddlesImag + stride + i));
+					Split C = _fft_impl::splitMul<inverse>(Split::load(data + stride*2), S::load(twiddlesReal + stride*2 + i), S::load(twiddlesImag + stride*2 + i));
+
+					Split realSum = A + (B + C)*factor3Real;
+					Split imagSum = (B - C)*factor3Imag;
+
+					(A + B + C).store(data);
+					_fft_impl::splitAddI<false>(realSum, imagSum).store(data + stride);
+					_fft_impl::splitAddI<true>(realSum, imagSum).store(data + stride*2);
+				}
+				outerData += 3*stride;
+			}
+			if (vectorEnd < stride) fftStep3<inverse>(origData + 0, step, vectorEnd);
+		}
+
+		template<bool inverse, class S>
+		SIGNALSMITH_INLINE void simdStep4(complex *origData, const Step &step) {
+			using Split = _fft_impl::SplitComplex<S>;
+			const size_t stride = step.innerRepeats, vectorEnd = stride - stride%S::size;
+			const V *twiddlesReal = sharedPlan->splitTwiddlesReal.data() + step.splitIndex, *twiddlesImag = sharedPlan->splitTwiddlesImag.data() + step.splitIndex;
+
+			complex *outerData = origData;
+			for (size_t outerRepeat = 0; outerRepeat < step.outerRepeats; ++outerRepeat) {
+				for (size_t i = 0; i < vectorEnd; i += S::size) {
+					complex *data = outerData + i;
+					Split A = Split::load(data);
+					Split C = _fft_impl::splitMul<inverse>(Split::load(data + stride), S::load(twiddlesReal + stride*2 + i), S::load(twiddlesImag + stride*2 + i));
+					Split B = _fft_impl::splitMul<inverse>(Split::load(data + stride*2), S::load(twiddlesReal + stride + i), S::load(twiddlesImag + stride + i));
+					Split D = _fft_impl::splitMul<inverse>(Split::load(data + stride*3), S::load(twiddlesReal + stride*3 + i), S::load(twiddlesImag + stride*3 + i));
+
+					Split sumAC = A + C, sumBD = B + D;
+					Split diffAC = A - C, diffBD = B - D;
+
+					(sumAC + sumBD).store(data);
+					_fft_impl::splitAddI<!inverse>(diffAC, diffBD).store(data + stride);
+					(sumAC - sumBD).store(data + stride*2);
+					_fft_impl::splitAddI<inverse>(diffAC, diffBD).store(data + stride*3);
+				}
+				outerData += 4*stride;
+			}
+			if (vectorEnd < stride) fftStep4<inverse>(origData + 0, step, vectorEnd);
+		}
+
+		template<bool inverse, class S>
+		SIGNALSMITH_INLINE void simdStep5(complex *origData, const Step &step) {
+			using Split = _fft_impl::SplitComplex<S>;
+			const S cos1 = S::splat(V(0.30901699437494745)), cos2 = S::splat(V(-0.8090169943749475));
+			const S sin1 = S::splat(V(0.9510565162951535)), sin2 = S::splat(V(0.5877852522924731));
+			const size_t stride = step.innerRepeats, vectorEnd = stride - stride%S::size;
+			const V *twiddlesReal = sharedPlan->splitTwiddlesReal.data() + step.splitIndex, *twiddlesImag = sharedPlan->splitTwiddlesImag.data() + step.splitIndex;
+
+			complex *outerData = origData;
+			for (size_t outerRepeat = 0; outerRepeat < step.outerRepeats; ++outerRepeat) {
+				for (size_t i = 0; i < vectorEnd; i += S::size) {
+					complex *data = outerData + i;
+					Split A = Split::load(data);
+					Split B = _fft_impl::splitMul<inverse>(Split::load(data + stride), S::load(twiddlesReal + stride + i), S::load(twiddlesImag + stride + i));
+					Split C = _fft_impl::splitMul<inverse>(Split::load(data + stride*2), S::load(twiddlesReal + stride*2 + i), S::load(twiddlesImag + stride*2 + i));
+					Split D = _fft_impl::splitMul<inverse>(Split::load(data + stride*3), S::load(twiddlesReal + stride*3 + i), S::load(twiddlesImag + stride*3 + i));
+					Split E = _fft_impl::splitMul<inverse>(Split::load(data + stride*4), S::load(twiddlesReal + stride*4 + i), S::load(twiddlesImag + stride*4 + i));
+
+					Split sumBE = B + E, sumCD = C + D;
+					Split diffBE = B - E, diffCD = C - D;
+
+					Split real1 = A + sumBE*cos1 + sumCD*cos2;
+					Split real2 = A + sumBE*cos2 + sumCD*cos1;
+					Split imag1 = diffBE*sin1 + diffCD*sin2;
+					Split imag2 = diffBE*sin2 - diffCD*sin1;
+
+					(A + sumBE + sumCD).store(data);
+					_fft_impl::splitAddI<!inverse>(real1, imag1).store(data + stride);
+					_fft_impl::splitAddI<!inverse>(real2, imag2).store(data + stride*2);
+					_fft_impl::splitAddI<inverse>(real2, imag2).store(data + stride*3);
+					_fft_impl::splitAddI<inverse>(real1, imag1).store(data + stride*4);
+				}
+				outerData += 5*stride;
+			}
+			if (vectorEnd < stride) fftStep5<inverse>(origData + 0, step, vectorEnd);
+		}
+
+		template<bool inverse, class S>
+		SIGNALSMITH_INLINE void simdStep8(complex *origData, const Step &step) {
+			using Split = _fft_impl::SplitComplex<S>;
+			const S sqrtHalf = S::splat(V(0.7071067811865476));
+			const size_t stride = step.innerRepeats, vectorEnd = stride - stride%S::size;
+			const V *twiddlesReal = sharedPlan->splitTwiddlesReal.data() + step.splitIndex, *twiddlesImag = sharedPlan->splitTwiddlesImag.data() + step.splitIndex;
+
+			complex *outerData = origData;
+			for (size_t outerRepeat = 0; outerRepeat < step.outerRepeats; ++outerRepeat) {
+				for (size_t i = 0; i < vectorEnd; i += S::size) {
+					complex *data = outerData + i;
+					Split x0 = Split::load(data);
+					Split x4 = _fft_impl::splitMul<inverse>(Split::load(data + stride), S::load(twiddlesReal + stride*4 + i), S::load(twiddlesImag + stride*4 + i));
+					Split x2 = _fft_impl::splitMul<inverse>(Split::load(data + stride*2), S::load(twiddlesReal + stride*2 + i), S::load(twiddlesImag + stride*2 + i));
+					Split x6 = _fft_impl::splitMul<inverse>(Split::load(data + stride*3), S::load(twiddlesReal + stride*6 + i), S::load(twiddlesImag + stride*6 + i));
+					Split x1 = _fft_impl::splitMul<inverse>(Split::load(data + stride*4), S::load(twiddlesReal + stride + i), S::load(twiddlesImag + stride + i));
+					Split x5 = _fft_impl::splitMul<inverse>(Split::load(data + stride*5), S::load(twiddlesReal + stride*5 + i), S::load(twiddlesImag + stride*5 + i));
+					Split x3 = _fft_impl::splitMul<inverse>(Split::load(data + stride*6), S::load(twiddlesReal + stride*3 + i), S::load(twiddlesImag + stride*3 + i));
+					Split x7 = _fft_impl::splitMul<inverse>(Split::load(data + stride*7), S::load(twiddlesReal + stride*7 + i), S::load(twiddlesImag + stride*7 + i));
+
+					Split sum04 = x0 + x4, diff04 = x0 - x4, sum26 = x2 + x6, diff26 = x2 - x6;
+					Split even0 = sum04 + sum26, even2 = sum04 - sum26;
+					Split even1 = _fft_impl::splitAddI<!inverse>(diff04, diff26);
+					Split even3 = _fft_impl::splitAddI<inverse>(diff04, diff26);
+
+					Split sum15 = x1 + x5, diff15 = x1 - x5, sum37 = x3 + x7, diff37 = x3 - x7;
+					Split odd0 = sum15 + sum37, odd2 = sum15 - sum37;
+					Split odd1 = _fft_impl::splitAddI<!inverse>(diff15, diff37);
+					Split odd3 = _fft_impl::splitAddI<inverse>(diff15, diff37);
+
+					odd1 = inverse ? Split{(odd1.real - odd1.imag)*sqrtHalf, (odd1.imag + odd1.real)*sqrtHalf} : Split{(odd1.real + odd1.imag)*sqrtHalf, (odd1.imag - odd1.real)*sqrtHalf};
+					odd3 = inverse ? Split{(S::splat(0) - odd3.real - odd3.imag)*sqrtHalf, (odd3.real - odd3.imag)*sqrtHalf} : Split{(odd3.imag - odd3.real)*sqrtHalf, (S::splat(0) - odd3.real - odd3.imag)*sqrtHalf};
+
+					(even0 + odd0).store(data);
+					(even1 + odd1).store(data + stride);
+					_fft_impl::splitAddI<!inverse>(even2, odd2).store(data + stride*2);
+					(even3 + odd3).store(data + stride*3);
+					(even0 - odd0).store(data + stride*4);
+					(even1 - odd1).store(data + stride*5);
+					_fft_impl::splitAddI<inverse>(even2, odd2).store(data + stride*6);
+					(even3 - odd3).store(data + stride*7);
+				}
+				outerData += 8*stride;
+			}
+			if (vectorEnd < stride) fftStep8<inverse>(origData + 0, step, vectorEnd);
+		}
+
 		template<typename InputIterator, typename OutputIterator>
-		void permute(InputIterator input, OutputIterator data) {
-			for (auto pair : permutation) {
-				data[pair.from] = input[pair.to];
+		void permute(InputIterator input, OutputIterator data, std::false_type) {
+			const size_t *gather = sharedPlan->permutationGather.data();
+			for (size_t i = 0; i < _size; ++i) {
+				data[i] = input[gather[i]];
+			}
+		}
+		// Two complex numbers per vector
+		template<typename Unused=void>
+		void permute(const complex *input, complex *data, std::true_type) {
+			const size_t *gather = sharedPlan->permutationGather.data();
+			size_t i = 0;
+			for (; i + 2 <= _size; i += 2) {
+				signalsmith::perf::Float4::loadPair(reinterpret_cast<const float *>(input + gather[i]), reinterpret_cast<const float *>(input + gather[i + 1])).store(reinterpret_cast<float *>(data + i));
+			}
+			for (; i < _size; ++i) {
+				data[i] = input[gather[i]];
 			}
 		}
 
-		template<bool inverse, typename InputIterator, typename OutputIterator>
-		void run(InputIterator &&input, OutputIterator &&data) {
-			permute(input, data);
-			
-			for (const Step &step : plan) {
-				switch (step.type) {
-					case StepType::generic:
-						fftStepGeneric<inverse>(data + step.startIndex, step);
-						break;
-					case StepType::step2:
-						fftStep2<inverse>(data + step.startIndex, step);
-						break;
-					case StepType::step3:
-						fftStep3<inverse>(data + step.startIndex, step);
-						break;
-					case StepType::step4:
-						fftStep4<inverse>(data + step.startIndex, step);
-						break;
+		template<bool inverse, typename RandomAccessIterator>
+		SIGNALSMITH_INLINE void runStep(RandomAccessIterator &&data, const Step &step) {
+			switch (step.type) {
+				case StepType::generic:
+					fftStepGeneric<inverse>(data + step.startIndex, step);
+					break;
+				case StepType::step2:
+					fftStep2<inverse>(data + step.startIndex, step);
+					break;
+				case StepType::step3:
+					fftStep3<inverse>(data + step.startIndex, step);
+					break;
+				case StepType::step4:
+					fftStep4<inverse>(data + step.startIndex, step);
+					break;
+				case StepType::step5:
+					fftStep5<inverse>(data + step.startIndex, step);
+					break;
+				case StepType::step8:
+					fftStep8<inverse>(data + step.startIndex, step);
+					break;
+			}
+		}
+
+		template<bool inverse, class S>
+		SIGNALSMITH_INLINE void runSimdStep(complex *data, const Step &step) {
+			switch (step.type) {
+				case StepType::generic:
+					fftStepGeneric<inverse>(data + step.startIndex, step);
+					break;
+				case StepType::step2:
+					simdStep2<inverse, S>(data + step.startIndex, step);
+					break;
+				case StepType::step3:
+					simdStep3<inverse, S>(data + step.startIndex, step);
+					break;
+				case StepType::step4:
+					simdStep4<inverse, S>(data + step.startIndex, step);
+					break;
+				case StepType::step5:
+					simdStep5<inverse, S>(data + step.startIndex, step);
+					break;
+				case StepType::step8:
+					simdStep8<inverse, S>(data + step.startIndex, step);
+					break;
+			}
+		}
+
+		template<bool inverse, typename RandomAccessIterator>
+		void runSteps(RandomAccessIterator &&data, std::false_type) {
+			for (const Step &step : sharedPlan->steps) {
+				runStep<inverse>(data, step);
+			}
+		}
+		template<bool inverse>
+		void runSteps(complex *data, std::true_type) {
+#if SIGNALSMITH_PERF_SIMD8 || SIGNALSMITH_PERF_RUNTIME8
+			if (sharedPlan->wideSteps) {
+				runWideSteps<inverse>(data);
+				return;
+			}
+#endif
+			for (const Step &step : sharedPlan->steps) {
+#if SIGNALSMITH_PERF_SIMD4
+				if (step.simdWidth == 4) {
+					runSimdStep<inverse, signalsmith::perf::Float4>(data, step);
+					continue;
+				}
+#endif
+				runStep<inverse>(data, step);
+			}
+		}
+#if SIGNALSMITH_PERF_SIMD8 || SIGNALSMITH_PERF_RUNTIME8
+		// Only for plans which found AVX2, and compiled for it whatever the rest of the build targets
+		template<bool inverse>
+		SIGNALSMITH_PERF_FLOAT8_FUNCTION void runWideSteps(complex *data) {
+			for (const Step &step : sharedPlan->steps) {
+				if (step.simdWidth == 8) {
+					runSimdStep<inverse, signalsmith::perf::Float8>(data, step);
+				} else if (step.simdWidth == 4) {
+					runSimdStep<inverse, signalsmith::perf::Float4>(data, step);
+				} else {
+					runStep<inverse>(data, step);
 				}
 			}
 		}
+#endif
+
+		template<bool inverse, typename InputIterator, typename OutputIterator>
+		void run(InputIterator &&input, OutputIterator &&data) {
+			// Only `std::complex<float>` pointers get the vectorised versions
+			using Output = typename std::decay<OutputIterator>::type;
+			using Input = typename std::decay<InputIterator>::type;
+			constexpr bool simdOutput = simdFloat && SIGNALSMITH_PERF_SIMD4 && std::is_same<Output, complex *>::value;
+			constexpr bool simdInput = simdOutput && (std::is_same<Input, complex *>::value || std::is_same<Input, const complex *>::value);
+
+			permute(input, data, std::integral_constant<bool, simdInput>{});
+			runSteps<inverse>(data, std::integral_constant<bool, simdOutput>{});
+		}
 
 		static bool validSize(size_t size) {
 			constexpr static bool filter[32] = {
@@ -367,10 +905,13 @@ namespace signalsmith { namespace fft {
 		}
 
 		size_t setSize(size_t size) {
-			if (size != _size) {
+			if (size != _size || !sharedPlan) {
 				_size = size;
-				workingVector.resize(size);
-				setPlan();
+				sharedPlan = getPlan(size);
+				// The only per-instance state: scratch for the generic steps
+				size_t maxFactor = 0;
+				for (size_t factor : sharedPlan->factors) maxFactor = std::max(maxFactor, factor);
+				workingVector.resize(maxFactor);
 			}
 			return _size;
 		}
@@ -380,6 +921,10 @@ namespace signalsmith { namespace fft {
 		size_t setFastSizeBelow(size_t size) {
 			return setSize(fastSizeBelow(size));
 		}
+		/// Allocates the per-instance scratch for any size up to this one (the plans themselves are shared)
+		void reserve(size_t maxSize) {
+			workingVector.reserve(maxSize);
+		}
 		const size_t & size() const {
 			return _size;
 		}
@@ -408,10 +953,184 @@ namespace signalsmith { namespace fft {
 		static constexpr bool modified = (optionFlags&FFTOptions::halfFreqShift);
 
 		using complex = std::complex<V>;
-		std::vector<complex> complexBuffer1, complexBuffer2;
-		std::vector<complex> twiddlesMinusI;
-		std::vector<complex> modifiedRotations;
+		signalsmith::perf::AlignedVector<complex> complexBuffer1, complexBuffer2;
 		FFT<V> complexFft;
+
+		// The rotations for a given size, shared between instances like `FFT`'s plans
+		struct Plan {
+			std::vector<complex> twiddlesMinusI;
+			std::vector<complex> modifiedRotations;
+			// Split copies of the above, for the SIMD passes
+			signalsmith::perf::AlignedVector<V> twiddlesMinusIReal, twiddlesMinusIImag;
+			signalsmith::perf::AlignedVector<V> modifiedRotationsReal, modifiedRotationsImag;
+
+			explicit Plan(size_t size) {
+				size_t hhSize = size/4 + 1;
+				twiddlesMinusI.resize(hhSize);
+				for (size_t i = 0; i < hhSize; ++i) {
+					V rotPhase = V(-2*M_PI*(modified ? i + 0.5 : i)/size);
+					twiddlesMinusI[i] = {std::sin(rotPhase), -std::cos(rotPhase)};
+				}
+				if (modified) {
+					modifiedRotations.resize(size/2);
+					for (size_t i = 0; i < size/2; ++i) {
+						V rotPhase = V(-2*M_PI*i/size);
+						modifiedRotations[i] = {std::cos(rotPhase), std::sin(rotPhase)};
+					}
+				}
+				twiddlesMinusIReal.resize(hhSize);
+				twiddlesMinusIImag.resize(hhSize);
+				for (size_t i = 0; i < hhSize; ++i) {
+					twiddlesMinusIReal[i] = twiddlesMinusI[i].real();
+					twiddlesMinusIImag[i] = twiddlesMinusI[i].imag();
+				}
+				modifiedRotationsReal.resize(modifiedRotations.size());
+				modifiedRotationsImag.resize(modifiedRotations.size());
+				for (size_t i = 0; i < modifiedRotations.size(); ++i) {
+					modifiedRotationsReal[i] = modifiedRotations[i].real();
+					modifiedRotationsImag[i] = modifiedRotations[i].imag();
+				}
+			}
+		};
+		std::shared_ptr<const Plan> sharedPlan;
+
+		static std::shared_ptr<const Plan> getPlan(size_t size) {
+			static std::mutex mutex;
+			static std::map<size_t, std::shared_ptr<const Plan>> plans;
+			std::lock_guard<std::mutex> lock(mutex);
+			std::shared_ptr<const Plan> &plan = plans[size];
+			if (!plan) plan = std::make_shared<const Plan>(size);
+			return plan;
+		}
+
+		// The vectorised pre/post passes only apply to `float` with contiguous input/output, otherwise this one is picked
+		template<typename Input, typename Output>
+		bool simdFft(const Input &, const Output &) {
+			return false;
+		}
+		bool simdFft(const float *input, std::complex<float> *output) {
+#if SIGNALSMITH_PERF_SIMD4
+			const Plan &plan = *sharedPlan;
+			using S = signalsmith::perf::Float4;
+			using Split = _fft_impl::SplitComplex<S>;
+			size_t hSize = complexFft.size();
+			complex *buffer1 = complexBuffer1.data(), *buffer2 = complexBuffer2.data();
+
+			size_t i = 0;
+			if (modified) {
+				for (; i + S::size <= hSize; i += S::size) {
+					Split v;
+					S::loadComplex(input + 2*i, v.real, v.imag);
+					_fft_impl::splitMul<false>(v, S::load(plan.modifiedRotationsReal.data() + i), S::load(plan.modifiedRotationsImag.data() + i)).store(buffer1 + i);
+				}
+				for (; i < hSize; ++i) {
+					buffer1[i] = _fft_impl::complexMul<false>({input[2*i], input[2*i + 1]}, plan.modifiedRotations[i]);
+				}
+			} else {
+				std::copy(input, input + 2*hSize, reinterpret_cast<float *>(buffer1));
+			}
+
+			complexFft.fft(buffer1, buffer2);
+
+			if (!modified) output[0] = {
+				buffer2[0].real() + buffer2[0].imag(),
+				buffer2[0].real() - buffer2[0].imag()
+			};
+			// Each vector pairs up with the mirrored one, read and written in reverse
+			const size_t conjBase = modified ? hSize - 1 : hSize;
+			const S half = S::splat(V(0.5));
+			for (i = modified ? 0 : 1; i + S::size - 1 <= hSize/2; i += S::size) {
+				Split a = Split::load(buffer2 + i);
+				Split b = Split::loadReversed(buffer2 + conjBase - i).conj();
+
+				Split odd = (a + b)*half;
+				Split evenI = (a - b)*half;
+				Split evenRotMinusI = _fft_impl::splitMul<false>(evenI, S::load(plan.twiddlesMinusIReal.data() + i), S::load(plan.twiddlesMinusIImag.data() + i));
+
+				(odd + evenRotMinusI).store(output + i);
+				(odd - evenRotMinusI).conj().storeReversed(output + conjBase - i);
+			}
+			for (; i <= hSize/2; ++i) {
+				size_t conjI = conjBase - i;
+
+				complex odd = (buffer2[i] + conj(buffer2[conjI]))*(V)0.5;
+				complex evenI = (buffer2[i] - conj(buffer2[conjI]))*(V)0.5;
+				complex evenRotMinusI = _fft_impl::complexMul<false>(evenI, plan.twiddlesMinusI[i]);
+
+				output[i] = odd + evenRotMinusI;
+				output[conjI] = conj(odd - evenRotMinusI);
+			}
+			return true;
+#else
+			(void)input;
+			(void)output;
+			return false;
+#endif
+		}
+
+		template<typename Input, typename Output>
+		bool simdIfft(const Input &, const Output &) {
+			return false;
+		}
+		bool simdIfft(const std::complex<float> *input, float *output) {
+#if SIGNALSMITH_PERF_SIMD4
+			const Plan &plan = *sharedPlan;
+			using S = signalsmith::perf::Float4;
+			using Split = _fft_impl::SplitComplex<S>;
+			size_t hSize = complexFft.size();
+			complex *buffer1 = complexBuffer1.data(), *buffer2 = complexBuffer2.data();
+
+			if (!modified) buffer1[0] = {
+				input[0].real() + input[0].imag(),
+				input[0].real() - input[0].imag()
+			};
+			const size_t conjBase = modified ? hSize - 1 : hSize;
+			size_t i = modified ? 0 : 1;
+			for (; i + S::size - 1 <= hSize/2; i += S::size) {
+				Split v = Split::load(input + i);
+				Split v2 = Split::loadReversed(input + conjBase - i).conj();
+
+				Split odd = v + v2;
+				Split evenRotMinusI = v - v2;
+				Split evenI = _fft_impl::splitMul<true>(evenRotMinusI, S::load(plan.twiddlesMinusIReal.data() + i), S::load(plan.twiddlesMinusIImag.data() + i));
+
+				(odd + evenI).store(buffer1 + i);
+				(odd - evenI).conj().storeReversed(buffer1 + conjBase - i);
+			}
+			for (; i <= hSize/2; ++i) {
+				size_t conjI = conjBase - i;
+				complex v = input[i], v2 = input[conjI];
+
+				complex odd = v + conj(v2);
+				complex evenRotMinusI = v - conj(v2);
+				complex evenI = _fft_impl::complexMul<true>(evenRotMinusI, plan.twiddlesMinusI[i]);
+
+				buffer1[i] = odd + evenI;
+				buffer1[conjI] = conj(odd - evenI);
+			}
+
+			complexFft.ifft(buffer1, buffer2);
+
+			if (modified) {
+				for (i = 0; i + S::size <= hSize; i += S::size) {
+					Split v = _fft_impl::splitMul<true>(Split::load(buffer2 + i), S::load(plan.modifiedRotationsReal.data() + i), S::load(plan.modifiedRotationsImag.data() + i));
+					S::storeComplex(output + 2*i, v.real, v.imag);
+				}
+				for (; i < hSize; ++i) {
+					complex v = _fft_impl::complexMul<true>(buffer2[i], plan.modifiedRotations[i]);
+					output[2*i] = v.real();
+					output[2*i + 1] = v.imag();
+				}
+			} else {
+				std::copy(reinterpret_cast<const float *>(buffer2), reinterpret_cast<const float *>(buffer2) + 2*hSize, output);
+			}
+			return true;
+#else
+			(void)input;
+			(void)output;
+			return false;
+#endif
+		}
 	public:
 		static size_t fastSizeAbove(size_t size) {
 			return FFT<V>::fastSizeAbove((size + 1)/2)*2;
@@ -429,21 +1148,7 @@ namespace signalsmith { namespace fft {
 		size_t setSize(size_t size) {
 			complexBuffer1.resize(size/2);
 			complexBuffer2.resize(size/2);
-
-			size_t hhSize = size/4 + 1;
-			twiddlesMinusI.resize(hhSize);
-			for (size_t i = 0; i < hhSize; ++i) {
-				V rotPhase = V(-2*M_PI*(modified ? i + 0.5 : i)/size);
-				twiddlesMinusI[i] = {std::sin(rotPhase), -std::cos(rotPhase)};
-			}
-			if (modified) {
-				modifiedRotations.resize(size/2);
-				for (size_t i = 0; i < size/2; ++i) {
-					V rotPhase = V(-2*M_PI*i/size);
-					modifiedRotations[i] = {std::cos(rotPhase), std::sin(rotPhase)};
-				}
-			}
-			
+			sharedPlan = getPlan(size);
 			return complexFft.setSize(size/2);
 		}
 		size_t setFastSizeAbove(size_t size) {
@@ -455,13 +1160,22 @@ namespace signalsmith { namespace fft {
 		size_t size() const {
 			return complexFft.size()*2;
 		}
+		/// Allocates enough for any later `.setSize()` up to this size
+		void reserve(size_t maxSize) {
+			complexBuffer1.reserve(maxSize/2);
+			complexBuffer2.reserve(maxSize/2);
+			complexFft.reserve(maxSize/2);
+		}
 
 		template<typename InputIterator, typename OutputIterator>
 		void fft(InputIterator &&input, OutputIterator &&output) {
+			if (simdFft(_fft_impl::contiguousConst(input), _fft_impl::contiguous(output))) return;
+
+			const Plan &plan = *sharedPlan;
 			size_t hSize = complexFft.size();
 			for (size_t i = 0; i < hSize; ++i) {
 				if (modified) {
-					complexBuffer1[i] = _fft_impl::complexMul<false>({input[2*i], input[2*i + 1]}, modifiedRotations[i]);
+					complexBuffer1[i] = _fft_impl::complexMul<false>({input[2*i], input[2*i + 1]}, plan.modifiedRotations[i]);
 				} else {
 					complexBuffer1[i] = {input[2*i], input[2*i + 1]};
 				}
@@ -478,7 +1192,7 @@ namespace signalsmith { namespace fft {
 				
 				complex odd = (complexBuffer2[i] + conj(complexBuffer2[conjI]))*(V)0.5;
 				complex evenI = (complexBuffer2[i] - conj(complexBuffer2[conjI]))*(V)0.5;
-				complex evenRotMinusI = _fft_impl::complexMul<false>(evenI, twiddlesMinusI[i]);
+				complex evenRotMinusI = _fft_impl::complexMul<false>(evenI, plan.twiddlesMinusI[i]);
 
 				output[i] = odd + evenRotMinusI;
 				output[conjI] = conj(odd - evenRotMinusI);
@@ -487,6 +1201,9 @@ namespace signalsmith { namespace fft {
 
 		template<typename InputIterator, typename OutputIterator>
 		void ifft(InputIterator &&input, OutputIterator &&output) {
+			if (simdIfft(_fft_impl::contiguousConst(input), _fft_impl::contiguous(output))) return;
+
+			const Plan &plan = *sharedPlan;
 			size_t hSize = complexFft.size();
 			if (!modified) complexBuffer1[0] = {
 				input[0].real() + input[0].imag(),
@@ -498,7 +1215,7 @@ namespace signalsmith { namespace fft {
 
 				complex odd = v + conj(v2);
 				complex evenRotMinusI = v - conj(v2);
-				complex evenI = _fft_impl::complexMul<true>(evenRotMinusI, twiddlesMinusI[i]);
+				complex evenI = _fft_impl::complexMul<true>(evenRotMinusI, plan.twiddlesMinusI[i]);
 				
 				complexBuffer1[i] = odd + evenI;
 				complexBuffer1[conjI] = conj(odd - evenI);
@@ -508,7 +1225,7 @@ namespace signalsmith { namespace fft {
 			
 			for (size_t i = 0; i < hSize; ++i) {
 				complex v = complexBuffer2[i];
-				if (modified) v = _fft_impl::complexMul<true>(v, modifiedRotations[i]);
+				if (modified) v = _fft_impl::complexMul<true>(v, plan.modifiedRotations[i]);
 				output[2*i] = v.real();
 				output[2*i + 1] = v.imag();
 			}
@@ -7,6 +7,8 @@
 
 #include <cmath>
 #include <complex>
+#include <atomic>
+#include <vector>
 
 namespace signalsmith {
 namespace filters {
@@ -241,6 +243,14 @@ namespace filters {
 		static constexpr double defaultQ = 0.7071067811865476; // sqrt(0.5)
 		static constexpr double defaultBandwidth = 1.8999686269529916; // equivalent to above Q
 
+		/// Normalised coefficients (`a0` = 1), e.g. for loading into a `BiquadBank`
+		struct Coefficients {
+			Sample b0, b1, b2, a1, a2;
+		};
+		Coefficients coefficients() const {
+			return {b0, b1, b2, a1, a2};
+		}
+
 		Sample operator ()(Sample x0) {
 			Sample y0 = x0*b0 + x1*b1 + x2*b2 - y1*a1 - y2*a2;
 			y2 = y1;
@@ -431,6 +441,115 @@ namespace filters {
 		}
 	};
 
+	/** @brief A bank of independent `float` biquads, one per SIMD lane
+
+		Runs in transposed direct form II, a whole vector of filters (4, or 8 with AVX2) at once, so the cost per filter doesn't grow with the count.  Samples are lane-interleaved: frame `i` of filter `f` lives at `data[i*stride() + f]`.
+
+		Coefficients are normally designed with `BiquadStatic` (see `.coefficients()`).  `.setCoefficients()` applies immediately, for the processing thread.  `.queueCoefficients()` can be called from any other thread (one at a time), without locking: they're picked up at the start of the next `.process()`.
+	*/
+	class BiquadBank {
+#if SIGNALSMITH_PERF_SIMD8
+		using Lanes = signalsmith::perf::Float8;
+#else
+		using Lanes = signalsmith::perf::Float4;
+#endif
+		static constexpr int width = Lanes::size;
+		int filters = 0, groups = 0;
+		// [group][b0, b1, b2, a1, a2][lane]
+		signalsmith::perf::AlignedVector<float> coeffs, stagingCoeffs, pendingCoeffs;
+		// [group][s1, s2][lane]
+		signalsmith::perf::AlignedVector<float> state;
+		// Seqlock around `pendingCoeffs`: odd while a write is in progress
+		std::atomic<unsigned> pendingSequence{0};
+		unsigned appliedSequence = 0;
+
+		static void writeCoefficients(signalsmith::perf::AlignedVector<float> &target, int filter, float b0, float b1, float b2, float a1, float a2) {
+			float *group = target.data() + (filter/width)*5*width + filter%width;
+			group[0] = b0;
+			group[width] = b1;
+			group[width*2] = b2;
+			group[width*3] = a1;
+			group[width*4] = a2;
+		}
+
+		void applyPending() {
+			unsigned sequence = pendingSequence.load(std::memory_order_acquire);
+			if (sequence == appliedSequence || (sequence&1)) return;
+			stagingCoeffs = pendingCoeffs; // same size, so this doesn't allocate
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (pendingSequence.load(std::memory_order_relaxed) != sequence) return; // torn, try again next block
+			std::swap(coeffs, stagingCoeffs);
+			appliedSequence = sequence;
+		}
+	public:
+		BiquadBank(int filterCount=0) {
+			resize(filterCount);
+		}
+
+		/// Sets the number of filters, all passing signal through unchanged
+		void resize(int filterCount) {
+			filters = filterCount;
+			groups = (filterCount + width - 1)/width;
+			coeffs.assign(groups*5*width, 0);
+			for (int f = 0; f < groups*width; ++f) {
+				writeCoefficients(coeffs, f, 1, 0, 0, 0, 0);
+			}
+			stagingCoeffs = coeffs;
+			pendingCoeffs = coeffs;
+			pendingSequence = 0;
+			appliedSequence = 0;
+			state.assign(groups*2*width, 0);
+		}
+		void reset() {
+			state.assign(state.size(), 0);
+		}
+
+		int size() const {
+			return filters;
+		}
+		/// Floats per frame in the lane-interleaved data (the filter count, rounded up to a whole vector)
+		int stride() const {
+			return groups*width;
+		}
+
+		template<class Coefficients>
+		void setCoefficients(int filter, const Coefficients &c) {
+			writeCoefficients(coeffs, filter, float(c.b0), float(c.b1), float(c.b2), float(c.a1), float(c.a2));
+		}
+		template<class Coefficients>
+		void queueCoefficients(int filter, const Coefficients &c) {
+			unsigned sequence = pendingSequence.load(std::memory_order_relaxed);
+			pendingSequence.store(sequence + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			writeCoefficients(pendingCoeffs, filter, float(c.b0), float(c.b1), float(c.b2), float(c.a1), float(c.a2));
+			pendingSequence.store(sequence + 2, std::memory_order_release);
+		}
+
+		/// Filters lane-interleaved `data` in place
+		void process(float *data, int frames) {
+			applyPending();
+			for (int g = 0; g < groups; ++g) {
+				const float *groupCoeffs = coeffs.data() + g*5*width;
+				Lanes b0 = Lanes::load(groupCoeffs), b1 = Lanes::load(groupCoeffs + width), b2 = Lanes::load(groupCoeffs + width*2);
+				Lanes a1 = Lanes::load(groupCoeffs + width*3), a2 = Lanes::load(groupCoeffs + width*4);
+				float *groupState = state.data() + g*2*width;
+				Lanes s1 = Lanes::load(groupState), s2 = Lanes::load(groupState + width);
+
+				float *samples = data + g*width;
+				for (int i = 0; i < frames; ++i) {
+					Lanes x = Lanes::load(samples);
+					Lanes y = b0*x + s1;
+					s1 = b1*x - a1*y + s2;
+					s2 = b2*x - a2*y;
+					y.store(samples);
+					samples += stride();
+				}
+				s1.store(groupState);
+				s2.store(groupState + width);
+			}
+		}
+	};
+
 	/** @} */
 }} // signalsmith::filters::
 #endif // include guard
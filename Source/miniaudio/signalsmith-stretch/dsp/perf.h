@@ -4,11 +4,24 @@
 #define SIGNALSMITH_DSP_PERF_H
 
 #include <complex>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
 
 #if defined(__SSE__) || defined(_M_X64)
 #	include <xmmintrin.h>
+#	if defined(__AVX2__) || defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#		include <immintrin.h> // AVX2 for `Float8`, even when it's only used after a runtime check
+#	endif
+#	if defined(_MSC_VER)
+#		include <intrin.h>
+#	endif
 #else
 #	include <cstdint> // for uintptr_t
+#	if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#		include <arm_neon.h>
+#	endif
 #endif
 
 namespace signalsmith {
@@ -45,6 +58,383 @@ namespace perf {
 		};
 	}
 
+	/// Sum of squares (energy) of a buffer
+	SIGNALSMITH_INLINE static float sumSquares(const float *data, int count) {
+		int i = 0;
+#if defined(__SSE__) || defined(_M_X64)
+		__m128 sum0 = _mm_setzero_ps(), sum1 = _mm_setzero_ps();
+		for (; i + 8 <= count; i += 8) {
+			__m128 a = _mm_loadu_ps(data + i), b = _mm_loadu_ps(data + i + 4);
+			sum0 = _mm_add_ps(sum0, _mm_mul_ps(a, a));
+			sum1 = _mm_add_ps(sum1, _mm_mul_ps(b, b));
+		}
+		alignas(16) float lanes[4];
+		_mm_store_ps(lanes, _mm_add_ps(sum0, sum1));
+		float sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif (defined (__ARM_NEON) || defined (__ARM_NEON__))
+		float32x4_t sum0 = vdupq_n_f32(0), sum1 = vdupq_n_f32(0);
+		for (; i + 8 <= count; i += 8) {
+			float32x4_t a = vld1q_f32(data + i), b = vld1q_f32(data + i + 4);
+			sum0 = vmlaq_f32(sum0, a, a);
+			sum1 = vmlaq_f32(sum1, b, b);
+		}
+		float32x4_t lanes = vaddq_f32(sum0, sum1);
+		float sum = (vgetq_lane_f32(lanes, 0) + vgetq_lane_f32(lanes, 1)) + (vgetq_lane_f32(lanes, 2) + vgetq_lane_f32(lanes, 3));
+#else
+		float sum = 0;
+#endif
+		for (; i < count; ++i) {
+			sum += data[i]*data[i];
+		}
+		return sum;
+	}
+
+	/** @brief Splits interleaved samples into one buffer per channel
+		Stereo has a vectorised path, other channel counts are a plain strided copy.
+	*/
+	SIGNALSMITH_INLINE static void deinterleave(const float *interleaved, float * const *planar, int channels, int frames) {
+		if (channels != 2) {
+			for (int c = 0; c < channels; ++c) {
+				float *channel = planar[c];
+				for (int i = 0; i < frames; ++i) {
+					channel[i] = interleaved[i*channels + c];
+				}
+			}
+			return;
+		}
+		float *left = planar[0], *right = planar[1];
+		int i = 0;
+#if defined(__SSE__) || defined(_M_X64)
+		for (; i + 4 <= frames; i += 4) {
+			__m128 a = _mm_loadu_ps(interleaved + 2*i); // L0 R0 L1 R1
+			__m128 b = _mm_loadu_ps(interleaved + 2*i + 4); // L2 R2 L3 R3
+			_mm_storeu_ps(left + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+			_mm_storeu_ps(right + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+		}
+#elif (defined (__ARM_NEON) || defined (__ARM_NEON__))
+		for (; i + 4 <= frames; i += 4) {
+			float32x4x2_t lr = vld2q_f32(interleaved + 2*i);
+			vst1q_f32(left + i, lr.val[0]);
+			vst1q_f32(right + i, lr.val[1]);
+		}
+#endif
+		for (; i < frames; ++i) {
+			left[i] = interleaved[2*i];
+			right[i] = interleaved[2*i + 1];
+		}
+	}
+
+	/// The inverse of `deinterleave()`
+	SIGNALSMITH_INLINE static void interleave(const float * const *planar, float *interleaved, int channels, int frames) {
+		if (channels != 2) {
+			for (int c = 0; c < channels; ++c) {
+				const float *channel = planar[c];
+				for (int i = 0; i < frames; ++i) {
+					interleaved[i*channels + c] = channel[i];
+				}
+			}
+			return;
+		}
+		const float *left = planar[0], *right = planar[1];
+		int i = 0;
+#if defined(__SSE__) || defined(_M_X64)
+		for (; i + 4 <= frames; i += 4) {
+			__m128 l = _mm_loadu_ps(left + i), r = _mm_loadu_ps(right + i);
+			_mm_storeu_ps(interleaved + 2*i, _mm_unpacklo_ps(l, r));
+			_mm_storeu_ps(interleaved + 2*i + 4, _mm_unpackhi_ps(l, r));
+		}
+#elif (defined (__ARM_NEON) || defined (__ARM_NEON__))
+		for (; i + 4 <= frames; i += 4) {
+			float32x4x2_t lr;
+			lr.val[0] = vld1q_f32(left + i);
+			lr.val[1] = vld1q_f32(right + i);
+			vst2q_f32(interleaved + 2*i, lr);
+		}
+#endif
+		for (; i < frames; ++i) {
+			interleaved[2*i] = left[i];
+			interleaved[2*i + 1] = right[i];
+		}
+	}
+
+	/** @brief Small fixed-width float vectors, for writing a kernel once and instantiating it per instruction set
+		`Float4` is SSE or NEON (or a plain array elsewhere, with `SIGNALSMITH_PERF_SIMD4` set to 0).  `Float8` is AVX2.  When the compiler targets AVX2 (`SIGNALSMITH_PERF_SIMD8`) it can be used anywhere, otherwise on x86 it still exists (`SIGNALSMITH_PERF_RUNTIME8`) for code which checks `hasFloat8()` first and is compiled with `SIGNALSMITH_PERF_FLOAT8_FUNCTION`.
+
+		`loadComplex()`/`storeComplex()` convert between `size` interleaved complex numbers and separate real/imaginary vectors.
+	*/
+#if defined(__SSE__) || defined(_M_X64)
+#	define SIGNALSMITH_PERF_SIMD4 1
+	struct Float4 {
+		static constexpr int size = 4;
+		__m128 v;
+
+		SIGNALSMITH_INLINE static Float4 load(const float *p) {
+			return {_mm_loadu_ps(p)};
+		}
+		SIGNALSMITH_INLINE void store(float *p) const {
+			_mm_storeu_ps(p, v);
+		}
+		SIGNALSMITH_INLINE static Float4 splat(float x) {
+			return {_mm_set1_ps(x)};
+		}
+		// Two pairs of floats (e.g. complex numbers) from separate places
+		SIGNALSMITH_INLINE static Float4 loadPair(const float *a, const float *b) {
+			return {_mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64 *>(a)), reinterpret_cast<const __m64 *>(b))};
+		}
+		SIGNALSMITH_INLINE Float4 reversed() const {
+			return {_mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 1, 2, 3))};
+		}
+		SIGNALSMITH_INLINE static void loadComplex(const float *p, Float4 &re, Float4 &im) {
+			__m128 a = _mm_loadu_ps(p), b = _mm_loadu_ps(p + 4);
+			re.v = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+			im.v = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+		}
+		SIGNALSMITH_INLINE static void storeComplex(float *p, const Float4 &re, const Float4 &im) {
+			_mm_storeu_ps(p, _mm_unpacklo_ps(re.v, im.v));
+			_mm_storeu_ps(p + 4, _mm_unpackhi_ps(re.v, im.v));
+		}
+		friend SIGNALSMITH_INLINE Float4 operator+(Float4 a, Float4 b) {
+			return {_mm_add_ps(a.v, b.v)};
+		}
+		friend SIGNALSMITH_INLINE Float4 operator-(Float4 a, Float4 b) {
+			return {_mm_sub_ps(a.v, b.v)};
+		}
+		friend SIGNALSMITH_INLINE Float4 operator*(Float4 a, Float4 b) {
+			return {_mm_mul_ps(a.v, b.v)};
+		}
+	};
+#elif (defined (__ARM_NEON) || defined (__ARM_NEON__))
+#	define SIGNALSMITH_PERF_SIMD4 1
+	struct Float4 {
+		static constexpr int size = 4;
+		float32x4_t v;
+
+		SIGNALSMITH_INLINE static Float4 load(const float *p) {
+			return {vld1q_f32(p)};
+		}
+		SIGNALSMITH_INLINE void store(float *p) const {
+			vst1q_f32(p, v);
+		}
+		SIGNALSMITH_INLINE static Float4 splat(float x) {
+			return {vdupq_n_f32(x)};
+		}
+		SIGNALSMITH_INLINE static Float4 loadPair(const float *a, const float *b) {
+			return {vcombine_f32(vld1_f32(a), vld1_f32(b))};
+		}
+		SIGNALSMITH_INLINE Float4 reversed() const {
+			float32x4_t pairsSwapped = vrev64q_f32(v);
+			return {vcombine_f32(vget_high_f32(pairsSwapped), vget_low_f32(pairsSwapped))};
+		}
+		SIGNALSMITH_INLINE static void loadComplex(const float *p, Float4 &re, Float4 &im) {
+			float32x4x2_t split = vld2q_f32(p);
+			re.v = split.val[0];
+			im.v = split.val[1];
+		}
+		SIGNALSMITH_INLINE static void storeComplex(float *p, const Float4 &re, const Float4 &im) {
+			float32x4x2_t split;
+			split.val[0] = re.v;
+			split.val[1] = im.v;
+			vst2q_f32(p, split);
+		}
+		friend SIGNALSMITH_INLINE Float4 operator+(Float4 a, Float4 b) {
+			return {vaddq_f32(a.v, b.v)};
+		}
+		friend SIGNALSMITH_INLINE Float4 operator-(Float4 a, Float4 b) {
+			return {vsubq_f32(a.v, b.v)};
+		}
+		friend SIGNALSMITH_INLINE Float4 operator*(Float4 a, Float4 b) {
+			return {vmulq_f32(a.v, b.v)};
+		}
+	};
+#else
+#	define SIGNALSMITH_PERF_SIMD4 0
+	struct Float4 {
+		static constexpr int size = 4;
+		float v[4];
+
+		SIGNALSMITH_INLINE static Float4 load(const float *p) {
+			return {{p[0], p[1], p[2], p[3]}};
+		}
+		SIGNALSMITH_INLINE void store(float *p) const {
+			for (int i = 0; i < 4; ++i) p[i] = v[i];
+		}
+		SIGNALSMITH_INLINE static Float4 splat(float x) {
+			return {{x, x, x, x}};
+		}
+		SIGNALSMITH_INLINE static Float4 loadPair(const float *a, const float *b) {
+			return {{a[0], a[1], b[0], b[1]}};
+		}
+		SIGNALSMITH_INLINE Float4 reversed() const {
+			return {{v[3], v[2], v[1], v[0]}};
+		}
+		SIGNALSMITH_INLINE static void loadComplex(const float *p, Float4 &re, Float4 &im) {
+			for (int i = 0; i < 4; ++i) {
+				re.v[i] = p[2*i];
+				im.v[i] = p[2*i + 1];
+			}
+		}
+		SIGNALSMITH_INLINE static void storeComplex(float *p, const Float4 &re, const Float4 &im) {
+			for (int i = 0; i < 4; ++i) {
+				p[2*i] = re.v[i];
+				p[2*i + 1] = im.v[i];
+			}
+		}
+		friend SIGNALSMITH_INLINE Float4 operator+(Float4 a, Float4 b) {
+			return {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}};
+		}
+		friend SIGNALSMITH_INLINE Float4 operator-(Float4 a, Float4 b) {
+			return {{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]}};
+		}
+		friend SIGNALSMITH_INLINE Float4 operator*(Float4 a, Float4 b) {
+			return {{a.v[0]*b.v[0], a.v[1]*b.v[1], a.v[2]*b.v[2], a.v[3]*b.v[3]}};
+		}
+	};
+#endif
+
+#if defined(__AVX2__)
+#	define SIGNALSMITH_PERF_SIMD8 1
+#	define SIGNALSMITH_PERF_RUNTIME8 0
+#	define SIGNALSMITH_PERF_FLOAT8_INLINE SIGNALSMITH_INLINE
+#	define SIGNALSMITH_PERF_FLOAT8_FUNCTION
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__SSE__) && (defined(__x86_64__) || defined(__i386__))
+#	define SIGNALSMITH_PERF_SIMD8 0
+#	define SIGNALSMITH_PERF_RUNTIME8 1
+	// GCC/Clang won't inline AVX2 code into a function which isn't compiled for it, so the methods are only `inline`, and whatever uses them is compiled for AVX2 with everything it calls pulled in (`flatten`)
+#	define SIGNALSMITH_PERF_FLOAT8_INLINE __attribute__((target("avx2"))) inline
+#	define SIGNALSMITH_PERF_FLOAT8_FUNCTION __attribute__((target("avx2"), flatten, noinline))
+#elif defined(_M_X64) && !defined(__clang__)
+#	define SIGNALSMITH_PERF_SIMD8 0
+#	define SIGNALSMITH_PERF_RUNTIME8 1
+	// MSVC emits any intrinsic in any function
+#	define SIGNALSMITH_PERF_FLOAT8_INLINE SIGNALSMITH_INLINE
+#	define SIGNALSMITH_PERF_FLOAT8_FUNCTION
+#else
+#	define SIGNALSMITH_PERF_SIMD8 0
+#	define SIGNALSMITH_PERF_RUNTIME8 0
+#endif
+
+#if SIGNALSMITH_PERF_SIMD8 || SIGNALSMITH_PERF_RUNTIME8
+	struct Float8 {
+		static constexpr int size = 8;
+		__m256 v;
+
+		SIGNALSMITH_PERF_FLOAT8_INLINE static Float8 load(const float *p) {
+			return {_mm256_loadu_ps(p)};
+		}
+		SIGNALSMITH_PERF_FLOAT8_INLINE void store(float *p) const {
+			_mm256_storeu_ps(p, v);
+		}
+		SIGNALSMITH_PERF_FLOAT8_INLINE static Float8 splat(float x) {
+			return {_mm256_set1_ps(x)};
+		}
+		SIGNALSMITH_PERF_FLOAT8_INLINE Float8 reversed() const {
+			return {_mm256_permutevar8x32_ps(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0))};
+		}
+		SIGNALSMITH_PERF_FLOAT8_INLINE static void loadComplex(const float *p, Float8 &re, Float8 &im) {
+			__m256 a = _mm256_loadu_ps(p), b = _mm256_loadu_ps(p + 8);
+			// Shuffles work within 128-bit lanes, so this gives [0 1 4 5 | 2 3 6 7], then we fix the order
+			__m256 reLanes = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+			__m256 imLanes = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+			re.v = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(reLanes), _MM_SHUFFLE(3, 1, 2, 0)));
+			im.v = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(imLanes), _MM_SHUFFLE(3, 1, 2, 0)));
+		}
+		SIGNALSMITH_PERF_FLOAT8_INLINE static void storeComplex(float *p, const Float8 &re, const Float8 &im) {
+			__m256 low = _mm256_unpacklo_ps(re.v, im.v), high = _mm256_unpackhi_ps(re.v, im.v); // [0 1 | 4 5], [2 3 | 6 7]
+			_mm256_storeu_ps(p, _mm256_permute2f128_ps(low, high, 0x20));
+			_mm256_storeu_ps(p + 8, _mm256_permute2f128_ps(low, high, 0x31));
+		}
+		friend SIGNALSMITH_PERF_FLOAT8_INLINE Float8 operator+(Float8 a, Float8 b) {
+			return {_mm256_add_ps(a.v, b.v)};
+		}
+		friend SIGNALSMITH_PERF_FLOAT8_INLINE Float8 operator-(Float8 a, Float8 b) {
+			return {_mm256_sub_ps(a.v, b.v)};
+		}
+		friend SIGNALSMITH_PERF_FLOAT8_INLINE Float8 operator*(Float8 a, Float8 b) {
+			return {_mm256_mul_ps(a.v, b.v)};
+		}
+	};
+#endif
+
+	/// Whether `Float8` code can run on this CPU, checked once
+	inline bool hasFloat8() {
+#if SIGNALSMITH_PERF_SIMD8
+		return true;
+#elif SIGNALSMITH_PERF_RUNTIME8 && defined(_MSC_VER)
+		static const bool supported = []() {
+			int info[4];
+			__cpuid(info, 0);
+			if (info[0] < 7) return false;
+			__cpuid(info, 1);
+			bool osSavesAvx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+			if (!osSavesAvx) return false;
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 5)) != 0;
+		}();
+		return supported;
+#elif SIGNALSMITH_PERF_RUNTIME8
+		static const bool supported = __builtin_cpu_supports("avx2");
+		return supported;
+#else
+		return false;
+#endif
+	}
+
+	/// Element-wise product: `output[i] = a[i]*b[i]`
+	template<typename V>
+	SIGNALSMITH_INLINE static void multiply(const V *a, const V *b, V *output, int count) {
+		for (int i = 0; i < count; ++i) output[i] = a[i]*b[i];
+	}
+	SIGNALSMITH_INLINE static void multiply(const float *a, const float *b, float *output, int count) {
+		int i = 0;
+		for (; i + Float4::size <= count; i += Float4::size) {
+			(Float4::load(a + i)*Float4::load(b + i)).store(output + i);
+		}
+		for (; i < count; ++i) output[i] = a[i]*b[i];
+	}
+	/// Element-wise product, added to the output: `output[i] += a[i]*b[i]`
+	template<typename V>
+	SIGNALSMITH_INLINE static void multiplyAdd(const V *a, const V *b, V *output, int count) {
+		for (int i = 0; i < count; ++i) output[i] += a[i]*b[i];
+	}
+	SIGNALSMITH_INLINE static void multiplyAdd(const float *a, const float *b, float *output, int count) {
+		int i = 0;
+		for (; i + Float4::size <= count; i += Float4::size) {
+			(Float4::load(output + i) + Float4::load(a + i)*Float4::load(b + i)).store(output + i);
+		}
+		for (; i < count; ++i) output[i] += a[i]*b[i];
+	}
+	/// Dot product: `sum(a[i]*b[i])`
+	template<typename V>
+	SIGNALSMITH_INLINE static V dot(const V *a, const V *b, int count) {
+		V sum = 0;
+		for (int i = 0; i < count; ++i) sum += a[i]*b[i];
+		return sum;
+	}
+	SIGNALSMITH_INLINE static float dot(const float *a, const float *b, int count) {
+#if SIGNALSMITH_PERF_SIMD8
+		using Vector = Float8;
+#else
+		using Vector = Float4;
+#endif
+		constexpr int width = Vector::size;
+		int i = 0;
+		// Two accumulators, so consecutive multiply-adds don't wait on each other
+		Vector sum0 = Vector::splat(0), sum1 = Vector::splat(0);
+		for (; i + 2*width <= count; i += 2*width) {
+			sum0 = sum0 + Vector::load(a + i)*Vector::load(b + i);
+			sum1 = sum1 + Vector::load(a + i + width)*Vector::load(b + i + width);
+		}
+		for (; i + width <= count; i += width) {
+			sum0 = sum0 + Vector::load(a + i)*Vector::load(b + i);
+		}
+		float lanes[width];
+		(sum0 + sum1).store(lanes);
+		float sum = 0;
+		for (int l = 0; l < width; ++l) sum += lanes[l];
+		for (; i < count; ++i) sum += a[i]*b[i];
+		return sum;
+	}
+
 #if defined(__SSE__) || defined(_M_X64)
 	class StopDenormals {
 		unsigned int controlStatusRegister;
@@ -78,6 +468,60 @@ namespace perf {
 	class StopDenormals {}; // FIXME: add for other architectures
 #endif
 
+	namespace _perf_impl {
+		inline std::atomic<size_t> & allocationCounter() {
+			static std::atomic<size_t> counter{0};
+			return counter;
+		}
+	}
+	/// Number of allocations made through `AlignedAllocator` so far, process-wide.  Compare before/after processing to check it doesn't allocate.
+	inline size_t allocationCount() {
+		return _perf_impl::allocationCounter().load(std::memory_order_relaxed);
+	}
+
+	/** @brief Standard allocator which aligns storage to (by default) a cache line
+		This keeps SIMD loads from straddling cache lines, and keeps two buffers from sharing one.  Every allocation is counted (see `allocationCount()`).
+	*/
+	template<typename T, size_t alignment=64>
+	struct AlignedAllocator {
+		static_assert((alignment&(alignment - 1)) == 0 && alignment >= sizeof(void *), "alignment must be a power of 2, at least pointer-sized");
+		using value_type = T;
+		template<typename U>
+		struct rebind {
+			using other = AlignedAllocator<U, alignment>;
+		};
+
+		AlignedAllocator() noexcept {}
+		template<typename U>
+		AlignedAllocator(const AlignedAllocator<U, alignment> &) noexcept {}
+
+		T * allocate(size_t n) {
+			_perf_impl::allocationCounter().fetch_add(1, std::memory_order_relaxed);
+			// Over-allocate, and keep the original pointer just before the aligned block
+			void *raw = std::malloc(n*sizeof(T) + alignment + sizeof(void *));
+			if (!raw) throw std::bad_alloc();
+			size_t aligned = (reinterpret_cast<size_t>(raw) + sizeof(void *) + alignment - 1)&~(alignment - 1);
+			reinterpret_cast<void **>(aligned)[-1] = raw;
+			return reinterpret_cast<T *>(aligned);
+		}
+		void deallocate(T *ptr, size_t) noexcept {
+			if (ptr) std::free(reinterpret_cast<void **>(ptr)[-1]);
+		}
+
+		template<typename U>
+		bool operator ==(const AlignedAllocator<U, alignment> &) const noexcept {
+			return true;
+		}
+		template<typename U>
+		bool operator !=(const AlignedAllocator<U, alignment> &) const noexcept {
+			return false;
+		}
+	};
+
+	/// `std::vector` with cache-aligned storage
+	template<typename T>
+	using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
 /** @} */
 }} // signalsmith::perf::
 
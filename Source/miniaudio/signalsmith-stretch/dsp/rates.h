@@ -5,6 +5,15 @@
 
 #include "./windows.h"
 #include "./delay.h"
+#include "./perf.h"
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
 
 namespace signalsmith {
 namespace rates {
@@ -179,6 +188,234 @@ namespace rates {
 		std::vector<Sample> buffer;
 	};
 
+	/** @brief Arbitrary-ratio streaming resampler, using a polyphase Kaiser-windowed sinc.
+
+		The kernel is tabulated at `phases` sub-sample offsets.  For each output frame it's linearly interpolated between the two nearest phases once, and then every channel is a single SIMD dot product (see `perf::dot()`).  The table for every cutoff `.setRatio()` can pick is built by the first `.resize()` with a given shape and shared between instances, like FFT plans, so changing the ratio never allocates or locks.
+
+		The ratio is input frames per output frame: 2 plays an octave up as varispeed, or converts 88.2kHz to 44.1kHz.  Above 1 the cutoff follows the ratio down, so nothing aliases.  The position is fixed-point, so `.inputFor()` agrees exactly with what `.process()` consumes.
+		\code{.cpp}
+			resampler.resize(channels, maxInputBlock);
+			resampler.setRatio(1.5);
+			// Pull: ask how much input the next block needs
+			int inputFrames = resampler.inputFor(outputFrames);
+			resampler.process(inputBuffers, inputFrames, outputBuffers, outputFrames);
+		\endcode
+		For push-style use (e.g. as a miniaudio resampling backend), `.processInterleaved()` takes whatever input it's given and produces as much output as it can.
+
+		Output frame 0 lines up with input frame 0, which means the resampler holds back `.latency()` input frames until it sees what comes after them.
+	*/
+	template<typename Sample>
+	class PolyphaseResampler {
+		struct Kernel {
+			int taps, phases;
+			// `phases + 1` rows of `taps` coefficients, row `p` is for a fractional position of `p/phases`
+			signalsmith::perf::AlignedVector<Sample> rows;
+			// `deltas[p] = rows[p + 1] - rows[p]`
+			signalsmith::perf::AlignedVector<Sample> deltas;
+
+			Kernel(int taps, int phases, double bandwidth) : taps(taps), phases(phases), rows((phases + 1)*taps), deltas(phases*taps) {
+				// Stop-band starts at `bandwidth` (relative to the input Nyquist), ~70dB down
+				constexpr double stopDb = 70;
+				double beta = 0.1102*(stopDb - 8.7);
+				double transition = (stopDb - 8)/(2.285*2*M_PI*(taps - 1)); // fraction of the sample-rate
+				double cutoff = std::max(0.05, 0.5*bandwidth - transition*0.5); // centre of the transition band
+				signalsmith::windows::Kaiser kaiser(beta);
+				int centre = taps/2 - 1;
+				for (int p = 0; p <= phases; ++p) {
+					Sample *row = rows.data() + p*taps;
+					double sum = 0;
+					for (int k = 0; k < taps; ++k) {
+						double x = k - centre - double(p)/phases;
+						double px = 2*M_PI*cutoff*x;
+						double sinc = (std::abs(px) > 1e-9) ? std::sin(px)/px : 1;
+						double unit = std::min(1.0, std::max(0.0, (x + taps*0.5)/taps));
+						double v = sinc*kaiser(unit);
+						row[k] = Sample(v);
+						sum += v;
+					}
+					// Exact unity gain at DC, for every phase
+					for (int k = 0; k < taps; ++k) row[k] = Sample(row[k]/sum);
+				}
+				for (int i = 0; i < phases*taps; ++i) {
+					deltas[i] = rows[i + taps] - rows[i];
+				}
+			}
+		};
+		// The bandwidth is quantised to steps of 1/32 (rounding the cutoff down), so nearby ratios share a table
+		static constexpr int bandwidthSteps = 32;
+		struct KernelSet {
+			// `kernels[k - 1]` has a bandwidth of `k/bandwidthSteps`
+			std::vector<std::unique_ptr<const Kernel>> kernels;
+
+			KernelSet(int taps, int phases) {
+				for (int k = 1; k <= bandwidthSteps; ++k) {
+					kernels.emplace_back(new Kernel(taps, phases, double(k)/bandwidthSteps));
+				}
+			}
+		};
+		static std::shared_ptr<const KernelSet> getKernelSet(int taps, int phases) {
+			static std::mutex mutex;
+			static std::map<std::tuple<int, int>, std::shared_ptr<const KernelSet>> cache;
+			std::lock_guard<std::mutex> lock(mutex);
+			auto &kernelSet = cache[std::make_tuple(taps, phases)];
+			if (!kernelSet) kernelSet = std::make_shared<const KernelSet>(taps, phases);
+			return kernelSet;
+		}
+
+		static constexpr int fractionBits = 32;
+		static constexpr uint64_t fractionMask = (uint64_t(1) << fractionBits) - 1;
+
+		int channels = 0, taps = 0, phases = 0, bufferStride = 0;
+		int filled = 0;
+		uint64_t position = 0, step = uint64_t(1) << fractionBits;
+		double currentRatio = 1;
+		std::shared_ptr<const KernelSet> kernelSet; // Owns what `kernel` points at
+		const Kernel *kernel = nullptr;
+		signalsmith::perf::AlignedVector<Sample> buffer, coefficients;
+
+		// Interpolates the kernel for the current position into `coefficients`
+		SIGNALSMITH_INLINE const Sample * currentCoefficients() {
+			double phase = double(position&fractionMask)*(phases/double(uint64_t(1) << fractionBits));
+			int row = int(phase);
+			Sample t = Sample(phase - row);
+			const Sample *rowCoeffs = kernel->rows.data() + row*taps, *rowDeltas = kernel->deltas.data() + row*taps;
+			Sample *result = coefficients.data();
+			for (int k = 0; k < taps; ++k) result[k] = rowCoeffs[k] + rowDeltas[k]*t;
+			return result;
+		}
+		bool canOutput() const {
+			return int(position >> fractionBits) + taps <= filled;
+		}
+		void discardUsedInput() {
+			int drop = std::min<int>(int(position >> fractionBits), filled);
+			if (drop <= 0) return;
+			for (int c = 0; c < channels; ++c) {
+				Sample *channel = buffer.data() + c*bufferStride;
+				std::memmove(channel, channel + drop, sizeof(Sample)*(filled - drop));
+			}
+			filled -= drop;
+			position -= uint64_t(drop) << fractionBits;
+		}
+	public:
+		PolyphaseResampler() {}
+		PolyphaseResampler(int channels, int maxInputBlock, int taps=64, int phases=128) {
+			resize(channels, maxInputBlock, taps, phases);
+		}
+
+		/// `taps` is rounded up to a multiple of 8, for the dot products
+		void resize(int nChannels, int maxInputBlock, int nTaps=64, int nPhases=128) {
+			channels = nChannels;
+			taps = std::max(8, (nTaps + 7)/8*8);
+			phases = std::max(1, nPhases);
+			bufferStride = taps + std::max(1, maxInputBlock);
+			buffer.assign(channels*bufferStride, 0);
+			coefficients.assign(taps, 0);
+			kernelSet = getKernelSet(taps, phases);
+			setRatio(currentRatio);
+			reset();
+		}
+		void reset() {
+			buffer.assign(buffer.size(), 0);
+			filled = taps/2 - 1; // silence before the first input frame, so output frame 0 lands on it
+			position = 0;
+		}
+
+		/// Input frames held back waiting for the following ones
+		int latency() const {
+			return taps/2;
+		}
+		int maxInputBlock() const {
+			return bufferStride - taps;
+		}
+
+		/// Input frames per output frame. Can change at any point in the stream, and is real-time safe: the tables were all built in `.resize()`.
+		void setRatio(double ratio) {
+			currentRatio = ratio;
+			step = uint64_t(std::llround(ratio*double(uint64_t(1) << fractionBits)));
+			if (step == 0) step = 1;
+			int bandwidth = ratio > 1 ? std::max(1, int(std::floor(bandwidthSteps/ratio))) : bandwidthSteps;
+			kernel = kernelSet ? kernelSet->kernels[bandwidth - 1].get() : nullptr;
+		}
+		double ratio() const {
+			return currentRatio;
+		}
+
+		/// How many input frames the next `.process()` call needs to produce `outputFrames`
+		int inputFor(int outputFrames) const {
+			if (outputFrames <= 0) return 0;
+			uint64_t last = position + uint64_t(outputFrames - 1)*step;
+			int needed = int(last >> fractionBits) + taps - filled;
+			return std::max(needed, 0);
+		}
+
+		/// How many output frames `inputFrames` more input would allow (the inverse of `.inputFor()`)
+		int outputFor(int inputFrames) const {
+			int64_t lastIndex = int64_t(filled) + inputFrames - taps;
+			if (lastIndex < int64_t(position >> fractionBits)) return 0;
+			return int(((uint64_t(lastIndex) << fractionBits) - position)/step) + 1;
+		}
+
+		/// Pull-style, planar: `input[c][i]` and `output[c][i]`.  If given less input than `.inputFor()` asked for, the missing output is silent.
+		template<class InputData, class OutputData>
+		void process(InputData &&input, int inputFrames, OutputData &&output, int outputFrames) {
+			inputFrames = std::min(inputFrames, bufferStride - filled);
+			for (int c = 0; c < channels; ++c) {
+				Sample *channel = buffer.data() + c*bufferStride + filled;
+				auto &&inputChannel = input[c];
+				for (int i = 0; i < inputFrames; ++i) channel[i] = inputChannel[i];
+			}
+			filled += inputFrames;
+
+			int o = 0;
+			for (; o < outputFrames && canOutput(); ++o) {
+				const Sample *coeffs = currentCoefficients();
+				int index = int(position >> fractionBits);
+				for (int c = 0; c < channels; ++c) {
+					output[c][o] = signalsmith::perf::dot(buffer.data() + c*bufferStride + index, coeffs, taps);
+				}
+				position += step;
+			}
+			for (; o < outputFrames; ++o) {
+				for (int c = 0; c < channels; ++c) output[c][o] = 0;
+			}
+			discardUsedInput();
+		}
+
+		/** Push-style, interleaved.  Takes up to `inputFrames` (updated to how many it used), and writes up to `outputFrames` (updated to how many it wrote).
+			Null `input` is silence, null `output` discards. */
+		void processInterleaved(const Sample *input, int &inputFrames, Sample *output, int &outputFrames) {
+			int used = 0, written = 0;
+			while (true) {
+				// Use up whatever's buffered, then top it up
+				for (; written < outputFrames && canOutput(); ++written) {
+					if (output != nullptr) {
+						const Sample *coeffs = currentCoefficients();
+						int index = int(position >> fractionBits);
+						for (int c = 0; c < channels; ++c) {
+							output[written*channels + c] = signalsmith::perf::dot(buffer.data() + c*bufferStride + index, coeffs, taps);
+						}
+					}
+					position += step;
+				}
+				discardUsedInput();
+				if (written >= outputFrames || used >= inputFrames) break;
+
+				int accept = std::min(inputFrames - used, bufferStride - filled);
+				if (accept <= 0) break;
+				for (int c = 0; c < channels; ++c) {
+					Sample *channel = buffer.data() + c*bufferStride + filled;
+					for (int i = 0; i < accept; ++i) {
+						channel[i] = (input != nullptr) ? input[(used + i)*channels + c] : 0;
+					}
+				}
+				filled += accept;
+				used += accept;
+			}
+			inputFrames = used;
+			outputFrames = written;
+		}
+	};
+
 /** @} */
 }} // namespace
 #endif // include guard
@@ -8,7 +8,12 @@
 #include "./windows.h"
 #include "./delay.h"
 
+#include <array>
 #include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <type_traits>
 
 namespace signalsmith {
 namespace spectral {
@@ -25,15 +30,62 @@ namespace spectral {
 		
 		This avoids the awkward (real-valued) bands for DC-offset and Nyquist.
 	 */
-	template<typename Sample>
+	template<typename Sample, class Allocator=signalsmith::perf::AlignedAllocator<Sample>>
 	class WindowedFFT {
 		using MRFFT = signalsmith::fft::ModifiedRealFFT<Sample>;
 		using Complex = std::complex<Sample>;
 		MRFFT mrfft{2};
 
-		std::vector<Sample> fftWindow;
-		std::vector<Sample> timeBuffer;
+		std::vector<Sample, Allocator> fftWindow;
+		std::vector<Sample, Allocator> timeBuffer;
 		int offsetSamples = 0;
+		// The window with the 1/N scaling folded in, rebuilt on the first IFFT after the window might have changed
+		std::vector<Sample, Allocator> synthesisWindow;
+		bool synthesisWindowValid = false;
+
+		// Contiguous input gets the vectorised windowing, anything else (e.g. a delay-buffer view) is copied one sample at a time
+		static const Sample * contiguous(const Sample *input) {
+			return input;
+		}
+		template<class A>
+		static const Sample * contiguous(const std::vector<Sample, A> &input) {
+			return input.data();
+		}
+		template<class Input>
+		static const Sample * contiguous(const Input &) {
+			return nullptr;
+		}
+
+		template<bool add>
+		void writeWindowed(int index, int length, Sample *output) {
+			if (!synthesisWindowValid) {
+				size_t fftSize = mrfft.size();
+				Sample norm = 1/(Sample)fftSize;
+				for (size_t i = 0; i < fftSize; ++i) {
+					synthesisWindow[i] = fftWindow[i]*norm;
+				}
+				synthesisWindowValid = true;
+			}
+			int fftSize = size();
+			// Rotated part: inverted polarity since we're using the MRFFT
+			int rotatedEnd = std::min(index + length, offsetSamples);
+			for (int i = index; i < rotatedEnd; ++i) {
+				Sample v = -timeBuffer[i + fftSize - offsetSamples]*synthesisWindow[i];
+				if (add) {
+					output[i - index] += v;
+				} else {
+					output[i - index] = v;
+				}
+			}
+			int start = std::max(index, offsetSamples);
+			int count = index + length - start;
+			if (count <= 0) return;
+			if (add) {
+				signalsmith::perf::multiplyAdd(timeBuffer.data() + start - offsetSamples, synthesisWindow.data() + start, output + (start - index), count);
+			} else {
+				signalsmith::perf::multiply(timeBuffer.data() + start - offsetSamples, synthesisWindow.data() + start, output + (start - index), count);
+			}
+		}
 	public:
 		/// Returns a fast FFT size <= `size`
 		static int fastSizeAbove(int size, int divisor=1) {
@@ -54,10 +106,12 @@ namespace spectral {
 		}
 
 		/// Sets the size, returning the window for modification (initially all 1s)
-		std::vector<Sample> & setSizeWindow(int size, int rotateSamples=0) {
+		std::vector<Sample, Allocator> & setSizeWindow(int size, int rotateSamples=0) {
 			mrfft.setSize(size);
 			fftWindow.assign(size, 1);
 			timeBuffer.resize(size);
+			synthesisWindow.resize(size);
+			synthesisWindowValid = false; // the caller may still be filling in the window
 			offsetSamples = rotateSamples;
 			if (offsetSamples < 0) offsetSamples += size; // TODO: for a negative rotation, the other half of the result is inverted
 			return fftWindow;
@@ -82,9 +136,24 @@ namespace spectral {
 			}, Sample(0.5), rotateSamples);
 		}
 
-		const std::vector<Sample> & window() const {
+		/// Sets the size with a ready-made window, and the same window already scaled by 1/size for synthesis, so nothing is calculated
+		void setSizeWindows(int size, const Sample *window, const Sample *synthesis, int rotateSamples=0) {
+			setSizeWindow(size, rotateSamples);
+			std::copy(window, window + size, fftWindow.begin());
+			std::copy(synthesis, synthesis + size, synthesisWindow.begin());
+			synthesisWindowValid = true;
+		}
+
+		const std::vector<Sample, Allocator> & window() const {
 			return this->fftWindow;
 		}
+		/// Allocates enough for any later `.setSize()` up to this size
+		void reserve(int maxSize) {
+			mrfft.reserve(maxSize);
+			fftWindow.reserve(maxSize);
+			timeBuffer.reserve(maxSize);
+			synthesisWindow.reserve(maxSize);
+		}
 		int size() const {
 			return int(mrfft.size());
 		}
@@ -97,8 +166,13 @@ namespace spectral {
 				// Inverted polarity since we're using the MRFFT
 				timeBuffer[i + fftSize - offsetSamples] = -input[i]*fftWindow[i];
 			}
-			for (int i = offsetSamples; i < fftSize; ++i) {
-				timeBuffer[i - offsetSamples] = input[i]*fftWindow[i];
+			const Sample *contiguousInput = contiguous(input);
+			if (contiguousInput) {
+				signalsmith::perf::multiply(contiguousInput + offsetSamples, fftWindow.data() + offsetSamples, timeBuffer.data(), fftSize - offsetSamples);
+			} else {
+				for (int i = offsetSamples; i < fftSize; ++i) {
+					timeBuffer[i - offsetSamples] = input[i]*fftWindow[i];
+				}
 			}
 			mrfft.fft(timeBuffer, output);
 		}
@@ -128,6 +202,21 @@ namespace spectral {
 		void ifftRaw(Input &&input, Output &&output) {
 			mrfft.ifft(input, output);
 		}
+
+		/** Inverse FFT, kept internally so it can be windowed and scaled straight into the destination.
+		Use `.addWindowed()`/`.copyWindowed()` afterwards, which can be called for separate pieces of the result. */
+		template<class Input>
+		void ifftInternal(Input &&input) {
+			mrfft.ifft(input, timeBuffer);
+		}
+		/// Adds `length` samples (starting from `index`) of the windowed result from `.ifftInternal()` into `output`
+		void addWindowed(int index, int length, Sample *output) {
+			writeWindowed<true>(index, length, output);
+		}
+		/// Like `.addWindowed()`, but overwrites `output` instead
+		void copyWindowed(int index, int length, Sample *output) {
+			writeWindowed<false>(index, length, output);
+		}
 	};
 	
 	/** STFT synthesis, built on a `MultiBuffer`.
@@ -167,17 +256,22 @@ namespace spectral {
 		
 		The index passed to this functor will be greater than the previous valid index, and `<=` the index you pass in.  Therefore, if you call `.ensureValid()` every sample, it can only ever be `0`.
 	*/
-	template<typename Sample>
-	class STFT : public signalsmith::delay::MultiBuffer<Sample> {
-		using Super = signalsmith::delay::MultiBuffer<Sample>;
+	template<typename Sample, class Allocator=signalsmith::perf::AlignedAllocator<Sample>>
+	class STFT : public signalsmith::delay::MultiBuffer<Sample, Allocator> {
+		using Super = signalsmith::delay::MultiBuffer<Sample, Allocator>;
 		using Complex = std::complex<Sample>;
+		using ComplexAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Complex>;
 
 		int channels = 0, _windowSize = 0, _fftSize = 0, _interval = 1;
 		int validUntilIndex = 0;
+		// Output ahead of the next block which has been written directly and must be added to (see `.keepOutput()`)
+		int keepAhead = 0;
+		// Whether the last interval of output past the latest block holds old samples (see `.clearAhead()`)
+		bool staleAhead = false;
 
 		class MultiSpectrum {
 			int channels, stride;
-			std::vector<Complex> buffer;
+			std::vector<Complex, ComplexAllocator> buffer;
 		public:
 			MultiSpectrum() : MultiSpectrum(0, 0) {}
 			MultiSpectrum(int channels, int bands) : channels(channels), stride(bands), buffer(channels*bands, 0) {}
@@ -191,6 +285,9 @@ namespace spectral {
 			void reset() {
 				buffer.assign(buffer.size(), 0);
 			}
+			void reserve(int maxChannels, int maxBands) {
+				buffer.reserve(maxChannels*maxBands);
+			}
 			
 			void swap(MultiSpectrum &other) {
 				using std::swap;
@@ -204,7 +301,19 @@ namespace spectral {
 				return buffer.data() + channel*stride;
 			}
 		};
-		std::vector<Sample> timeBuffer;
+		// Windows the IFFT result straight into the ring buffer, one contiguous piece at a time
+		template<bool add>
+		void overlapAdd(typename Super::MutableChannel channel, int start, int end) {
+			while (start < end) {
+				int length = std::min(end - start, channel.contiguous(start));
+				if (add) {
+					fft.addWindowed(start, length, channel.data(start));
+				} else {
+					fft.copyWindowed(start, length, channel.data(start));
+				}
+				start += length;
+			}
+		}
 
 		void resizeInternal(int newChannels, int windowSize, int newInterval, int historyLength, int zeroPadding) {
 			Super::resize(newChannels,
@@ -219,11 +328,12 @@ namespace spectral {
 			this->_fftSize = fftSize;
 			this->_interval = newInterval;
 			validUntilIndex = -1;
+			keepAhead = 0;
+			staleAhead = false;
 			
 			setWindow(windowShape);
 
 			spectrum.resize(channels, fftSize/2);
-			timeBuffer.resize(fftSize);
 		}
 	public:
 		enum class Window {kaiser, acg};
@@ -232,7 +342,48 @@ namespace spectral {
 		// for convenience
 		static constexpr Window kaiser = Window::kaiser;
 		static constexpr Window acg = Window::acg;
+	private:
+		struct WindowTables {
+			std::vector<Sample, Allocator> window; // zero past the window length, up to the FFT size
+			std::vector<Sample, Allocator> synthesis; // `window` with the IFFT's 1/N scaling folded in
+		};
 		
+		// Process-wide, so every STFT with the same shape/sizes shares one set of tables (like the FFT plans)
+		static std::shared_ptr<const WindowTables> getWindowTables(Window shape, int windowSize, int interval, int fftSize) {
+			static std::mutex mutex;
+			static std::map<std::array<int, 4>, std::shared_ptr<const WindowTables>> cache;
+			std::lock_guard<std::mutex> lock(mutex);
+			std::shared_ptr<const WindowTables> &entry = cache[{{int(shape), windowSize, interval, fftSize}}];
+			if (entry) return entry;
+
+			auto tables = std::make_shared<WindowTables>();
+			auto &window = tables->window;
+			window.assign(fftSize, 0);
+			if (shape == Window::kaiser) {
+				// Roughly optimal Kaiser for STFT analysis (forced to perfect reconstruction) - the preset sizes are built at compile-time
+				const float *precomputed = std::is_same<Sample, float>::value ? ::signalsmith::windows::precomputedKaiserStft(windowSize, interval) : nullptr;
+				if (precomputed) {
+					std::copy(precomputed, precomputed + windowSize, window.begin());
+				} else {
+					::signalsmith::windows::fillKaiserStft(window, windowSize, interval);
+				}
+			} else {
+				using Confined = ::signalsmith::windows::ApproximateConfinedGaussian;
+				auto confined = Confined::withBandwidth(windowSize/double(interval));
+				confined.fill(window, windowSize);
+				::signalsmith::windows::forcePerfectReconstruction(window, windowSize, interval);
+			}
+			// TODO: fill extra bits of an input buffer with NaN/Infinity, to break this, and then fix by adding zero-padding to WindowedFFT (as opposed to zero-valued window sections)
+
+			Sample norm = 1/(Sample)fftSize;
+			tables->synthesis.resize(fftSize);
+			for (int i = 0; i < fftSize; ++i) {
+				tables->synthesis[i] = window[i]*norm;
+			}
+			entry = tables;
+			return entry;
+		}
+	public:
 		/** Swaps between the default (Kaiser) shape and Approximate Confined Gaussian (ACG).
 		\diagram{stft-windows.svg,Default (Kaiser) windows and partial cumulative sum}
 		The ACG has better rolloff since its edges go to 0:
@@ -243,28 +394,13 @@ namespace spectral {
 		void setWindow(Window shape, bool rotateToZero=false) {
 			windowShape = shape;
 
-			auto &window = fft.setSizeWindow(_fftSize, rotateToZero ? _windowSize/2 : 0);
-			if (windowShape == Window::kaiser) {
-				using Kaiser = ::signalsmith::windows::Kaiser;
-				/// Roughly optimal Kaiser for STFT analysis (forced to perfect reconstruction)
-				auto kaiser = Kaiser::withBandwidth(_windowSize/double(_interval), true);
-				kaiser.fill(window, _windowSize);
-			} else {
-				using Confined = ::signalsmith::windows::ApproximateConfinedGaussian;
-				auto confined = Confined::withBandwidth(_windowSize/double(_interval));
-				confined.fill(window, _windowSize);
-			}
-			::signalsmith::windows::forcePerfectReconstruction(window, _windowSize, _interval);
-			
-			// TODO: fill extra bits of an input buffer with NaN/Infinity, to break this, and then fix by adding zero-padding to WindowedFFT (as opposed to zero-valued window sections)
-			for (int i = _windowSize; i < _fftSize; ++i) {
-				window[i] = 0;
-			}
+			std::shared_ptr<const WindowTables> tables = getWindowTables(windowShape, _windowSize, _interval, _fftSize);
+			fft.setSizeWindows(_fftSize, tables->window.data(), tables->synthesis.data(), rotateToZero ? _windowSize/2 : 0);
 		}
 		
 		using Spectrum = MultiSpectrum;
 		Spectrum spectrum;
-		WindowedFFT<Sample> fft;
+		WindowedFFT<Sample, Allocator> fft;
 		
 		STFT() {}
 		/// Parameters passed straight to `.resize()`
@@ -276,6 +412,14 @@ namespace spectral {
 		void resize(int nChannels, int windowSize, int interval, int historyLength=0, int zeroPadding=0) {
 			resizeInternal(nChannels, windowSize, interval, historyLength, zeroPadding);
 		}
+		/** Allocates enough that any later `.resize()` within these limits won't allocate.
+		The FFT plans come from a shared cache, so only sizes which haven't been used anywhere yet need building. */
+		void reserve(int maxChannels, int maxWindowSize, int maxInterval, int maxHistoryLength=0, int maxZeroPadding=0) {
+			Super::reserve(maxChannels, maxWindowSize + maxInterval + maxHistoryLength);
+			int maxFftSize = fft.fastSizeAbove(maxWindowSize + maxZeroPadding);
+			fft.reserve(maxFftSize);
+			spectrum.reserve(maxChannels, maxFftSize/2);
+		}
 		
 		int windowSize() const {
 			return _windowSize;
@@ -309,6 +453,28 @@ namespace spectral {
 			Super::reset();
 			spectrum.reset();
 			validUntilIndex = -1;
+			keepAhead = 0;
+			staleAhead = false;
+		}
+
+		/** Keeps output which has been written directly into the next `length` samples (relative to the next block), for example carried over from another STFT after a `.reset()`.
+		Without this, the part of each new block which doesn't overlap an earlier one overwrites whatever is there. */
+		void keepOutput(int length) {
+			keepAhead = std::max(keepAhead, length);
+		}
+		/** Each block overwrites its last interval instead of it being cleared in advance, so output more than `windowSize - interval` past the next block holds old samples until that block arrives.
+		Call this before reading the partially-summed future output that far ahead (e.g. when flushing). */
+		void clearAhead() {
+			if (!staleAhead) return;
+			int from = std::max(_windowSize - _interval, keepAhead);
+			auto output = this->view(validUntilIndex + 1);
+			for (int c = 0; c < channels; ++c) {
+				auto channel = output[c];
+				for (int i = from; i < _windowSize; ++i) {
+					channel[i] = 0;
+				}
+			}
+			staleAhead = false;
 		}
 		
 		/** Generates valid output up to the specified index (or 0), using the callback as many times as needed.
@@ -323,21 +489,21 @@ namespace spectral {
 				int blockIndex = validUntilIndex + 1;
 				fn(blockIndex);
 
+				// No earlier block reaches the end of this one, so that part is written rather than summed (and never needs clearing)
+				int overwriteFrom = std::min(_windowSize, std::max(_windowSize - _interval, keepAhead));
 				auto output = this->view(blockIndex);
 				for (int c = 0; c < channels; ++c) {
 					auto channel = output[c];
-
-					// Clear out the future sum, a window-length and an interval ahead
-					for (int wi = _windowSize; wi < _windowSize + _interval; ++wi) {
+					fft.ifftInternal(spectrum[c]);
+					overlapAdd<true>(channel, 0, overwriteFrom);
+					overlapAdd<false>(channel, overwriteFrom, _windowSize);
+					// With gaps between blocks, nothing else would clear these
+					for (int wi = std::max(_windowSize, keepAhead); wi < _interval; ++wi) {
 						channel[wi] = 0;
 					}
-
-					// Add in the IFFT'd result
-					fft.ifft(spectrum[c], timeBuffer);
-					for (int wi = 0; wi < _windowSize; ++wi) {
-						channel[wi] += timeBuffer[wi];
-					}
 				}
+				keepAhead = std::max(0, keepAhead - _interval);
+				staleAhead = true;
 				validUntilIndex += _interval;
 			}
 		}
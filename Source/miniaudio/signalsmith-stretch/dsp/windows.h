@@ -9,6 +9,7 @@
 
 #include <cmath>
 #include <algorithm>
+#include <type_traits>
 
 namespace signalsmith {
 namespace windows {
@@ -27,22 +28,12 @@ namespace windows {
 	class Kaiser {
 		// I_0(x)=\sum_{k=0}^{N}\frac{x^{2k}}{(k!)^2\cdot4^k}
 		inline static double bessel0(double x) {
-			const double significanceLimit = 1e-4;
-			double result = 0;
-			double term = 1;
-			double m = 0;
-			while (term > significanceLimit) {
-				result += term;
-				++m;
-				term *= (x*x)/(4*m*m);
-			}
-
-			return result;
+			return bessel0Squared(x*x);
 		}
 		double beta;
 		double invB0;
 		
-		static double heuristicBandwidth(double bandwidth) {
+		static constexpr double heuristicBandwidth(double bandwidth) {
 			// Good peaks
 			//return bandwidth + 8/((bandwidth + 3)*(bandwidth + 3));
 			// Good average
@@ -51,6 +42,21 @@ namespace windows {
 			return bandwidth + 8/((bandwidth + 3)*(bandwidth + 3)) + 0.25*std::max<double>(3 - bandwidth, 0.0);
 		}
 	public:
+		/// I_0() of `sqrt(x2)`: the series only needs x^2, which keeps the square-root out of the window (so it can be constexpr)
+		static constexpr double bessel0Squared(double x2) {
+			const double significanceLimit = 1e-4;
+			double result = 0;
+			double term = 1;
+			double m = 0;
+			while (term > significanceLimit) {
+				result += term;
+				++m;
+				term *= x2/(4*m*m);
+			}
+
+			return result;
+		}
+
 		/// Set up a Kaiser window with a given shape.  `beta` is `pi*alpha` (since there is ambiguity about shape parameters)
 		Kaiser(double beta) : beta(beta), invB0(1/bessel0(beta)) {}
 
@@ -73,6 +79,15 @@ namespace windows {
 			return alpha*M_PI;
 		}
 		
+		/// `bandwidthToBeta()` squared, which doesn't need a square-root
+		static constexpr double bandwidthToBetaSquared(double bandwidth, bool heuristicOptimal=false) {
+			if (heuristicOptimal) {
+				bandwidth = heuristicBandwidth(bandwidth);
+			}
+			bandwidth = std::max<double>(bandwidth, 2.0);
+			return (bandwidth*bandwidth*0.25 - 1)*M_PI*M_PI;
+		}
+		
 		static double betaToBandwidth(double beta) {
 			double alpha = beta*(1.0/M_PI);
 			return 2*std::sqrt(alpha*alpha + 1);
@@ -220,6 +235,68 @@ namespace windows {
 	   }
 	}
 
+	namespace _impl {
+		// <cmath> isn't constexpr until C++26.  Newton's method from above, which stops once it stops improving.
+		constexpr double sqrt(double x) {
+			if (x <= 0) return 0;
+			double r = (x < 1) ? 1 : x;
+			while (true) {
+				double next = (r + x/r)*0.5;
+				if (next >= r) return r;
+				r = next;
+			}
+		}
+	}
+
+	/** Fills the STFT's default window: a heuristically-optimal @ref Kaiser (bandwidth `windowLength/interval`) forced to perfect reconstruction.
+	This matches `Kaiser::withBandwidth(..., true)` then `forcePerfectReconstruction()`, but can run at compile-time (see @ref KaiserStftTable).
+	*/
+	template<typename Data>
+	constexpr void fillKaiserStft(Data &&data, int windowLength, int interval) {
+		using ValueType = std::remove_reference_t<decltype(data[0])>;
+		double beta2 = Kaiser::bandwidthToBetaSquared(windowLength/double(interval), true);
+		double invB0 = 1/Kaiser::bessel0Squared(beta2);
+		double invSize = 1.0/windowLength;
+		for (int i = 0; i < windowLength; ++i) {
+			double r = (2*i + 1)*invSize - 1;
+			data[i] = static_cast<ValueType>(Kaiser::bessel0Squared(beta2*(1 - r*r))*invB0);
+		}
+		for (int i = 0; i < interval; ++i) {
+			double sum2 = 0;
+			for (int index = i; index < windowLength; index += interval) {
+				sum2 += data[index]*data[index];
+			}
+			double factor = 1/_impl::sqrt(sum2);
+			for (int index = i; index < windowLength; index += interval) {
+				data[index] = static_cast<ValueType>(data[index]*factor);
+			}
+		}
+	}
+
+	/// A @ref fillKaiserStft() window, generated at compile-time when declared `constexpr`
+	template<int windowLength, int interval>
+	struct KaiserStftTable {
+		float values[windowLength] = {};
+
+		constexpr KaiserStftTable() {
+			fillKaiserStft(values, windowLength, interval);
+		}
+	};
+
+	/** Windows for signalsmith-stretch's fixed presets at 44.1kHz (lowest-latency, low-latency, cheaper, default), built into the binary.
+	Returns `nullptr` for anything else, which has to be generated at runtime. */
+	inline const float * precomputedKaiserStft(int windowLength, int interval) {
+		static constexpr KaiserStftTable<1764, 441> lowestLatency{};
+		static constexpr KaiserStftTable<2646, 882> lowLatency{};
+		static constexpr KaiserStftTable<4410, 1764> cheaper{};
+		static constexpr KaiserStftTable<5292, 1323> standard{};
+		if (windowLength == 1764 && interval == 441) return lowestLatency.values;
+		if (windowLength == 2646 && interval == 882) return lowLatency.values;
+		if (windowLength == 4410 && interval == 1764) return cheaper.values;
+		if (windowLength == 5292 && interval == 1323) return standard.values;
+		return nullptr;
+	}
+
 /** @} */
 }} // signalsmith::windows
 #endif // include guard
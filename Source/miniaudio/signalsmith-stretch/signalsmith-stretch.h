@@ -55,18 +55,25 @@ namespace signalsmith
         class SignalsmithStretch
         {
         public:
-            SignalsmithStretch() : randomEngine(std::random_device{}()) {}
-            SignalsmithStretch(long seed) : randomEngine(seed) {}
+            SignalsmithStretch() : SignalsmithStretch(std::random_device{}()) {}
+            SignalsmithStretch(long seed) : randomSeed(seed), randomEngine(seed) {}
 
             int blockSamples() const;
             int intervalSamples() const;
             int inputLatency() const;
+            int maxInputLatency() const; // the most `inputLatency()` can become through `adapt()`, for sizing `seek()` buffers up front
             int outputLatency() const;
 
             void reset();
+            void setSeed(long seed);
             void presetDefault(int nChannels, float sampleRate);
             void presetCheaper(int nChannels, float sampleRate);
+            void presetLowLatency(int nChannels, float sampleRate);
+            void presetLowestLatency(int nChannels, float sampleRate);
+            void presetAdaptive(int nChannels, float sampleRate);
             void configure(int nChannels, int blockSamples, int intervalSamples);
+            void adapt(float playbackRate);
+            bool isAdaptive() const;
             void setTransposeFactor(float multiplier, float tonalityLimit = 0);
             void setTransposeSemitones(float semitones, float tonalityLimit = 0);
             void setFreqMap(std::function<float(float)> inputToOutput);
@@ -75,6 +82,12 @@ namespace signalsmith
                 int inputSamples,
                 float *outputs,
                 int outputSamples);
+            void processPlanar(
+                const float *const *inputs,
+                int inputSamples,
+                float *const *outputs,
+                int outputSamples);
+            void reserveInterleaved(int maxInputSamples, int maxOutputSamples);
             void flush(
                 float *outputs,
                 int outputSamples);
@@ -93,27 +106,54 @@ namespace signalsmith
             float freqTonalityLimit = 0.5;
             std::function<float(float)> customFreqMap = nullptr;
 
+            // All storage is cache-aligned, and sized by the presets/`configure()` (plus `reserveInterleaved()`), so processing never allocates
             signalsmith::spectral::STFT<float> stft{0, 1, 1};
             signalsmith::delay::MultiBuffer<float> inputBuffer;
             int channels = 0, bands = 0;
             int prevInputOffset = -1;
             float seekTimeFactor = 1;
-            std::vector<float> timeBuffer;
+            signalsmith::perf::AlignedVector<float> timeBuffer;
+
+            // Scratch for the interleaved `process()`, which splits channels and hands over to `processPlanar()`
+            signalsmith::perf::AlignedVector<float> planarInputBuffer, planarOutputBuffer;
+            signalsmith::perf::AlignedVector<float *> planarInputs, planarOutputs;
+            int planarInputCapacity = 0, planarOutputCapacity = 0;
+
+            signalsmith::perf::AlignedVector<std::complex<float>> rotCentreSpectrum, rotPrevInterval;
+
+            // Adaptive mode keeps every candidate STFT allocated, and swaps them with the live one
+            struct StftConfig
+            {
+                signalsmith::spectral::STFT<float> stft{0, 1, 1};
+                signalsmith::perf::AlignedVector<std::complex<float>> rotCentreSpectrum, rotPrevInterval;
+            };
+            static constexpr int adaptiveCandidates = 4;
+            signalsmith::perf::AlignedVector<StftConfig> spareConfigs;
+            int adaptiveBlocks[adaptiveCandidates] = {0};
+            float adaptiveSampleRate = 0;
+            bool percussive = false;
+            float adaptedRate = 1; // what `adapt()` was last given, so a change in `percussive` can re-pick
+            int onsetCount = 0, onsetWindowSamples = 0;
+            float slowEnergy = 0;
+            void configureStft(int blockSamples, int intervalSamples);
+            void configureBuffers(int maxBlockSamples, int maxIntervalSamples, int maxFftSize);
+            void swapConfig(StftConfig &config);
+            bool detectOnsets(float totalEnergy, int inputSamples);
 
-            std::vector<std::complex<float>> rotCentreSpectrum, rotPrevInterval;
             SIGNALSMITH_INLINE float bandToFreq(float b) const;
             SIGNALSMITH_INLINE float freqToBand(float f) const;
-            SIGNALSMITH_INLINE void timeShiftPhases(float shiftSamples, std::vector<std::complex<float>> &output) const;
+            SIGNALSMITH_INLINE void timeShiftPhases(float shiftSamples, signalsmith::perf::AlignedVector<std::complex<float>> &output) const;
 
-            std::vector<Band> channelBands;
+            signalsmith::perf::AlignedVector<Band> channelBands;
             SIGNALSMITH_INLINE Band *bandsForChannel(int channel);
 
-            std::vector<Peak> peaks;
-            std::vector<float> energy, smoothedEnergy;
-            std::vector<PitchMapPoint> outputMap;
-            std::vector<Prediction> channelPredictions;
+            signalsmith::perf::AlignedVector<Peak> peaks;
+            signalsmith::perf::AlignedVector<float> energy, smoothedEnergy;
+            signalsmith::perf::AlignedVector<PitchMapPoint> outputMap;
+            signalsmith::perf::AlignedVector<Prediction> channelPredictions;
             Prediction *predictionsForChannel(int c);
 
+            long randomSeed;
             std::default_random_engine randomEngine;
 
             SIGNALSMITH_INLINE void processSpectrum(bool newSpectrum, float timeFactor);
@@ -149,6 +189,16 @@ namespace signalsmith
         {
             return stft.windowSize() / 2;
         }
+        int SignalsmithStretch::maxInputLatency() const
+        {
+            int latency = inputLatency();
+            if (isAdaptive())
+            {
+                for (int block : adaptiveBlocks)
+                    latency = (std::max)(latency, block / 2);
+            }
+            return latency;
+        }
         int SignalsmithStretch::outputLatency() const
         {
             return stft.windowSize() - inputLatency();
@@ -163,6 +213,14 @@ namespace signalsmith
             silenceCounter = 2 * stft.windowSize();
             flushed = true;
             didSeek = false;
+            randomEngine.seed(randomSeed); // Same seed + same input = same output, even across resets
+        }
+
+        // The random per-bin time factors (above maxCleanStretch) come from this, so fixing it makes the output reproducible
+        void SignalsmithStretch::setSeed(long seed)
+        {
+            randomSeed = seed;
+            randomEngine.seed(seed);
         }
 
         // Configures using a default preset
@@ -182,28 +240,201 @@ namespace signalsmith
                 static_cast<int>(sampleRate * 0.04));
         }
 
+        // Shorter blocks for rhythm games: less smearing/latency, at the cost of some low-end resolution
+        void SignalsmithStretch::presetLowLatency(int nChannels, float sampleRate)
+        {
+            configure(
+                nChannels,
+                static_cast<int>(sampleRate * 0.06),
+                static_cast<int>(sampleRate * 0.02));
+        }
+
+        void SignalsmithStretch::presetLowestLatency(int nChannels, float sampleRate)
+        {
+            configure(
+                nChannels,
+                static_cast<int>(sampleRate * 0.04),
+                static_cast<int>(sampleRate * 0.01));
+        }
+
+        // Pre-allocates all of the candidate block sizes, so `adapt()` can switch between them without allocating
+        void SignalsmithStretch::presetAdaptive(int nChannels, float sampleRate)
+        {
+            // Smallest first: lowest, low-latency, cheaper, default
+            const float candidates[adaptiveCandidates][2] = {{0.04f, 0.01f}, {0.06f, 0.02f}, {0.1f, 0.04f}, {0.12f, 0.03f}};
+
+            channels = nChannels;
+            adaptiveSampleRate = sampleRate;
+            spareConfigs.clear();
+            spareConfigs.resize(adaptiveCandidates - 1);
+
+            int maxBlock = 0, maxInterval = 0, maxFftSize = 0;
+            for (int i = adaptiveCandidates - 1; i >= 0; --i)
+            {
+                int blockSamples = static_cast<int>(sampleRate * candidates[i][0]);
+                int intervalSamples = static_cast<int>(sampleRate * candidates[i][1]);
+                adaptiveBlocks[i] = blockSamples;
+
+                configureStft(blockSamples, intervalSamples);
+                maxBlock = (std::max)(maxBlock, blockSamples);
+                maxInterval = (std::max)(maxInterval, intervalSamples);
+                maxFftSize = (std::max)(maxFftSize, stft.fftSize());
+
+                if (i > 0)
+                { // park it, leaving the smallest one live
+                    auto &spare = spareConfigs[i - 1];
+                    std::swap(stft, spare.stft);
+                    std::swap(rotCentreSpectrum, spare.rotCentreSpectrum);
+                    std::swap(rotPrevInterval, spare.rotPrevInterval);
+                }
+            }
+            configureBuffers(maxBlock, maxInterval, maxFftSize);
+            percussive = false;
+            adaptedRate = 1;
+            onsetCount = onsetWindowSamples = 0;
+            slowEnergy = 0;
+        }
+
         // Manual setup
         void SignalsmithStretch::configure(int nChannels, int blockSamples, int intervalSamples)
         {
             channels = nChannels;
+            spareConfigs.clear();
+            configureStft(blockSamples, intervalSamples);
+            configureBuffers(blockSamples, intervalSamples, stft.fftSize());
+        }
+
+        /// Picks the block size for a playback rate (adaptive preset only) - call this between blocks, before `.seek()` if there is one
+        void SignalsmithStretch::adapt(float playbackRate)
+        {
+            if (spareConfigs.empty())
+                return;
+            adaptedRate = playbackRate;
+
+            float distance = std::abs(playbackRate - 1);
+            int index;
+            if (distance <= 0.15f)
+                index = 0;
+            else if (distance <= 0.35f)
+                index = 1;
+            else if (playbackRate >= 0.6f && playbackRate <= 1.6f)
+                index = 2;
+            else
+                index = 3;
+            // Transients smear across long blocks, so percussive material gets the next size down
+            if (percussive && index > 0)
+                --index;
+
+            int targetBlock = adaptiveBlocks[index];
+            if (stft.windowSize() == targetBlock)
+                return;
+            for (auto &config : spareConfigs)
+            {
+                if (config.stft.windowSize() == targetBlock)
+                {
+                    swapConfig(config);
+                    return;
+                }
+            }
+        }
+
+        bool SignalsmithStretch::isAdaptive() const
+        {
+            return !spareConfigs.empty();
+        }
+
+        void SignalsmithStretch::configureStft(int blockSamples, int intervalSamples)
+        {
             stft.resize(channels, blockSamples, intervalSamples);
             bands = stft.bands();
-            inputBuffer.resize(channels, blockSamples + intervalSamples + 1);
-            timeBuffer.assign(stft.fftSize(), 0);
-            channelBands.assign(bands * channels, Band());
 
             // Various phase rotations
             rotCentreSpectrum.resize(bands);
             rotPrevInterval.assign(bands, 0);
             timeShiftPhases(blockSamples * float(-0.5), rotCentreSpectrum);
             timeShiftPhases(static_cast<float>(-intervalSamples), rotPrevInterval);
-            peaks.reserve(bands);
+        }
+
+        // Sized for the largest configuration, so switching within it never reallocates
+        void SignalsmithStretch::configureBuffers(int maxBlockSamples, int maxIntervalSamples, int maxFftSize)
+        {
+            int maxBands = maxFftSize / 2;
+            inputBuffer.resize(channels, maxBlockSamples + maxIntervalSamples + 1);
+            timeBuffer.assign(maxFftSize, 0);
+            channelBands.reserve(maxBands * channels);
+            channelBands.assign(bands * channels, Band());
+
+            peaks.reserve(maxBands);
+            energy.reserve(maxBands);
             energy.resize(bands);
+            smoothedEnergy.reserve(maxBands);
             smoothedEnergy.resize(bands);
+            outputMap.reserve(maxBands);
             outputMap.resize(bands);
+            channelPredictions.reserve(channels * maxBands);
             channelPredictions.resize(channels * bands);
         }
 
+        void SignalsmithStretch::swapConfig(StftConfig &config)
+        {
+            // Carry the partially-summed output across, so the switch is a short crossfade rather than a dropout
+            stft.clearAhead();
+            config.stft.reset();
+            int carry = (std::min)(stft.windowSize(), config.stft.windowSize());
+            for (int c = 0; c < channels; ++c)
+            {
+                auto &&from = stft[c];
+                auto &&to = config.stft[c];
+                for (int i = 0; i < carry; ++i)
+                {
+                    to[i] = from[i];
+                }
+            }
+            config.stft.keepOutput(carry);
+
+            std::swap(stft, config.stft);
+            std::swap(rotCentreSpectrum, config.rotCentreSpectrum);
+            std::swap(rotPrevInterval, config.rotPrevInterval);
+
+            // All within the capacity reserved by `configureBuffers()`
+            bands = stft.bands();
+            channelBands.assign(bands * channels, Band());
+            energy.resize(bands);
+            smoothedEnergy.resize(bands);
+            outputMap.resize(bands);
+            channelPredictions.assign(channels * bands, Prediction());
+            prevInputOffset = -1;
+        }
+
+        // Counts sudden jumps in block energy, to decide whether the material is percussive - returns whether that changed
+        bool SignalsmithStretch::detectOnsets(float totalEnergy, int inputSamples)
+        {
+            const float onsetRatio = 4;        // +6dB jump over the recent average
+            const float minOnsetsPerSecond = 3; // roughly eighth-notes at 90bpm
+
+            float blockEnergy = totalEnergy / (inputSamples * channels);
+            if (blockEnergy > slowEnergy * onsetRatio && blockEnergy > noiseFloor)
+                ++onsetCount;
+            slowEnergy += (blockEnergy - slowEnergy) * 0.1f;
+
+            onsetWindowSamples += inputSamples;
+            int windowLength = static_cast<int>(adaptiveSampleRate * 2);
+            bool wasPercussive = percussive;
+            if (onsetCount >= minOnsetsPerSecond * 2 && !percussive)
+            { // no need to wait for the end of the window, so a fresh stretcher switches within the first few beats
+                percussive = true;
+                onsetCount = 0;
+                onsetWindowSamples = 0;
+            }
+            else if (onsetWindowSamples >= windowLength)
+            {
+                percussive = onsetCount >= minOnsetsPerSecond * 2;
+                onsetCount = 0;
+                onsetWindowSamples = 0;
+            }
+            return percussive != wasPercussive;
+        }
+
         /// Frequency multiplier, and optional tonality limit (as multiple of sample-rate)
         void SignalsmithStretch::setTransposeFactor(float multiplier, float tonalityLimit)
         {
@@ -234,20 +465,52 @@ namespace signalsmith
             return channelPredictions.data() + c * bands;
         }
 
+        // Pre-sizes the scratch used by the interleaved `process()`, so it doesn't allocate for blocks up to this size
+        void SignalsmithStretch::reserveInterleaved(int maxInputSamples, int maxOutputSamples)
+        {
+            planarInputCapacity = (std::max)(planarInputCapacity, maxInputSamples);
+            planarOutputCapacity = (std::max)(planarOutputCapacity, maxOutputSamples);
+            planarInputBuffer.resize(planarInputCapacity * channels);
+            planarOutputBuffer.resize(planarOutputCapacity * channels);
+            planarInputs.resize(channels);
+            planarOutputs.resize(channels);
+            for (int c = 0; c < channels; ++c)
+            {
+                planarInputs[c] = planarInputBuffer.data() + c * planarInputCapacity;
+                planarOutputs[c] = planarOutputBuffer.data() + c * planarOutputCapacity;
+            }
+        }
+
         void SignalsmithStretch::process(
             float *inputs,
             int inputSamples,
             float *outputs,
             int outputSamples)
+        {
+            if (inputSamples > planarInputCapacity || outputSamples > planarOutputCapacity || (int)planarInputs.size() != channels)
+            {
+                reserveInterleaved(inputSamples, outputSamples);
+            }
+            signalsmith::perf::deinterleave(inputs, planarInputs.data(), channels, inputSamples);
+            processPlanar(planarInputs.data(), inputSamples, planarOutputs.data(), outputSamples);
+            signalsmith::perf::interleave(planarOutputs.data(), outputs, channels, outputSamples);
+        }
+
+        void SignalsmithStretch::processPlanar(
+            const float *const *inputs,
+            int inputSamples,
+            float *const *outputs,
+            int outputSamples)
         {
             float totalEnergy = 0;
             for (int c = 0; c < channels; ++c)
             {
-                for (int i = 0; i < inputSamples; ++i)
-                {
-                    float s = (&inputs[0] + c)[i * channels];
-                    totalEnergy += std::pow(s, 2.0f);
-                }
+                totalEnergy += signalsmith::perf::sumSquares(inputs[c], inputSamples);
+            }
+            if (!spareConfigs.empty() && inputSamples > 0)
+            {
+                if (detectOnsets(totalEnergy, inputSamples))
+                    adapt(adaptedRate); // block boundary, and `swapConfig()` crossfades
             }
             if (totalEnergy < noiseFloor)
             {
@@ -263,40 +526,34 @@ namespace signalsmith
                         }
                     }
 
-                    if (inputSamples > 0)
+                    for (int c = 0; c < channels; ++c)
                     {
-                        // copy from the input, wrapping around if needed
-                        for (int outputIndex = 0; outputIndex < outputSamples; ++outputIndex)
+                        const float *inputChannel = inputs[c];
+                        float *outputChannel = outputs[c];
+                        if (inputSamples > 0)
                         {
-                            int inputIndex = outputIndex % inputSamples;
-                            for (int c = 0; c < channels; ++c)
+                            // copy from the input, wrapping around if needed
+                            for (int outputIndex = 0; outputIndex < outputSamples; outputIndex += inputSamples)
                             {
-                                (&outputs[0] + c)[outputIndex * channels] = (&inputs[0] + c)[inputIndex * channels];
+                                int count = std::min<int>(inputSamples, outputSamples - outputIndex);
+                                std::copy(inputChannel, inputChannel + count, outputChannel + outputIndex);
                             }
                         }
-                    }
-                    else
-                    {
-                        for (int c = 0; c < channels; ++c)
+                        else
                         {
-                            // auto &&outputChannel = outputs[c];
-                            for (int outputIndex = 0; outputIndex < outputSamples; ++outputIndex)
-                            {
-                                // outputChannel[outputIndex * channels] = 0;
-                                (&outputs[0] + c)[outputIndex * channels] = 0;
-                            }
+                            std::fill(outputChannel, outputChannel + outputSamples, 0.0f);
                         }
                     }
 
                     // Store input in history buffer
                     for (int c = 0; c < channels; ++c)
                     {
-                        // auto &&inputChannel = inputs[c];
+                        const float *inputChannel = inputs[c];
                         auto &&bufferChannel = inputBuffer[c];
                         int startIndex = std::max<int>(0, inputSamples - stft.windowSize());
                         for (int i = startIndex; i < inputSamples; ++i)
                         {
-                            bufferChannel[i] = (&inputs[0] + c)[i * channels];
+                            bufferChannel[i] = inputChannel[i];
                         }
                     }
                     inputBuffer += inputSamples;
@@ -331,9 +588,9 @@ namespace signalsmith
                                 timeBuffer[i] = bufferChannel[i + inputOffset];
                             }
                             // Copy the rest from the input
-                            // auto &&inputChannel = inputs[c];
+                            const float *inputChannel = inputs[c];
                             for (int i = std::max<int>(0, -inputOffset); i < stft.windowSize(); ++i) {
-                                timeBuffer[i] = (&inputs[0] + c)[(i + inputOffset) * channels]; // inputChannel[i + inputOffset];
+                                timeBuffer[i] = inputChannel[i + inputOffset];
                             }
                             stft.analyse(c, timeBuffer);
                         }
@@ -357,9 +614,9 @@ namespace signalsmith
                                     timeBuffer[i] = bufferChannel[i + prevIntervalOffset];
                                 }
                                 // Copy the rest from the input
-                                // auto &&inputChannel = inputs[c];
+                                const float *inputChannel = inputs[c];
                                 for (int i = (std::max)(0, -prevIntervalOffset); i < stft.windowSize(); ++i) {
-                                    timeBuffer[i] = (&inputs[0] + c)[(i + prevIntervalOffset) * channels]; // inputChannel[i + prevIntervalOffset];
+                                    timeBuffer[i] = inputChannel[i + prevIntervalOffset];
                                 }
                                 stft.analyse(c, timeBuffer);
                             }
@@ -387,22 +644,20 @@ namespace signalsmith
 
                 for (int c = 0; c < channels; ++c)
                 {
-                    // auto &&outputChannel = outputs[c];
                     auto &&stftChannel = stft[c];
-                    // outputChannel[outputIndex] = stftChannel[outputIndex];
-                    (&outputs[0] + c)[outputIndex * channels] = stftChannel[outputIndex];
+                    outputs[c][outputIndex] = stftChannel[outputIndex];
                 }
             }
 
             // Store input in history buffer
             for (int c = 0; c < channels; ++c)
             {
-                // auto &&inputChannel = inputs[c];
+                const float *inputChannel = inputs[c];
                 auto &&bufferChannel = inputBuffer[c];
                 int startIndex = std::max<int>(0, inputSamples - stft.windowSize());
                 for (int i = startIndex; i < inputSamples; ++i)
                 {
-                    bufferChannel[i] = (&inputs[0] + c)[i * channels];
+                    bufferChannel[i] = inputChannel[i];
                 }
             }
             inputBuffer += inputSamples;
@@ -414,6 +669,7 @@ namespace signalsmith
             float *outputs,
             int outputSamples)
         {
+            stft.clearAhead(); // we read the whole partially-summed tail
             int plainOutput = std::min<int>(outputSamples, stft.windowSize());
             int foldedBackOutput = std::min<int>(outputSamples, stft.windowSize() - plainOutput);
 
@@ -491,7 +747,7 @@ namespace signalsmith
             return f * stft.fftSize() - float(0.5);
         }
 
-        SIGNALSMITH_INLINE void SignalsmithStretch::timeShiftPhases(float shiftSamples, std::vector<std::complex<float>> &output) const
+        SIGNALSMITH_INLINE void SignalsmithStretch::timeShiftPhases(float shiftSamples, signalsmith::perf::AlignedVector<std::complex<float>> &output) const
         {
             for (int b = 0; b < bands; ++b)
             {
@@ -506,42 +762,42 @@ namespace signalsmith
         }
 
         template <std::complex<float> Band::*member>
-        SIGNALSMITH_INLINE std::complex<float> getBand(std::vector<Band> &channelBands, int bands, int channel, int index)
+        SIGNALSMITH_INLINE std::complex<float> getBand(signalsmith::perf::AlignedVector<Band> &channelBands, int bands, int channel, int index)
         {
             if (index < 0 || index >= bands)
                 return 0;
             return channelBands[index + channel * bands].*member;
         }
         template <std::complex<float> Band::*member>
-        SIGNALSMITH_INLINE std::complex<float> getFractional(std::vector<Band> &channelBands, int bands, int channel, int lowIndex, float fractional)
+        SIGNALSMITH_INLINE std::complex<float> getFractional(signalsmith::perf::AlignedVector<Band> &channelBands, int bands, int channel, int lowIndex, float fractional)
         {
             std::complex<float> low = getBand<member>(channelBands, bands, channel, lowIndex);
             std::complex<float> high = getBand<member>(channelBands, bands, channel, lowIndex + 1);
             return low + (high - low) * fractional;
         }
         template <std::complex<float> Band::*member>
-        SIGNALSMITH_INLINE std::complex<float> getFractional(std::vector<Band> &channelBands, int bands, int channel, float inputIndex)
+        SIGNALSMITH_INLINE std::complex<float> getFractional(signalsmith::perf::AlignedVector<Band> &channelBands, int bands, int channel, float inputIndex)
         {
             int lowIndex = static_cast<int>(std::floor(inputIndex));
             float fracIndex = inputIndex - lowIndex;
             return getFractional<member>(channelBands, bands, channel, lowIndex, fracIndex);
         }
         template <float Band::*member>
-        SIGNALSMITH_INLINE float getBand(std::vector<Band> &channelBands, int bands, int channel, int index)
+        SIGNALSMITH_INLINE float getBand(signalsmith::perf::AlignedVector<Band> &channelBands, int bands, int channel, int index)
         {
             if (index < 0 || index >= bands)
                 return 0;
             return channelBands[index + channel * bands].*member;
         }
         template <float Band::*member>
-        SIGNALSMITH_INLINE float getFractional(std::vector<Band> &channelBands, int bands, int channel, int lowIndex, float fractional)
+        SIGNALSMITH_INLINE float getFractional(signalsmith::perf::AlignedVector<Band> &channelBands, int bands, int channel, int lowIndex, float fractional)
         {
             float low = getBand<member>(channelBands, bands, channel, lowIndex);
             float high = getBand<member>(channelBands, bands, channel, lowIndex + 1);
             return low + (high - low) * fractional;
         }
         template <float Band::*member>
-        SIGNALSMITH_INLINE float getFractional(std::vector<Band> &channelBands, int bands, int channel, float inputIndex)
+        SIGNALSMITH_INLINE float getFractional(signalsmith::perf::AlignedVector<Band> &channelBands, int bands, int channel, float inputIndex)
         {
             int lowIndex = std::floor(inputIndex);
             float fracIndex = inputIndex - lowIndex;
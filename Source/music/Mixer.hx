@@ -30,9 +30,13 @@ import utils.Tools;
 
 	### Main Methods:
 	- `loadFiles()` – Initialize music from file paths
+	- `loadFromMemory()` / `mountPack()` – Initialize music from bytes or an asset pack
 	- `startMusic()` / `stopMusic()` – Control playback
 	- `destroyMusic()` – Clean up resources
 	- `updateSmoothMusicTime()` – Prevent timing drift
+	- `pollEvents()` – Song end, markers, underruns... once per frame
+	- `setBpmMap()` – Beats, steps and measures straight from the audio clock
+	- `loadSound()` / `playSound()` – Low latency hitsounds on the music's device
 
 	---
 
@@ -77,6 +81,64 @@ class Mixer {
 		return speed;
 	}
 
+	/**
+		Time-stretch quality/latency tradeoff used when `speed` isn't 1. See `StretchPreset`.
+	 */
+	static var stretchPreset(default, set):StretchPreset = CHEAPER;
+
+	static function set_stretchPreset(value:StretchPreset) {
+		MiniAudio.setStretchPreset(value);
+		return stretchPreset = value;
+	}
+
+	/**
+		Seed for the time-stretcher's randomness. With a fixed seed the same song at the same speed always
+		stretches to exactly the same samples, which is what you want for comparing renders. `-1` (default) = random.
+	 */
+	static var stretchSeed(default, set):Int = -1;
+
+	static function set_stretchSeed(value:Int) {
+		MiniAudio.setStretchSeed(value);
+		return stretchSeed = value;
+	}
+
+	/**
+		If true, `speed` changes the pitch along with the tempo (like speeding up a record) instead of time-stretching.
+		Costs a fraction of the stretcher and has no stretch artifacts, but doesn't use the pre-rendered speeds.
+	 */
+	static var varispeed(default, set):Bool = false;
+
+	static function set_varispeed(value:Bool) {
+		MiniAudio.setRateMode(value ? 1 : 0);
+		return varispeed = value;
+	}
+
+	/**
+		Speeds to render ahead of time on background threads once a song is loaded. Switching to one of these
+		is instant and costs nothing on the audio thread, any other speed is still stretched live.
+		Only used while every stem is at full volume. A 3 minute song takes roughly 60MB per speed (more for slower ones).
+	 */
+	static var prerenderSpeeds(default, set):Array<Float> = [];
+
+	static function set_prerenderSpeeds(value:Array<Float>) {
+		MiniAudio.setPrerenderRates(value);
+		return prerenderSpeeds = value;
+	}
+
+	/**
+		Waveform data for editors, built in the background after every load. Read it without copying through
+		`MiniAudio.getStemPeaks()` / `getStemPCM()` (a `cpp.Pointer<Float32>` on hxcpp, `hl.Bytes` on HashLink), which
+		stay null until that stem is done. Peak level `L` has `getStemPeakCount(stem, L)` buckets of `64 << L` frames,
+		each a min and a max for the left then the right channel, so pick the level closest to your pixels per frame.
+		The views belong to the mixer: they're gone after the next `load()`, `destroyMusic()` or change of this.
+	 */
+	static var waveformMode(default, set):WaveformMode = OFF;
+
+	static function set_waveformMode(value:WaveformMode) {
+		MiniAudio.setWaveformMode(value);
+		return waveformMode = value;
+	}
+
 	private static var _time:Float;
 	private static var _length:Float;
 
@@ -85,11 +147,263 @@ class Mixer {
 		return _time = MiniAudio.getPlaybackPosition();
 	}
 
+	/**
+		Loops `startMs` to `endMs` for practice mode. The mixer wraps on the exact frame (at any `speed`) and blends
+		the last `crossfadeMs` into the start so it doesn't click; 0 for a hard cut. Takes a moment to kick in while
+		it decodes the start of the loop. Per song, `clearLoop()` to play on from wherever it is.
+	 */
+	static public function setLoop(startMs:Float, endMs:Float, crossfadeMs:Float = 5):Bool {
+		return MiniAudio.setLoop(Tools.betterInt64FromFloat(startMs * 0.001 * sampleRate), Tools.betterInt64FromFloat(endMs * 0.001 * sampleRate),
+			Std.int(crossfadeMs * 0.001 * sampleRate));
+	}
+
+	static public function clearLoop():Void {
+		MiniAudio.clearLoop();
+	}
+
 	static public function load(files:Array<String>):Void { // Don't rename this to `loadFiles` as it will conflict with the MiniAudio extern class
 		MiniAudio.loadFiles(files);
+		loadedBytes = null;
 		_length = MiniAudio.getDuration();
 	}
 
+	/**
+		Same as `load()`, but the stems are already in memory (downloaded, decrypted, unpacked by the game...).
+		The decoders read straight out of the bytes, so the mixer keeps hold of them until the next load or
+		`destroyMusic()`. Don't change them in the meantime.
+	 */
+	static public function loadFromMemory(stems:Array<haxe.io.Bytes>):Void {
+		MiniAudio.loadFromMemory(stems);
+		loadedBytes = stems.copy();
+		_length = MiniAudio.getDuration();
+	}
+
+	private static var loadedBytes:Array<haxe.io.Bytes> = null;
+
+	/**
+		Maps one big asset pack file, so songs inside it stream straight out of the mapping instead of each stem being
+		opened as a separate file. Describe where the files are with `addPackEntry()`, then `load()` them by those names;
+		anything not in the pack is still loaded from disk. Mounting replaces the previous pack and its entries.
+		Can't be done while a song is loaded, call `destroyMusic()` first.
+	 */
+	static public function mountPack(path:String):Bool {
+		return MiniAudio.mountPack(path);
+	}
+
+	/**
+		Registers the file `name` as `size` bytes starting at `offset` in the mounted pack.
+		Returns false if there's no pack or it doesn't fit in it.
+	 */
+	static public function addPackEntry(name:String, offset:Float, size:Float):Bool {
+		return MiniAudio.addPackEntry(name, Tools.betterInt64FromFloat(offset), Tools.betterInt64FromFloat(size));
+	}
+
+	static public function unmountPack():Void {
+		MiniAudio.unmountPack();
+	}
+
+	/**
+		Decodes a sound effect (hitsound, miss sound...) into memory, from a file or the mounted pack, and returns its
+		id for `playSound()`, or -1. Sounds stay loaded across songs until `unloadSound()`.
+	 */
+	static public function loadSound(path:String):Int {
+		return MiniAudio.loadSfx(path);
+	}
+
+	/**
+		Same as `loadSound()` from an encoded file's bytes, which can be let go of straight away.
+	 */
+	static public function loadSoundFromBytes(bytes:haxe.io.Bytes):Int {
+		return MiniAudio.loadSfxFromMemory(bytes);
+	}
+
+	static public function unloadSound(id:Int):Void {
+		MiniAudio.unloadSfx(id);
+	}
+
+	/**
+		Plays a loaded sound through the music's own device, on top of the music and unaffected by `speed`. Never
+		locks or allocates, so it's fine for every hit. With `timeMs` it starts exactly when the song gets there
+		instead of right away, scheduled sounds that haven't started yet are dropped on a seek.
+		`pan` goes from -1 (left) to 1 (right). Only heard while a song is loaded and started. Up to 32 play at once,
+		past that the oldest one is cut off.
+	 */
+	static public function playSound(id:Int, gain:Float = 1, pan:Float = 0, timeMs:Float = -1):Bool {
+		var frame = timeMs < 0 ? -1 : timeMs * 0.001 * sampleRate;
+		return MiniAudio.playSfx(id, gain, pan, Tools.betterInt64FromFloat(frame));
+	}
+
+	static public function stopSounds():Void {
+		MiniAudio.stopSfx();
+	}
+
+	/**
+		Previews a song in the song select menu without loading it: its stems (files or pack entries) open straight
+		at `startMs` on a worker and fade in over `fadeMs`, while the previous preview fades out. Call it every time
+		the selection moves, a preview that's replaced before it opens is never heard. Plays on its own device next to
+		whatever's loaded, and stops at the end of the song. The first call opens that device, `closePreview()`
+		closes it again when leaving the menu.
+	 */
+	static public function previewSong(files:Array<String>, startMs:Float = 0, fadeMs:Float = 250):Bool {
+		return MiniAudio.previewFiles(files, Tools.betterInt64FromFloat(startMs * 0.001 * sampleRate), Std.int(fadeMs * 0.001 * sampleRate));
+	}
+
+	static public function stopPreview(fadeMs:Float = 250):Void {
+		MiniAudio.stopPreview(Std.int(fadeMs * 0.001 * sampleRate));
+	}
+
+	static public function closePreview():Void {
+		MiniAudio.closePreview();
+	}
+
+	/**
+		Level meters as `[peak, hold, rms, peak, hold, rms, ...]` (linear, 1 = full scale): one set per stem in the
+		order they were loaded, then one for the whole mix. The peak falls back over 1.5s, the hold is the loudest
+		peak of the last second and the RMS covers the last 300ms. Stems read 0 while a pre-rendered speed plays.
+		Cheap enough to call every frame, it only copies what the audio thread last published. The array is reused.
+	 */
+	static function getStemMeters():Array<Float> {
+		var count = MiniAudio.getStemMeters(stemMeters);
+		if (stemMeters.length > count * 3) {
+			stemMeters.resize(count * 3);
+		}
+		return stemMeters;
+	}
+
+	private static var stemMeters:Array<Float> = [];
+
+	/**
+		Position, interpolated time, state, speed, duration, underrun counters and every stem's state and levels in
+		one native call, all from the same audio callback. Doesn't wait on the audio thread, so it's the cheapest way
+		to poll the mixer every frame. See `MixerSnapshot`. The snapshot is reused, read what you need straight away.
+	 */
+	static function snapshot():MixerSnapshot {
+		MiniAudio.getSnapshot(snapshotData);
+		return snapshotData;
+	}
+
+	private static var snapshotData:Array<Float> = [];
+
+	/**
+		How long the audio callback has been taking, as JSON to send along with a bug report: how many callbacks ran,
+		how many used over half, three quarters and all of their time (`missed` ones are audible), how many came after
+		a gap, and for the decode, mix, stretch and effects stages and the whole callback the mean, the worst and a
+		histogram in microseconds (bucket `i` starts at `bucketsUs[i]`). Always collected, kept across songs until
+		`resetTelemetry()`.
+	 */
+	static public function telemetryJson():String {
+		return MiniAudio.getTelemetryJson();
+	}
+
+	static public function resetTelemetry():Void {
+		MiniAudio.resetTelemetry();
+	}
+
+	/**
+		Everything that happened since the last call, oldest first: the song or a stem finishing, underruns, seeks,
+		loop points and markers, each with the exact frame of the song it happened at. Call it once per frame instead
+		of watching `MiniAudio.getMixerState()` for changes, nothing gets missed between two frames.
+		The events are reused, read what you need straight away.
+	 */
+	static function pollEvents():MixerEvents {
+		eventData.resize(MAX_EVENTS_PER_POLL * 3);
+		var count = MiniAudio.pollEvents(eventData);
+		eventData.resize(count * 3);
+		return eventData;
+	}
+
+	private static inline var MAX_EVENTS_PER_POLL:Int = 256; // Same as the native queue, anything past it waits for the next poll
+	private static var eventData:Array<Float> = [];
+
+	/**
+		Queues a `MARKER` event with `id` once playback passes `timeMs`. Seeking over it doesn't count.
+		Markers are per song, set them after `load()`.
+	 */
+	static public function addMarker(id:Int, timeMs:Float):Void {
+		MiniAudio.addMarker(id, Tools.betterInt64FromFloat(timeMs * 0.001 * sampleRate));
+	}
+
+	static public function clearMarkers():Void {
+		MiniAudio.clearMarkers();
+	}
+
+	/**
+		Gives the mixer the song's BPM and time signature changes, so `snapshot()` has the current beat, step and
+		measure (worked out from the frame being played, so they never drift from the audio) and `pollEvents()` can
+		send `BEAT` / `STEP` events on the exact frame, whatever the speed. Missing time signatures are 4/4.
+		The map is per song, set it after `load()`. An empty one turns it off.
+	 */
+	static public function setBpmMap(changes:Array<BpmChange>):Void {
+		var flat:Array<Float> = [];
+		for (change in changes) {
+			flat.push(change.time);
+			flat.push(change.bpm);
+			flat.push(change.numerator != null ? change.numerator : 4);
+			flat.push(change.denominator != null ? change.denominator : 4);
+		}
+		MiniAudio.setConductorMap(flat);
+	}
+
+	/**
+		Which of the BPM map's beats and steps show up in `pollEvents()`. See `ConductorTicks`.
+	 */
+	static var conductorTicks(default, set):ConductorTicks = OFF;
+
+	static function set_conductorTicks(value:ConductorTicks) {
+		MiniAudio.setConductorTicks(value);
+		return conductorTicks = value;
+	}
+
+	/**
+		-1 (left) to 1 (right), as a balance: a stereo stem panned left fades its right channel out.
+		Panned stems can't use the pre-rendered speeds.
+	 */
+	static public function setStemPan(index:Int, pan:Float):Void {
+		MiniAudio.setStemPan(index, pan);
+	}
+
+	/**
+		Silences a stem but keeps it playing, so unmuting brings it straight back in time.
+	 */
+	static public function setStemMute(index:Int, muted:Bool):Void {
+		MiniAudio.setStemMute(index, muted);
+	}
+
+	/**
+		Schedules a change at `timeMs` in the song, exact to the frame instead of to the next audio callback: vocal
+		drop-outs, speed ramps... `index` is the stem (ignored for `SPEED`). Never blocks.
+		Changes already passed happen straight away (so seeking forward catches up), each happens once (schedule it
+		again after seeking back). They're per song, schedule them after `load()`. `speed` doesn't follow `SPEED`
+		changes, `snapshot().speed` does.
+	 */
+	static public function scheduleChange(type:ScheduledChange, index:Int, value:Float, timeMs:Float):Bool {
+		if (type == SPEED) value = Math.max(value, 0.1);
+		return MiniAudio.scheduleChange(type, index, value, Tools.betterInt64FromFloat(timeMs * 0.001 * sampleRate));
+	}
+
+	static public function clearScheduledChanges():Void {
+		MiniAudio.clearSchedule();
+	}
+
+	/**
+		Puts an EQ filter on one stem, e.g. `setStemFilter(0, HIGH_PASS, 120)` to take the rumble out of a vocal stem or
+		`setStemFilter(1, LOW_SHELF, 200, -4)` to make room for it in the instrumental. `OFF` removes it again.
+		`gainDb` only matters for the shelves and `PEAK`, `q` <= 0 uses the default (0.7071).
+		Filtered stems can't use the pre-rendered speeds.
+	 */
+	static public function setStemFilter(index:Int, type:StemFilter, frequency:Float, gainDb:Float = 0, q:Float = 0):Void {
+		MiniAudio.setStemFilter(index, type, frequency, gainDb, q);
+	}
+
+	/**
+		Reverb on the whole mix, e.g. `setReverb(LIGHT, 0.3)`. `send` is how much of the mix goes into it, `roomMs`
+		(up to 200) how big it sounds, `decaySeconds` how long the tail takes to die down by 60dB and `dampingHz`
+		where the tail starts getting darker. `DENSE` sounds smoother but costs about twice as much.
+	 */
+	static public function setReverb(quality:ReverbQuality, send:Float, roomMs:Float = 100, decaySeconds:Float = 2, dampingHz:Float = 6000):Void {
+		MiniAudio.setReverb(quality, send, roomMs, decaySeconds, dampingHz);
+	}
+
 	static public function startMusic():Void {
 		// Can't do it in pure c++ on hl so I removed this exact code from the hxcpp version to put this in here.
 		if (MiniAudio.getMixerState() == MixerState.FINISHED) {
@@ -104,11 +418,13 @@ class Mixer {
 
 	static public function destroyMusic():Void {
 		MiniAudio.destroy();
+		loadedBytes = null;
 	}
 
 	static public function updateSmoothMusicTime(deltaTime:Float):Void {
-		if (isPlaying()) {
-			var rawPlaybackPosition = MiniAudio.getPlaybackPosition();
+		var snap = snapshot();
+		if (snap.state == MixerState.PLAYING) {
+			var rawPlaybackPosition = snap.position;
 			_time += deltaTime;
 			var multiply = 0.01; // Default drift adjustment value
 			if (_time > rawPlaybackPosition) {
@@ -141,4 +457,267 @@ enum abstract MixerState(Int) from Int to Int {
 	var PLAYING = 1;
 	var STOPPED = 2;
 	var FINISHED = 3;
+}
+
+enum abstract StretchPreset(Int) from Int to Int {
+	/**
+		- `0` - Cheaper (100ms blocks, the default)
+		- `1` - Default (120ms blocks, best quality)
+		- `2` - Low latency (60ms blocks)
+		- `3` - Lowest latency (40ms blocks)
+		- `4` - Adaptive (small blocks near 1x or for percussive songs, bigger ones for extreme rates)
+	 */
+	var CHEAPER = 0;
+	var DEFAULT = 1;
+	var LOW_LATENCY = 2;
+	var LOWEST_LATENCY = 3;
+	var ADAPTIVE = 4;
+}
+
+enum abstract StemFilter(Int) from Int to Int {
+	/**
+		- `0` - Off
+		- `1` - High pass
+		- `2` - Low pass
+		- `3` - Low shelf
+		- `4` - High shelf
+		- `5` - Peak
+	 */
+	var OFF = 0;
+	var HIGH_PASS = 1;
+	var LOW_PASS = 2;
+	var LOW_SHELF = 3;
+	var HIGH_SHELF = 4;
+	var PEAK = 5;
+}
+
+enum abstract ReverbQuality(Int) from Int to Int {
+	/**
+		- `0` - Off
+		- `1` - Light (8 channel feedback delay network)
+		- `2` - Dense (16 channels)
+	 */
+	var OFF = 0;
+	var LIGHT = 1;
+	var DENSE = 2;
+}
+
+enum abstract WaveformMode(Int) from Int to Int {
+	/**
+		- `0` - Off
+		- `1` - Peaks (min/max pyramid per stem, a few hundred KB for a song)
+		- `2` - Peaks and PCM (also keeps every stem decoded in memory, about 10MB per stem per minute)
+	 */
+	var OFF = 0;
+	var PEAKS = 1;
+	var PEAKS_AND_PCM = 2;
+}
+
+enum abstract MixerEventType(Int) from Int to Int {
+	/**
+		- `0` - Song finished (the longest stem ran out)
+		- `1` - Stem finished (`index` is the stem)
+		- `2` - Underrun (`index` is 0 for a callback that took too long, 1 for a gap between callbacks)
+		- `3` - Seek completed
+		- `4` - Loop point reached (`index` is how many times it has looped, `frame` is the loop's end)
+		- `5` - Marker hit (`index` is the id given to `Mixer.addMarker()`)
+		- `6` - Beat (`index` is the beat number, see `Mixer.setBpmMap()`)
+		- `7` - Step (`index` is the step number)
+	 */
+	var SONG_FINISHED = 0;
+	var STEM_FINISHED = 1;
+	var UNDERRUN = 2;
+	var SEEK_COMPLETED = 3;
+	var LOOP_POINT = 4;
+	var MARKER = 5;
+	var BEAT = 6;
+	var STEP = 7;
+}
+
+enum abstract ScheduledChange(Int) from Int to Int {
+	/**
+		- `0` - Volume (linear)
+		- `1` - Mute (1 mutes, 0 unmutes)
+		- `2` - Speed
+		- `3` - Pan (-1 left to 1 right)
+	 */
+	var VOLUME = 0;
+	var MUTE = 1;
+	var SPEED = 2;
+	var PAN = 3;
+}
+
+enum abstract ConductorTicks(Int) from Int to Int {
+	/**
+		- `0` - Off
+		- `1` - Beats
+		- `2` - Beats and steps
+	 */
+	var OFF = 0;
+	var BEATS = 1;
+	var BEATS_AND_STEPS = 2;
+}
+
+/**
+	One change in `Mixer.setBpmMap()`, from `time` (ms) on.
+ */
+typedef BpmChange = {
+	var time:Float;
+	var bpm:Float;
+	var ?numerator:Int;
+	var ?denominator:Int;
+}
+
+/**
+	What `Mixer.pollEvents()` returns: `length` events, oldest first.
+ */
+abstract MixerEvents(Array<Float>) from Array<Float> {
+	public var length(get, never):Int;
+
+	inline function get_length() {
+		return Std.int(this.length / 3);
+	}
+
+	public inline function type(i:Int):MixerEventType {
+		return Std.int(this[i * 3]);
+	}
+
+	public inline function index(i:Int):Int {
+		return Std.int(this[i * 3 + 1]);
+	}
+
+	/**
+		The frame of the song it happened at. Events come out of the audio thread as it mixes, so up to a buffer before
+		you hear that frame.
+	 */
+	public inline function frame(i:Int):Float {
+		return this[i * 3 + 2];
+	}
+
+	/**
+		Same as `frame()`, in milliseconds.
+	 */
+	public inline function time(i:Int):Float {
+		return this[i * 3 + 2] / (Mixer.sampleRate * 0.001);
+	}
+}
+
+/**
+	One reading of the mixer, see `Mixer.snapshot()`. Times are in milliseconds, levels are linear (1 = full scale).
+	Stems are indexed in the order they were loaded, and index `stemCount` is the whole mix.
+ */
+abstract MixerSnapshot(Array<Float>) from Array<Float> {
+	static inline var HEADER_SIZE:Int = 12;
+	static inline var STEM_SIZE:Int = 5;
+
+	/**
+		Where the decoders had got to, same as `MiniAudio.getPlaybackPosition()`. Runs a buffer ahead of what you hear.
+	 */
+	public var position(get, never):Float;
+
+	inline function get_position() {
+		return this[0];
+	}
+
+	/**
+		Smooth playback time: moves from the start to the end of the last callback's audio while it plays.
+	 */
+	public var time(get, never):Float;
+
+	inline function get_time() {
+		return this[1];
+	}
+
+	public var state(get, never):MixerState;
+
+	inline function get_state() {
+		return Std.int(this[2]);
+	}
+
+	public var speed(get, never):Float;
+
+	inline function get_speed() {
+		return this[3];
+	}
+
+	public var duration(get, never):Float;
+
+	inline function get_duration() {
+		return this[4];
+	}
+
+	/**
+		Callbacks that took longer than the audio they produced, since the song was loaded. Each one is probably a dropout.
+	 */
+	public var lateCallbacks(get, never):Int;
+
+	inline function get_lateCallbacks() {
+		return Std.int(this[5]);
+	}
+
+	/**
+		Times the device left more than twice a callback's length between two callbacks, since the song was loaded.
+	 */
+	public var callbackGaps(get, never):Int;
+
+	inline function get_callbackGaps() {
+		return Std.int(this[6]);
+	}
+
+	public var stemCount(get, never):Int;
+
+	inline function get_stemCount() {
+		return Std.int(this[7]);
+	}
+
+	/**
+		Position in the BPM map, moving along with `time`. All 0 until `Mixer.setBpmMap()` is called.
+		`step` and `measure` follow the time signature, so after a change they keep counting from where they were.
+	 */
+	public var beat(get, never):Float;
+
+	inline function get_beat() {
+		return this[8];
+	}
+
+	public var step(get, never):Float;
+
+	inline function get_step() {
+		return this[9];
+	}
+
+	public var measure(get, never):Float;
+
+	inline function get_measure() {
+		return this[10];
+	}
+
+	public var bpm(get, never):Float;
+
+	inline function get_bpm() {
+		return this[11];
+	}
+
+	public inline function stemActive(index:Int):Bool {
+		return this[HEADER_SIZE + index * STEM_SIZE] != 0;
+	}
+
+	public inline function stemVolume(index:Int):Float {
+		return this[HEADER_SIZE + index * STEM_SIZE + 1];
+	}
+
+	/**
+		Same as the peak in `Mixer.getStemMeters()`, and likewise for `stemHold()` and `stemRms()`.
+	 */
+	public inline function stemPeak(index:Int):Float {
+		return this[HEADER_SIZE + index * STEM_SIZE + 2];
+	}
+
+	public inline function stemHold(index:Int):Float {
+		return this[HEADER_SIZE + index * STEM_SIZE + 3];
+	}
+
+	public inline function stemRms(index:Int):Float {
+		return this[HEADER_SIZE + index * STEM_SIZE + 4];
+	}
 }
\ No newline at end of file
@@ -0,0 +1,149 @@
+/*
+	* Conductor::pushTicks() on a map that changes BPM and time signature twice, checked against tick frames worked out
+	* by hand: every beat and step, each on the first frame at or after it, numbered on across the changes.
+
+	* The mixer asks for the ticks of whatever song frames each callback played, and how many that is depends on the
+	* playback rate. So the same song is also fed through in chunks sized like callbacks at a changing rate (and in
+	* single frames), which must give exactly the same ticks: none missed or doubled where two chunks meet.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "miniaudio.h"
+#include "ma_events.h"
+#include "ma_conductor.h"
+
+#define SAMPLE_RATE 44100
+
+static const ma_uint64 songFrames = 300000;
+
+// Out of order, setMap() sorts them: timeMs, bpm, numerator, denominator
+static const double changes[] = {
+	2000, 150, 3, 4, // Frame 88200, beat 4, step 16, measure 1
+	0, 120, 4, 4,
+	5000, 90, 6, 8, // Frame 220500, beat 11.5, step 46, measure 3.5: halfway through a beat, on a step
+};
+
+// Song frames per 441 frame callback are 441 times these. The timeline also splits callbacks, down to a frame
+static const double callbackRates[] = {1.0, 0.5, 1.37, 2.0, 0.75, 1.1};
+
+// A run of ticks at a steady tempo: tick `first` at frame `from`, one every `spacing` frames, up to `to`
+struct TickRun {
+	int first;
+	double from, spacing, to;
+};
+
+static const TickRun beatRuns[] = {
+	{0, 0, 22050, 88200}, // 120 BPM
+	{4, 88200, 17640, 220500}, // 150 BPM
+	{12, 235200, 29400, songFrames}, // 90 BPM, from the first whole beat after the change
+};
+static const TickRun stepRuns[] = {
+	{0, 0, 5512.5, 88200}, // 4 steps per beat, on half frames
+	{16, 88200, 4410, 220500},
+	{46, 220500, 14700, songFrames}, // x/8: 2 steps per beat
+};
+
+struct Tick {
+	int index;
+	ma_uint64 frame;
+};
+
+static std::vector<Tick> expectedTicks(const TickRun* runs, int runCount) {
+	std::vector<Tick> ticks;
+	for (int r = 0; r < runCount; ++r) {
+		for (int n = 0; runs[r].from + n * runs[r].spacing < runs[r].to; ++n) {
+			ticks.push_back(Tick{runs[r].first + n, (ma_uint64)std::ceil(runs[r].from + n * runs[r].spacing)});
+		}
+	}
+	return ticks;
+}
+
+// The whole song in chunks of `chunkFrames(i)` frames, draining the queue after each like the game would
+template<class ChunkFrames>
+static std::vector<Tick> collectTicks(const Conductor& conductor, bool steps, ChunkFrames chunkFrames) {
+	std::vector<Tick> ticks;
+	EventQueue queue;
+	double out[EventQueue::capacity * EventQueue::eventSize];
+	ma_uint64 frame = 0;
+	for (int i = 0; frame < songFrames; ++i) {
+		ma_uint64 end = std::min(songFrames, frame + chunkFrames(i));
+		conductor.pushTicks(queue, steps ? 7 : 6, steps, frame, end);
+		int count = queue.drain(out, EventQueue::capacity * EventQueue::eventSize);
+		for (int e = 0; e < count; ++e) {
+			ticks.push_back(Tick{(int)out[e * 3 + 1], (ma_uint64)out[e * 3 + 2]});
+		}
+		frame = end;
+	}
+	return ticks;
+}
+
+static bool sameTicks(const std::vector<Tick>& got, const std::vector<Tick>& expected, int& firstWrong) {
+	firstWrong = -1;
+	for (size_t i = 0; i < std::max(got.size(), expected.size()); ++i) {
+		if (i >= got.size() || i >= expected.size() || got[i].index != expected[i].index || got[i].frame != expected[i].frame) {
+			firstWrong = (int)i;
+			return false;
+		}
+	}
+	return true;
+}
+
+int main() {
+	Conductor conductor;
+	conductor.setMap(changes, 3, SAMPLE_RATE);
+	int failures = 0;
+
+	// Callback-sized chunks at a rate that keeps changing, and a frame at a time
+	struct Chunking {
+		const char* name;
+		ma_uint64 (*frames)(int);
+	};
+	const Chunking chunkings[] = {
+		{"whole song", [](int) -> ma_uint64 { return songFrames; }},
+		{"441 frames", [](int) -> ma_uint64 { return 441; }},
+		{"changing rates", [](int i) -> ma_uint64 { return i % 7 == 3 ? 1 : (ma_uint64)std::lround(441 * callbackRates[i % 6]); }},
+		{"single frames", [](int) -> ma_uint64 { return 1; }},
+	};
+
+	for (int steps = 0; steps < 2; ++steps) {
+		std::vector<Tick> expected = steps ? expectedTicks(stepRuns, 3) : expectedTicks(beatRuns, 3);
+		for (const Chunking& chunking : chunkings) {
+			std::vector<Tick> got = collectTicks(conductor, steps != 0, chunking.frames);
+			int firstWrong;
+			bool pass = sameTicks(got, expected, firstWrong);
+			printf("%-6s %-16s %s: %zu ticks of %zu", steps ? "steps" : "beats", chunking.name, pass ? "ok" : "FAIL", got.size(), expected.size());
+			if (!pass && firstWrong >= 0 && (size_t)firstWrong < got.size()) {
+				printf(", #%d is %d at %llu", firstWrong, got[firstWrong].index, (unsigned long long)got[firstWrong].frame);
+			}
+			printf("\n");
+			if (!pass) ++failures;
+		}
+	}
+
+	// Where the sections start, in measures, and what at() reports inside them
+	struct Expected {
+		double frame, beat, step, measure, bpm;
+		int beatsPerMeasure, stepsPerBeat;
+	};
+	const Expected positions[] = {
+		{-22050, -1, -4, -0.25, 120, 4, 4},
+		{44100, 2, 8, 0.5, 120, 4, 4},
+		{88200, 4, 16, 1, 150, 3, 4},
+		{220500, 11.5, 46, 3.5, 90, 6, 2},
+		{235200, 12, 47, 3.5 + 0.5 / 6, 90, 6, 2},
+	};
+	for (const Expected& want : positions) {
+		Conductor::Position position = conductor.at(want.frame);
+		bool pass = std::fabs(position.beat - want.beat) < 1e-9 && std::fabs(position.step - want.step) < 1e-9 &&
+			std::fabs(position.measure - want.measure) < 1e-9 && position.bpm == want.bpm &&
+			position.beatsPerMeasure == want.beatsPerMeasure && position.stepsPerBeat == want.stepsPerBeat;
+		printf("at %-8.0f %s: beat %g, step %g, measure %g, %g BPM, %d beats per measure, %d steps per beat\n", want.frame, pass ? "ok" : "FAIL",
+			position.beat, position.step, position.measure, position.bpm, position.beatsPerMeasure, position.stepsPerBeat);
+		if (!pass) ++failures;
+	}
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,139 @@
+/*
+	* Times the FFTs the stretcher actually runs: the real FFT each preset's STFT uses (forward and inverse, like a
+	* block of analysis and synthesis), and the complex FFT inside it, plus a few sizes with a factor of 5 for the
+	* radix-5 kernel. Every complex size is checked against a double-precision DFT first, so a fast wrong kernel fails.
+
+	* fft_bench          about a quarter of a second per size, the best time of many batches
+	* fft_bench --quick  just the accuracy checks and one pass, for ctest
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "signalsmith-stretch.h"
+
+#define SAMPLE_RATE 44100
+
+typedef std::complex<float> Complex;
+
+struct PresetWindow {
+	const char* name;
+	float blockSeconds, intervalSeconds;
+};
+// The same as the presets in signalsmith-stretch.h, the adaptive one switches between these
+static const PresetWindow presetWindows[] = {
+	{"lowestlatency", 0.04f, 0.01f},
+	{"lowlatency", 0.06f, 0.02f},
+	{"cheaper", 0.1f, 0.04f},
+	{"default", 0.12f, 0.03f},
+};
+static const int extraSizes[] = {640, 1280, 2560}; // 5*2^n, only reached outside the presets
+
+static unsigned int lcg = 1;
+static float noise() {
+	lcg = lcg * 1664525u + 1013904223u;
+	return (float)(lcg >> 8) / (1 << 24) - 0.5f;
+}
+
+// Relative RMS error of the complex FFT against a direct DFT in doubles
+static double fftError(int size) {
+	std::vector<Complex> input(size), output(size);
+	for (Complex& c : input) c = {noise(), noise()};
+	signalsmith::fft::FFT<float> fft(size);
+	fft.fft(input.data(), output.data());
+
+	double errorSum = 0, energySum = 0;
+	for (int k = 0; k < size; ++k) {
+		std::complex<double> sum = 0;
+		for (int n = 0; n < size; ++n) {
+			double phase = -2 * M_PI * (double)((long long)k * n % size) / size;
+			sum += std::complex<double>(input[n].real(), input[n].imag()) * std::polar(1.0, phase);
+		}
+		errorSum += std::norm(sum - std::complex<double>(output[k].real(), output[k].imag()));
+		energySum += std::norm(sum);
+	}
+	return std::sqrt(errorSum / energySum);
+}
+
+// The fastest of many short batches, which shrugs off whatever else the machine is doing better than an average does
+template<class Fn>
+static double nsPerCall(Fn&& fn, double seconds) {
+	fn(); // Warm up
+	double best = 1e30, elapsed = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	do {
+		std::chrono::steady_clock::time_point batchStart = std::chrono::steady_clock::now();
+		for (int i = 0; i < 8; ++i) fn();
+		std::chrono::steady_clock::time_point batchEnd = std::chrono::steady_clock::now();
+		best = std::min(best, std::chrono::duration<double>(batchEnd - batchStart).count() / 8);
+		elapsed = std::chrono::duration<double>(batchEnd - start).count();
+	} while (elapsed < seconds);
+	return best * 1e9;
+}
+
+static double complexNs(int size, double seconds) {
+	std::vector<Complex> input(size), output(size);
+	for (Complex& c : input) c = {noise(), noise()};
+	signalsmith::fft::FFT<float> fft(size);
+	return nsPerCall([&]() {
+		fft.fft(input.data(), output.data());
+	}, seconds);
+}
+
+// Forward and inverse, like one STFT block
+static double realNs(int size, double seconds) {
+	std::vector<float> time(size), back(size);
+	std::vector<Complex> spectrum(size / 2);
+	for (float& v : time) v = noise();
+	signalsmith::fft::ModifiedRealFFT<float> fft(size);
+	return nsPerCall([&]() {
+		fft.fft(time.data(), spectrum.data());
+		fft.ifft(spectrum.data(), back.data());
+	}, seconds);
+}
+
+static const char* factorString(int size) {
+	static char text[64];
+	int twos = 0, threes = 0, fives = 0;
+	while (size % 2 == 0) { size /= 2; ++twos; }
+	while (size % 3 == 0) { size /= 3; ++threes; }
+	while (size % 5 == 0) { size /= 5; ++fives; }
+	snprintf(text, sizeof(text), "2^%d*3^%d*5^%d%s", twos, threes, fives, size > 1 ? "*?" : "");
+	return text;
+}
+
+int main(int argc, char** argv) {
+	bool quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+	double seconds = quick ? 0 : 0.25;
+	int failures = 0;
+
+	printf("%-14s %6s %6s %-12s %11s %12s %10s %s\n", "preset", "window", "fft", "factors", "real f+i ns", "complex ns", "ns/NlogN", "error");
+	for (const PresetWindow& preset : presetWindows) {
+		int window = (int)(SAMPLE_RATE * preset.blockSeconds);
+		signalsmith::spectral::STFT<float> stft;
+		stft.resize(1, window, (int)(SAMPLE_RATE * preset.intervalSeconds));
+		int fftSize = stft.fftSize();
+		int complexSize = fftSize / 2; // What the real FFT runs inside
+
+		double error = fftError(complexSize);
+		double real = realNs(fftSize, seconds);
+		double complex = complexNs(complexSize, seconds);
+		printf("%-14s %6d %6d %-12s %11.0f %12.0f %10.3f %.1e\n", preset.name, window, fftSize, factorString(complexSize),
+			real, complex, complex / (complexSize * std::log2((double)complexSize)), error);
+		if (error > 1e-5) ++failures;
+	}
+	for (int size : extraSizes) {
+		double error = fftError(size);
+		double complex = complexNs(size, seconds);
+		printf("%-14s %6s %6d %-12s %11s %12.0f %10.3f %.1e\n", "-", "-", size, factorString(size), "-", complex,
+			complex / (size * std::log2((double)size)), error);
+		if (error > 1e-5) ++failures;
+	}
+	if (failures > 0) printf("%d sizes were inaccurate\n", failures);
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,235 @@
+/*
+	* LoopRegion on a synthetic stem, checked sample for sample against a plain decode of it: the frame it wraps on, the
+	* crossfade gains, and for a loop longer than the window the handoff from the window to a tail, pass after pass,
+	* without the stem's own decoder being seeked. Then the whole engine through ma_mixer.h on the null backend, for the
+	* LOOP_POINT events.
+
+	* The stem is a sawtooth ramp at 48kHz, so the decoders resample it and anything that seeked instead of decoding its
+	* way to a frame would land off the reference.
+*/
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "signalsmith-stretch/dsp/rates.h"
+#include "miniaudio.h" // The implementation comes with the mixer library
+#include "ma_resampler.h"
+#include "ma_sources.h"
+#include "ma_loop.h"
+#include "ma_mixer.h"
+
+#define SAMPLE_RATE 44100
+#define CHANNEL_COUNT 2
+
+static const int stemRate = 48000;
+static const int stemSeconds = 40;
+
+static void putU32(std::vector<unsigned char>& out, unsigned int value, int bytes) {
+	for (int i = 0; i < bytes; ++i) out.push_back((unsigned char)(value >> (8 * i)));
+}
+
+// A 32-bit float WAV, rising on the left and falling on the right every 1000 frames
+static std::vector<unsigned char> makeRamp() {
+	int frames = stemSeconds * stemRate;
+	std::vector<unsigned char> wav;
+	wav.insert(wav.end(), {'R', 'I', 'F', 'F'});
+	putU32(wav, 36 + frames * CHANNEL_COUNT * 4, 4);
+	wav.insert(wav.end(), {'W', 'A', 'V', 'E', 'f', 'm', 't', ' '});
+	putU32(wav, 16, 4);
+	putU32(wav, 3, 2); // IEEE float
+	putU32(wav, CHANNEL_COUNT, 2);
+	putU32(wav, stemRate, 4);
+	putU32(wav, stemRate * CHANNEL_COUNT * 4, 4);
+	putU32(wav, CHANNEL_COUNT * 4, 2);
+	putU32(wav, 32, 2);
+	wav.insert(wav.end(), {'d', 'a', 't', 'a'});
+	putU32(wav, frames * CHANNEL_COUNT * 4, 4);
+	for (int f = 0; f < frames; ++f) {
+		float value = (float)(f % 1000) / 1000 - 0.5f, pair[2] = {value, -value};
+		unsigned int bits[2];
+		memcpy(bits, pair, sizeof(pair));
+		putU32(wav, bits[0], 4);
+		putU32(wav, bits[1], 4);
+	}
+	return wav;
+}
+
+// Opens `source` the way the mixer does and reads up to `frame`, instead of seeking
+static bool openAt(const StemSource& source, ma_decoder* pDecoder, ma_uint64 frame) {
+	ma_decoder_config config = polyphase_decoder_config_init(ma_format_f32, CHANNEL_COUNT, SAMPLE_RATE);
+	if (source.open(&config, pDecoder) != MA_SUCCESS) return false;
+	std::vector<float> skip(4096 * CHANNEL_COUNT);
+	for (ma_uint64 skipped = 0; skipped < frame;) {
+		ma_uint64 framesRead = 0;
+		ma_decoder_read_pcm_frames(pDecoder, skip.data(), std::min<ma_uint64>(4096, frame - skipped), &framesRead);
+		if (framesRead == 0) return false;
+		skipped += framesRead;
+	}
+	return true;
+}
+
+// Everything the decoders play, start to end
+static std::vector<float> decodeAll(const StemSource& source) {
+	std::vector<float> pcm;
+	ma_decoder decoder;
+	if (!openAt(source, &decoder, 0)) return pcm;
+	float block[4096 * CHANNEL_COUNT];
+	for (;;) {
+		ma_uint64 framesRead = 0;
+		ma_decoder_read_pcm_frames(&decoder, block, 4096, &framesRead);
+		if (framesRead == 0) break;
+		pcm.insert(pcm.end(), block, block + framesRead * CHANNEL_COUNT);
+	}
+	ma_decoder_uninit(&decoder);
+	return pcm;
+}
+
+// Up to 30 seconds, the worker is slow in a debug or sanitizer build
+template<class Condition>
+static bool waitFor(Condition condition) {
+	for (int waited = 0; !condition() && waited < 3000; ++waited) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	return condition();
+}
+
+struct LoopCase {
+	const char* name;
+	ma_uint64 startFrame, endFrame;
+	ma_uint32 crossfade;
+	int passes;
+};
+
+/*
+* Loops one stem from a little before the end for `passes` wraps, reading in callback-sized blocks, and compares every
+* frame with what the reference says it should be. At each wrap it waits for the worker to park the next tail, which
+* it has a whole pass of the loop for when it plays in real time.
+*/
+static bool runLoop(const LoopCase& test, const StemSource& source, const std::vector<float>& reference) {
+	LoopRegion loop;
+	loop.configure(1, CHANNEL_COUNT, SAMPLE_RATE, test.startFrame, test.endFrame, test.crossfade);
+	loop.launch(std::vector<StemSource>{source}, SAMPLE_RATE);
+	if (!waitFor([&]() { return loop.canEngage() && loop.tailsParked(); })) {
+		printf("%-22s FAIL: the window was never ready\n", test.name);
+		return false;
+	}
+
+	ma_uint64 engageAt = test.endFrame - 3000;
+	ma_decoder decoder;
+	if (!openAt(source, &decoder, engageAt)) {
+		printf("%-22s FAIL: couldn't open the stem\n", test.name);
+		return false;
+	}
+	loop.engage(engageAt, 0);
+
+	ma_uint64 fadeFrom = test.endFrame - test.crossfade, loopFrames = test.endFrame - test.startFrame - test.crossfade;
+	ma_uint64 frames = 3000 + (test.passes - 1) * loopFrames + 1000, expected = engageAt, read = 0;
+	ma_uint64 firstWrap = 0, wrongFrames = 0, firstWrong = 0;
+	float maxGainError = 0;
+	std::vector<float> block(441 * CHANNEL_COUNT);
+	while (read < frames) {
+		ma_uint64 want = std::min<ma_uint64>(441, frames - read);
+		ma_uint32 wraps = loop.wraps();
+		if (loop.read(0, &decoder, block.data(), want) != want) break;
+		for (ma_uint64 f = 0; f < want; ++f, ++read) {
+			for (int c = 0; c < CHANNEL_COUNT; ++c) {
+				float target = reference[expected * CHANNEL_COUNT + c];
+				if (expected >= fadeFrom) {
+					// Out of the end, into the start of the loop
+					ma_uint64 k = expected - fadeFrom;
+					float fadeIn = ((float)k + 0.5f) / test.crossfade;
+					float start = reference[(test.startFrame + k) * CHANNEL_COUNT + c];
+					target = target * (1 - fadeIn) + start * fadeIn;
+					float end = reference[expected * CHANNEL_COUNT + c];
+					if (start != end) {
+						float gain = (block[f * CHANNEL_COUNT + c] - end) / (start - end);
+						if (std::fabs(start - end) > 0.01f) maxGainError = std::max(maxGainError, std::fabs(gain - fadeIn));
+					}
+				}
+				if (std::fabs(block[f * CHANNEL_COUNT + c] - target) > 1e-5f) {
+					if (wrongFrames == 0) firstWrong = read;
+					++wrongFrames;
+					break;
+				}
+			}
+			if (++expected == test.endFrame) {
+				expected = test.startFrame + test.crossfade;
+				if (firstWrap == 0) firstWrap = read + 1;
+			}
+		}
+		if (loop.wraps() != wraps) waitFor([&]() { return loop.tailsParked(); });
+	}
+
+	ma_uint64 cursor = 0;
+	ma_decoder_get_cursor_in_pcm_frames(&decoder, &cursor);
+	ma_decoder_uninit(&decoder);
+	loop.stop();
+	loop.cancel();
+
+	bool wrapOk = firstWrap == test.endFrame - engageAt && (int)loop.wraps() == test.passes;
+	bool pass = read == frames && wrongFrames == 0 && wrapOk && maxGainError < 1e-3f && cursor == test.endFrame;
+	printf("%-22s %s: wrapped after %llu frames, %u wraps, %llu frames off the reference (first at %llu), crossfade gain error %.5f, decoder left at %llu\n",
+		test.name, pass ? "ok" : "FAIL", (unsigned long long)firstWrap, loop.wraps(), (unsigned long long)wrongFrames,
+		(unsigned long long)firstWrong, maxGainError, (unsigned long long)cursor);
+	return pass;
+}
+
+// The engine wraps on the null device: every LOOP_POINT is on the loop's end, counting up from 1
+static bool runMixer(const std::vector<unsigned char>& wav) {
+	const void* data = wav.data();
+	int size = (int)wav.size();
+	mixer_load_from_memory(&data, &size, 1);
+	ma_uint64 startFrame = SAMPLE_RATE / 2, endFrame = startFrame + SAMPLE_RATE / 5;
+	bool set = mixer_set_loop((int64_t)startFrame, (int64_t)endFrame, 441) != 0;
+	mixer_start();
+	std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+	mixer_stop();
+
+	double events[3 * 256];
+	int count, loops = 0, wrongLoops = 0, finished = 0;
+	while ((count = mixer_poll_events(events, 3 * 256)) > 0) {
+		for (int i = 0; i < count; ++i) {
+			if (events[i * 3] == 0) ++finished;
+			if (events[i * 3] != 4) continue;
+			++loops;
+			if (events[i * 3 + 1] != loops || events[i * 3 + 2] != (double)endFrame) ++wrongLoops;
+		}
+	}
+	mixer_destroy();
+
+	bool pass = set && loops >= 3 && wrongLoops == 0 && finished == 0;
+	printf("%-22s %s: %d LOOP_POINT events, %d not on the loop's end or out of order\n", "mixer", pass ? "ok" : "FAIL",
+		loops, wrongLoops);
+	return pass;
+}
+
+int main() {
+	std::vector<unsigned char> wav = makeRamp();
+	StemSource source;
+	source.path = "ramp";
+	source.data = wav.data();
+	source.size = wav.size();
+	std::vector<float> reference = decodeAll(source);
+	if (reference.size() < (size_t)(stemSeconds - 1) * SAMPLE_RATE * CHANNEL_COUNT) {
+		printf("FAIL: couldn't decode the stem\n");
+		return 1;
+	}
+
+	ma_uint64 start = 2 * SAMPLE_RATE, longLoop = (ma_uint64)((LoopRegion::maxWindowSeconds + 3) * SAMPLE_RATE);
+	const LoopCase cases[] = {
+		{"short, hard cut", start, start + 20000, 0, 3},
+		{"short, crossfade", start, start + 20000, 1000, 3},
+		{"past the window", start, start + longLoop, 441, 3},
+	};
+	int failures = 0;
+	for (const LoopCase& test : cases) {
+		if (!runLoop(test, source, reference)) ++failures;
+	}
+	if (!runMixer(wav)) ++failures;
+	return failures == 0 ? 0 : 1;
+}
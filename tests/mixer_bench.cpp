@@ -0,0 +1,200 @@
+/*
+	* The whole engine, headless: ma_mixer.cpp built as a library on miniaudio's null backend (a device that pulls the
+	* callback on its own clock and throws the audio away) and driven only through include/ma_mixer.h, the same way
+	* the Haxe bindings drive it. Each scenario plays for a while and then reads the engine's own callback telemetry.
+
+	* Without files it generates four 30 second stems (a chord, a bass line, noise hits and a pad), 16-bit 44.1kHz WAVs
+	* kept in memory. Give it stems to use those instead.
+
+	* mixer_bench [stems...]          five seconds per scenario, the times per callback
+	* mixer_bench --quick [stems...]  one second each, for ctest: fails if a scenario gets no callbacks, the song
+	*                                 reports it has finished while it's still playing, or anything allocated while it
+	*                                 played (counted over every operator new in the process)
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ma_mixer.h"
+
+#define SAMPLE_RATE 44100
+#define CHANNEL_COUNT 2
+
+static const int stemSeconds = 30;
+
+static std::atomic<size_t> newCount{0};
+
+void* operator new(size_t size) {
+	newCount.fetch_add(1, std::memory_order_relaxed);
+	void* p = std::malloc(size > 0 ? size : 1);
+	if (p == NULL) throw std::bad_alloc();
+	return p;
+}
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+void operator delete(void* p, size_t) noexcept {
+	std::free(p);
+}
+
+struct Scenario {
+	const char* name;
+	int rateMode; // 0 = stretch, 1 = varispeed
+	int preset;
+	float rate;
+	int changeType; // Scheduled on the timeline, see TimelineChange: 0 = volume, 2 = rate
+	int changeEvery; // Song frames between them, 0 = none
+};
+
+// What the rate changes cycle through, either side of 1x and back to it
+static const float timelineRates[] = {0.8f, 1.3f, 1.0f, 1.7f, 0.6f, 2.0f};
+
+static const Scenario scenarios[] = {
+	{"1.00x", 0, 0, 1.0f, 0, 0},
+	{"stretch 1.25x cheaper", 0, 0, 1.25f, 0, 0},
+	{"stretch 0.75x default", 0, 1, 0.75f, 0, 0},
+	{"stretch 1.50x lowlatency", 0, 2, 1.5f, 0, 0},
+	{"stretch 0.90x adaptive", 0, 4, 0.9f, 0, 0},
+	{"varispeed 1.25x", 1, 0, 1.25f, 0, 0},
+	// The callback splits at every change, which leaves chunks of every length down to a frame, some too short to
+	// need any input at this rate
+	{"stretch 0.75x timeline", 0, 0, 0.75f, 0, 100},
+	{"varispeed 0.75x timeline", 1, 0, 0.75f, 0, 100},
+	// Rate changes from the audio thread, every block size of the adaptive preset and every resampler cutoff
+	{"stretch timeline rates", 0, 4, 1.0f, 2, 2205},
+	{"varispeed timeline rates", 1, 0, 1.0f, 2, 2205},
+};
+
+static void putU32(std::vector<unsigned char>& out, unsigned int value, int bytes) {
+	for (int i = 0; i < bytes; ++i) out.push_back((unsigned char)(value >> (8 * i)));
+}
+
+// A mono voice on both channels, panned a little so the stems don't all sum identically
+static std::vector<unsigned char> makeStem(int index) {
+	int frames = stemSeconds * SAMPLE_RATE;
+	std::vector<unsigned char> wav;
+	wav.insert(wav.end(), {'R', 'I', 'F', 'F'});
+	putU32(wav, 36 + frames * CHANNEL_COUNT * 2, 4);
+	wav.insert(wav.end(), {'W', 'A', 'V', 'E', 'f', 'm', 't', ' '});
+	putU32(wav, 16, 4);
+	putU32(wav, 1, 2); // PCM
+	putU32(wav, CHANNEL_COUNT, 2);
+	putU32(wav, SAMPLE_RATE, 4);
+	putU32(wav, SAMPLE_RATE * CHANNEL_COUNT * 2, 4);
+	putU32(wav, CHANNEL_COUNT * 2, 2);
+	putU32(wav, 16, 2);
+	wav.insert(wav.end(), {'d', 'a', 't', 'a'});
+	putU32(wav, frames * CHANNEL_COUNT * 2, 4);
+
+	unsigned int lcg = 1234 + index;
+	for (int f = 0; f < frames; ++f) {
+		double t = (double)f / SAMPLE_RATE, v = 0;
+		switch (index % 4) {
+			case 0: v = 0.2 * (std::sin(2 * M_PI * 261.6 * t) + std::sin(2 * M_PI * 329.6 * t) + std::sin(2 * M_PI * 392 * t)) / 3; break;
+			case 1: v = 0.3 * std::sin(2 * M_PI * (f / (SAMPLE_RATE / 2) % 2 == 0 ? 55 : 73.4) * t); break;
+			case 2: {
+				lcg = lcg * 1664525u + 1013904223u;
+				double noise = (double)(lcg >> 8) / (1 << 24) - 0.5;
+				v = noise * std::exp(-(f % (SAMPLE_RATE / 4)) / 400.0);
+				break;
+			}
+			default: v = 0.1 * std::sin(2 * M_PI * 440 * t + 2 * std::sin(2 * M_PI * 0.5 * t)); break;
+		}
+		double pan = (index % 4 - 1.5) * 0.2;
+		putU32(wav, (unsigned short)(short)(v * (1 - pan) * 32767), 2);
+		putU32(wav, (unsigned short)(short)(v * (1 + pan) * 32767), 2);
+	}
+	return wav;
+}
+
+// One number out of mixer_get_telemetry_json(), from the object that follows `after` (or the top level)
+static double jsonNumber(const std::string& json, const char* after, const char* key) {
+	size_t from = 0;
+	if (after != NULL) {
+		from = json.find(std::string("\"") + after + "\":{");
+		if (from == std::string::npos) return 0;
+	}
+	size_t at = json.find(std::string("\"") + key + "\":", from);
+	if (at == std::string::npos) return 0;
+	return atof(json.c_str() + at + strlen(key) + 3);
+}
+
+int main(int argc, char** argv) {
+	bool quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+	double seconds = quick ? 1 : 5;
+	std::vector<const char*> paths(argv + (quick ? 2 : 1), argv + argc);
+
+	std::vector<std::vector<unsigned char>> stems;
+	std::vector<const void*> stemData;
+	std::vector<int> stemSizes;
+	if (paths.empty()) {
+		for (int i = 0; i < 4; ++i) stems.push_back(makeStem(i));
+		for (const std::vector<unsigned char>& stem : stems) {
+			stemData.push_back(stem.data());
+			stemSizes.push_back((int)stem.size());
+		}
+	}
+
+	printf("%-26s %9s %8s %8s %8s %8s %8s %8s %8s %6s %6s\n", "scenario", "callbacks", "period", "decode", "mix", "stretch",
+		"effects", "callback", "max", "load", "allocs");
+	int failures = 0;
+	for (const Scenario& scenario : scenarios) {
+		if (paths.empty()) {
+			mixer_load_from_memory(stemData.data(), stemSizes.data(), (int)stemData.size());
+		} else {
+			mixer_load_files(paths.data(), (int)paths.size());
+		}
+		if (mixer_get_duration() <= 0) {
+			printf("%-26s FAIL: nothing loaded\n", scenario.name);
+			return 1;
+		}
+		mixer_set_rate_mode(scenario.rateMode);
+		mixer_set_stretch_preset(scenario.preset);
+		mixer_set_playback_rate(scenario.rate);
+		for (int i = 1; scenario.changeEvery > 0 && i <= 1000; ++i) {
+			double value = scenario.changeType == 2 ? timelineRates[i % 6] : (i % 2 == 0 ? 1.0 : 0.9);
+			mixer_schedule_change(scenario.changeType, 0, value, (int64_t)i * scenario.changeEvery);
+		}
+		double events[3 * 256];
+		while (mixer_poll_events(events, 3 * 256) > 0) {}
+		mixer_reset_telemetry();
+
+		mixer_start();
+		std::this_thread::sleep_for(std::chrono::duration<double>(0.05)); // Starting the device can allocate
+		size_t newsBefore = newCount.load();
+		std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+		size_t news = newCount.load() - newsBefore;
+		mixer_stop();
+
+		std::vector<char> json(8192);
+		mixer_get_telemetry_json(json.data(), (int)json.size());
+		std::string telemetry = json.data();
+		int finished = 0, count;
+		while ((count = mixer_poll_events(events, 3 * 256)) > 0) {
+			for (int i = 0; i < count; ++i) {
+				if (events[i * 3] == 0) ++finished;
+			}
+		}
+		mixer_destroy();
+
+		double callbacks = jsonNumber(telemetry, NULL, "callbacks"), period = jsonNumber(telemetry, NULL, "periodUs");
+		double callback = jsonNumber(telemetry, "callback", "meanUs");
+		printf("%-26s %9.0f %6.0fus %6.1fus %6.1fus %6.1fus %6.1fus %6.1fus %6.0fus %5.1f%% %6zu\n", scenario.name, callbacks,
+			period, jsonNumber(telemetry, "decode", "meanUs"), jsonNumber(telemetry, "mix", "meanUs"),
+			jsonNumber(telemetry, "stretch", "meanUs"), jsonNumber(telemetry, "effects", "meanUs"), callback,
+			jsonNumber(telemetry, "callback", "maxUs"), period > 0 ? 100 * callback / period : 0.0, news);
+		if (callbacks == 0 || finished > 0 || news > 0) {
+			printf("%-26s FAIL: %s\n", scenario.name, callbacks == 0 ? "no callbacks" : finished > 0 ? "the song finished early" : "allocated while playing");
+			++failures;
+		}
+	}
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,203 @@
+/*
+	* The polyphase resampler (include/ma_resampler.h, through miniaudio as a custom backend, exactly as the decoders
+	* use it) against miniaudio's own ma_linear_resampler, on quality and speed.
+
+	* Quality: a sine through each conversion, then the best-fitting sine at the output frequency is subtracted and
+	* what's left (aliases, imaging, filter ripple) is the noise. A tone above the output's Nyquist should vanish
+	* instead, so for those it's how far below the input it ended up. The polyphase resampler's passband ends a little
+	* under Nyquist, so the top test tone sits at 18kHz.
+	* Speed: cycles (rdtsc, on x86) and nanoseconds per output sample, stereo, in 512-frame blocks, best of many runs.
+
+	* resampler_bench          everything
+	* resampler_bench --quick  the quality checks only, for ctest (fails if the polyphase resampler drops below 80dB SNR
+	*                          or 70dB rejection)
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "signalsmith-stretch/dsp/rates.h"
+
+#define MINIAUDIO_IMPLEMENTATION
+#include "miniaudio.h"
+
+#include "ma_resampler.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#	if defined(_MSC_VER)
+#		include <intrin.h>
+#	else
+#		include <x86intrin.h>
+#	endif
+#	define HAS_RDTSC 1
+#else
+#	define HAS_RDTSC 0
+#endif
+
+#define CHANNEL_COUNT 2
+
+static const double minPolyphaseSnrDb = 80;
+static const double minPolyphaseRejectionDb = 70; // Lower, the stopband tone is only just past Nyquist, in the filter's transition
+
+struct Conversion {
+	ma_uint32 rateIn, rateOut;
+};
+static const Conversion conversions[] = {{48000, 44100}, {44100, 48000}, {22050, 44100}, {96000, 44100}};
+static const double toneFreqs[] = {1000, 10000, 15000, 18000};
+static const double stopbandFreq = 23000; // Above 44.1k's Nyquist: rejection, when converting down to it
+
+static bool initResampler(ma_resampler* resampler, bool polyphase, ma_uint32 rateIn, ma_uint32 rateOut) {
+	ma_resampler_config config = ma_resampler_config_init(ma_format_f32, CHANNEL_COUNT, rateIn, rateOut, ma_resample_algorithm_linear);
+	if (polyphase) {
+		config.algorithm = ma_resample_algorithm_custom;
+		config.pBackendVTable = &g_polyphaseResamplerVTable;
+	}
+	return ma_resampler_init(&config, NULL, resampler) == MA_SUCCESS;
+}
+
+// Pushes all of `input` through in blocks, returns the output
+static std::vector<float> convert(bool polyphase, ma_uint32 rateIn, ma_uint32 rateOut, const std::vector<float>& input) {
+	ma_resampler resampler;
+	std::vector<float> output;
+	if (!initResampler(&resampler, polyphase, rateIn, rateOut)) return output;
+
+	const ma_uint64 blockOut = 512;
+	std::vector<float> block(blockOut * CHANNEL_COUNT);
+	ma_uint64 inputFrames = input.size() / CHANNEL_COUNT, used = 0;
+	while (used < inputFrames) {
+		ma_uint64 frameCountIn = std::min<ma_uint64>(inputFrames - used, 4096);
+		ma_uint64 frameCountOut = blockOut;
+		ma_resampler_process_pcm_frames(&resampler, input.data() + used * CHANNEL_COUNT, &frameCountIn, block.data(), &frameCountOut);
+		output.insert(output.end(), block.begin(), block.begin() + frameCountOut * CHANNEL_COUNT);
+		used += frameCountIn;
+		if (frameCountIn == 0 && frameCountOut == 0) break;
+	}
+	ma_resampler_uninit(&resampler, NULL);
+	return output;
+}
+
+static std::vector<float> sine(double freq, ma_uint32 rate, int frames) {
+	std::vector<float> out(frames * CHANNEL_COUNT);
+	for (int f = 0; f < frames; ++f) {
+		float v = (float)(0.5 * std::sin(2 * M_PI * freq * f / rate));
+		out[f * 2] = out[f * 2 + 1] = v;
+	}
+	return out;
+}
+
+// Left channel, skipping the start and end so latency and the tail don't count
+static double snrDb(const std::vector<float>& output, double freq, ma_uint32 rate, bool rejection) {
+	int frames = (int)output.size() / CHANNEL_COUNT;
+	int start = frames / 8, end = frames - frames / 8;
+	double cc = 0, ss = 0, cs = 0, xc = 0, xs = 0, xx = 0;
+	for (int f = start; f < end; ++f) {
+		double c = std::cos(2 * M_PI * freq * f / rate), s = std::sin(2 * M_PI * freq * f / rate), x = output[f * 2];
+		cc += c * c;
+		ss += s * s;
+		cs += c * s;
+		xc += x * c;
+		xs += x * s;
+		xx += x * x;
+	}
+	int count = end - start;
+	double inputPower = 0.5 * 0.5 / 2;
+	if (rejection) return 10 * std::log10(inputPower / (xx / count + 1e-30));
+
+	// Least squares a*cos + b*sin
+	double det = cc * ss - cs * cs;
+	double a = (xc * ss - xs * cs) / det, b = (xs * cc - xc * cs) / det;
+	double noise = 0, signal = 0;
+	for (int f = start; f < end; ++f) {
+		double fit = a * std::cos(2 * M_PI * freq * f / rate) + b * std::sin(2 * M_PI * freq * f / rate);
+		double diff = output[f * 2] - fit;
+		noise += diff * diff;
+		signal += fit * fit;
+	}
+	return 10 * std::log10(signal / (noise + 1e-30));
+}
+
+struct Speed {
+	double cyclesPerSample, nsPerSample;
+};
+
+static Speed speed(bool polyphase, ma_uint32 rateIn, ma_uint32 rateOut) {
+	ma_resampler resampler;
+	Speed result = {0, 0};
+	if (!initResampler(&resampler, polyphase, rateIn, rateOut)) return result;
+
+	const ma_uint64 blockOut = 512;
+	std::vector<float> input = sine(1000, rateIn, 8192), block(blockOut * CHANNEL_COUNT);
+	double bestNs = 1e30, bestCycles = 1e30;
+	for (int run = 0; run < 2000; ++run) {
+		ma_uint64 frameCountIn = 4096, frameCountOut = blockOut;
+#if HAS_RDTSC
+		unsigned long long cyclesStart = __rdtsc();
+#endif
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		ma_resampler_process_pcm_frames(&resampler, input.data(), &frameCountIn, block.data(), &frameCountOut);
+		double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+#if HAS_RDTSC
+		bestCycles = std::min(bestCycles, (double)(__rdtsc() - cyclesStart) / (frameCountOut * CHANNEL_COUNT));
+#endif
+		bestNs = std::min(bestNs, ns / (frameCountOut * CHANNEL_COUNT));
+	}
+	ma_resampler_uninit(&resampler, NULL);
+	result.cyclesPerSample = HAS_RDTSC ? bestCycles : 0;
+	result.nsPerSample = bestNs;
+	return result;
+}
+
+int main(int argc, char** argv) {
+	bool quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+	int failures = 0;
+
+	printf("SNR in dB (rejection for the %.0fHz tone), linear / polyphase\n", stopbandFreq);
+	printf("%-14s", "conversion");
+	for (double freq : toneFreqs) printf(" %14.0fHz", freq);
+	printf(" %14.0fHz\n", stopbandFreq);
+	for (const Conversion& conversion : conversions) {
+		char name[32];
+		snprintf(name, sizeof(name), "%u->%u", conversion.rateIn, conversion.rateOut);
+		printf("%-14s", name);
+		double nyquist = std::min(conversion.rateIn, conversion.rateOut) / 2.0;
+		for (double freq : toneFreqs) {
+			if (freq > nyquist * 0.85) {
+				printf(" %16s", "-");
+				continue;
+			}
+			std::vector<float> input = sine(freq, conversion.rateIn, conversion.rateIn);
+			double linear = snrDb(convert(false, conversion.rateIn, conversion.rateOut, input), freq, conversion.rateOut, false);
+			double polyphase = snrDb(convert(true, conversion.rateIn, conversion.rateOut, input), freq, conversion.rateOut, false);
+			printf(" %7.1f / %6.1f", linear, polyphase);
+			if (polyphase < minPolyphaseSnrDb) ++failures;
+		}
+		if (conversion.rateOut < conversion.rateIn && stopbandFreq < conversion.rateIn / 2.0) {
+			std::vector<float> input = sine(stopbandFreq, conversion.rateIn, conversion.rateIn);
+			double linear = snrDb(convert(false, conversion.rateIn, conversion.rateOut, input), stopbandFreq, conversion.rateOut, true);
+			double polyphase = snrDb(convert(true, conversion.rateIn, conversion.rateOut, input), stopbandFreq, conversion.rateOut, true);
+			printf(" %7.1f / %6.1f", linear, polyphase);
+			if (polyphase < minPolyphaseRejectionDb) ++failures;
+		} else {
+			printf(" %16s", "-");
+		}
+		printf("\n");
+	}
+
+	if (!quick) {
+		printf("\nPer output sample, stereo, 512-frame blocks: linear / polyphase\n");
+		printf("%-14s %20s %20s\n", "conversion", "cycles", "ns");
+		for (const Conversion& conversion : conversions) {
+			Speed linear = speed(false, conversion.rateIn, conversion.rateOut);
+			Speed polyphase = speed(true, conversion.rateIn, conversion.rateOut);
+			char name[32];
+			snprintf(name, sizeof(name), "%u->%u", conversion.rateIn, conversion.rateOut);
+			printf("%-14s %9.1f / %8.1f %9.2f / %8.2f\n", name, linear.cyclesPerSample, polyphase.cyclesPerSample, linear.nsPerSample, polyphase.nsPerSample);
+		}
+	}
+	if (failures > 0) printf("%d polyphase results under %.0fdB (%.0fdB for rejection)\n", failures, minPolyphaseSnrDb, minPolyphaseRejectionDb);
+	return failures == 0 ? 0 : 1;
+}
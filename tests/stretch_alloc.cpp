@@ -0,0 +1,132 @@
+/*
+	* Once a stretcher is set up with a preset and reserveInterleaved(), nothing it does on the audio thread should
+	* allocate: processing at any rate up to the reserved block sizes, adapt() switching block sizes, the percussive
+	* detector switching them by itself, and seek().
+
+	* Checks perf::allocationCount() (everything that goes through AlignedAllocator) and, to catch anything which
+	* doesn't, counts every operator new in the process as well.
+
+	* The varispeed resampler too: the timeline changes its ratio from the audio thread, to any rate.
+*/
+
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "signalsmith-stretch.h"
+#include "dsp/rates.h"
+
+#define SAMPLE_RATE 44100
+#define CHANNEL_COUNT 2
+#define SEED 1234
+
+static std::atomic<size_t> newCount{0};
+
+void* operator new(size_t size) {
+	newCount.fetch_add(1, std::memory_order_relaxed);
+	void* p = std::malloc(size > 0 ? size : 1);
+	if (p == NULL) throw std::bad_alloc();
+	return p;
+}
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+void operator delete(void* p, size_t) noexcept {
+	std::free(p);
+}
+
+static const char* presetNames[] = {"cheaper", "default", "lowlatency", "lowestlatency", "adaptive"};
+static const int presetCount = 5;
+
+// Like the mixer: 4096 input frames at most, and a device period of up to 4096 output frames
+static const int maxInputFrames = 4096;
+static const int maxOutputFrames = 4096;
+
+static void setPreset(signalsmith::stretch::SignalsmithStretch& stretch, int preset) {
+	switch (preset) {
+		case 1: stretch.presetDefault(CHANNEL_COUNT, SAMPLE_RATE); break;
+		case 2: stretch.presetLowLatency(CHANNEL_COUNT, SAMPLE_RATE); break;
+		case 3: stretch.presetLowestLatency(CHANNEL_COUNT, SAMPLE_RATE); break;
+		case 4: stretch.presetAdaptive(CHANNEL_COUNT, SAMPLE_RATE); break;
+		default: stretch.presetCheaper(CHANNEL_COUNT, SAMPLE_RATE); break;
+	}
+}
+
+// Tone with a loud hit every quarter second, so the adaptive preset decides it's percussive partway through
+static void fill(std::vector<float>& input, long long& position, int frames) {
+	for (int f = 0; f < frames; ++f, ++position) {
+		double tone = 0.2 * std::sin(position * 2 * M_PI * 220 / SAMPLE_RATE);
+		int sinceHit = (int)(position % (SAMPLE_RATE / 4));
+		double hit = sinceHit < 2000 ? std::exp(-sinceHit / 300.0) * std::sin(sinceHit * 1.3) * 0.8 : 0;
+		input[f * 2] = input[f * 2 + 1] = (float)(tone + hit);
+	}
+}
+
+int main() {
+	std::vector<float> input(maxInputFrames * CHANNEL_COUNT), output(maxOutputFrames * CHANNEL_COUNT);
+	const float rates[] = {0.5f, 0.75f, 1.0f, 1.25f, 1.5f, 2.0f, 0.9f};
+	const int periods[] = {512, 64, 1024, 4096, 1, 300};
+	int failures = 0;
+
+	for (int preset = 0; preset < presetCount; ++preset) {
+		signalsmith::stretch::SignalsmithStretch stretch(SEED);
+		setPreset(stretch, preset);
+		stretch.reserveInterleaved(maxInputFrames, maxOutputFrames);
+		long long position = 0;
+
+		size_t alignedBefore = signalsmith::perf::allocationCount();
+		size_t newBefore = newCount.load();
+		int blocks = 0, blockSizes = 0, lastBlockSize = stretch.blockSamples();
+
+		for (float rate : rates) {
+			stretch.adapt(rate);
+			for (int p = 0; p < 40; ++p) {
+				int outputFrames = periods[p % 6];
+				int inputFrames = std::min(maxInputFrames, (int)(outputFrames * rate));
+				fill(input, position, inputFrames);
+				stretch.process(input.data(), inputFrames, output.data(), outputFrames);
+				++blocks;
+				if (stretch.blockSamples() != lastBlockSize) {
+					lastBlockSize = stretch.blockSamples();
+					++blockSizes;
+				}
+			}
+			// The mixer seeks with the input latency's worth of what comes next
+			fill(input, position, stretch.inputLatency());
+			stretch.seek(input.data(), stretch.inputLatency(), rate);
+		}
+
+		size_t aligned = signalsmith::perf::allocationCount() - alignedBefore;
+		size_t news = newCount.load() - newBefore;
+		bool pass = aligned == 0 && news == 0;
+		printf("%-14s %s: %d blocks, %d block size switches, %zu aligned allocations, %zu operator new\n",
+			presetNames[preset], pass ? "ok" : "FAIL", blocks, blockSizes, aligned, news);
+		if (!pass) ++failures;
+	}
+
+	{
+		signalsmith::rates::PolyphaseResampler<float> varispeed(CHANNEL_COUNT, maxInputFrames);
+		std::vector<float> left(maxInputFrames), right(maxInputFrames), outLeft(maxOutputFrames), outRight(maxOutputFrames);
+		float* inputs[CHANNEL_COUNT] = {left.data(), right.data()};
+		float* outputs[CHANNEL_COUNT] = {outLeft.data(), outRight.data()};
+		size_t alignedBefore = signalsmith::perf::allocationCount();
+		size_t newBefore = newCount.load();
+		// Every cutoff, from a quarter of the speed to four times it
+		int ratios = 0;
+		for (double ratio = 0.25; ratio <= 4; ratio *= 1.03, ++ratios) {
+			varispeed.setRatio(ratio);
+			int outputFrames = std::min(maxOutputFrames, (int)(maxInputFrames / ratio) - 64);
+			varispeed.process(inputs, varispeed.inputFor(outputFrames), outputs, outputFrames);
+		}
+		size_t aligned = signalsmith::perf::allocationCount() - alignedBefore;
+		size_t news = newCount.load() - newBefore;
+		bool pass = aligned == 0 && news == 0;
+		printf("%-14s %s: %d ratios, %zu aligned allocations, %zu operator new\n", "varispeed", pass ? "ok" : "FAIL", ratios,
+			aligned, news);
+		if (!pass) ++failures;
+	}
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,240 @@
+/*
+	* Golden output for the stretcher: a fixed input through every preset at a few rates, with a fixed seed, compared
+	* against the references in golden/.
+
+	* The comparison is on band energies rather than samples. A phase vocoder amplifies rounding differences into phase
+	* differences, so the same source built with FMA contraction (or another compiler) can move single samples by a
+	* good fraction of full scale while sounding identical. What a broken FFT step, a wrong twiddle or a layout mistake
+	* changes is the spectrum, and that's what gets checked, within a tolerance.
+
+	* stretch_golden <dir>           compares against <dir>
+	* stretch_golden <dir> --update  rewrites <dir> from this build
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "signalsmith-stretch.h"
+
+#define SAMPLE_RATE 44100
+#define CHANNEL_COUNT 2
+#define SEED 1234
+
+static const int inputSeconds = 4;
+static const int blockFrames = 512; // Output frames per process() call, like a device period
+static const int frameSize = 2048; // Analysis frames
+static const int bandCount = 32;
+static const float bandLow = 40, bandHigh = 18000;
+static const float floorDb = -90;
+
+// Bands quieter than this (relative to the loudest band in the whole render) aren't compared, their level is mostly noise
+static const float ignoreBelowDb = -60;
+// How far the bands may move. Differently compiled builds of the same code (FMA contraction, -ffast-math) average
+// under 0.15 dB, with the odd band in a phase cancellation off by a few dB
+static const float meanToleranceDb = 0.5f;
+static const float percentileToleranceDb = 3; // For the 99th percentile
+
+static const char* presetNames[] = {"cheaper", "default", "lowlatency", "lowestlatency", "adaptive"};
+static const int presetCount = 5;
+static const float rates[] = {0.75f, 1.25f, 1.5f};
+static const int rateCount = 3;
+
+// A chord with vibrato, a noise bed and a noise hit every quarter second: tonal, noisy and percussive at once
+static std::vector<float> makeInput() {
+	int frames = inputSeconds * SAMPLE_RATE;
+	std::vector<float> input(frames * CHANNEL_COUNT);
+	const double freqs[] = {220, 277.18, 329.63, 440, 1318.5};
+	unsigned int lcg = 22222;
+	double phases[5] = {0, 0, 0, 0, 0};
+	for (int f = 0; f < frames; ++f) {
+		double t = (double)f / SAMPLE_RATE;
+		double tone = 0;
+		for (int i = 0; i < 5; ++i) {
+			phases[i] += 2 * M_PI * freqs[i] * (1 + 0.003 * std::sin(2 * M_PI * 5 * t)) / SAMPLE_RATE;
+			tone += std::sin(phases[i]) * 0.12 / (i + 1);
+		}
+		lcg = lcg * 1664525u + 1013904223u;
+		double noise = ((double)(lcg >> 8) / (1 << 24) - 0.5) * 0.05;
+		int sinceHit = f % (SAMPLE_RATE / 4);
+		double hit = std::exp(-sinceHit / 300.0) * noise * 32;
+		input[f * 2] = (float)(tone + noise + hit);
+		input[f * 2 + 1] = (float)(tone * 0.8 - noise + hit);
+	}
+	return input;
+}
+
+static void setPreset(signalsmith::stretch::SignalsmithStretch& stretch, int preset) {
+	switch (preset) {
+		case 1: stretch.presetDefault(CHANNEL_COUNT, SAMPLE_RATE); break;
+		case 2: stretch.presetLowLatency(CHANNEL_COUNT, SAMPLE_RATE); break;
+		case 3: stretch.presetLowestLatency(CHANNEL_COUNT, SAMPLE_RATE); break;
+		case 4: stretch.presetAdaptive(CHANNEL_COUNT, SAMPLE_RATE); break;
+		default: stretch.presetCheaper(CHANNEL_COUNT, SAMPLE_RATE); break;
+	}
+}
+
+// Blocks of output the way the mixer asks for them, carrying the fractional input between blocks
+static std::vector<float> render(const std::vector<float>& input, int preset, float rate) {
+	signalsmith::stretch::SignalsmithStretch stretch(SEED);
+	setPreset(stretch, preset);
+	stretch.adapt(rate);
+
+	int inputFrames = (int)input.size() / CHANNEL_COUNT;
+	std::vector<float> output;
+	std::vector<float> block(blockFrames * CHANNEL_COUNT);
+	int read = 0;
+	double carry = 0;
+	while (true) {
+		double wanted = blockFrames * rate + carry;
+		int take = (int)wanted;
+		carry = wanted - take;
+		if (read + take > inputFrames) break;
+		stretch.process(const_cast<float*>(input.data()) + read * CHANNEL_COUNT, take, block.data(), blockFrames);
+		read += take;
+		output.insert(output.end(), block.begin(), block.end());
+	}
+	// Skip the start-up latency
+	int skip = std::min((int)output.size(), stretch.outputLatency() * CHANNEL_COUNT);
+	output.erase(output.begin(), output.begin() + skip);
+	return output;
+}
+
+static void fft(std::vector<std::complex<double>>& data) {
+	size_t n = data.size();
+	for (size_t i = 1, j = 0; i < n; ++i) {
+		size_t bit = n >> 1;
+		for (; j & bit; bit >>= 1) j ^= bit;
+		j ^= bit;
+		if (i < j) std::swap(data[i], data[j]);
+	}
+	for (size_t len = 2; len <= n; len <<= 1) {
+		std::complex<double> step = std::polar(1.0, -2 * M_PI / len);
+		for (size_t i = 0; i < n; i += len) {
+			std::complex<double> w = 1;
+			for (size_t k = 0; k < len / 2; ++k) {
+				std::complex<double> a = data[i + k], b = data[i + k + len / 2] * w;
+				data[i + k] = a + b;
+				data[i + k + len / 2] = a - b;
+				w *= step;
+			}
+		}
+	}
+}
+
+// Energy in log-spaced bands (dB) for each analysis frame of the mid channel, frame after frame
+static std::vector<float> bandEnergies(const std::vector<float>& audio) {
+	std::vector<float> out;
+	std::vector<std::complex<double>> spectrum(frameSize);
+	int frames = (int)audio.size() / CHANNEL_COUNT;
+	for (int start = 0; start + frameSize <= frames; start += frameSize) {
+		for (int i = 0; i < frameSize; ++i) {
+			double window = 0.5 - 0.5 * std::cos(2 * M_PI * (i + 0.5) / frameSize);
+			double mid = 0.5 * (audio[(start + i) * 2] + audio[(start + i) * 2 + 1]);
+			spectrum[i] = mid * window;
+		}
+		fft(spectrum);
+		for (int b = 0; b < bandCount; ++b) {
+			double lowHz = bandLow * std::pow(bandHigh / bandLow, (double)b / bandCount);
+			double highHz = bandLow * std::pow(bandHigh / bandLow, (double)(b + 1) / bandCount);
+			int low = (int)std::floor(lowHz * frameSize / SAMPLE_RATE);
+			int high = std::max(low + 1, (int)std::floor(highHz * frameSize / SAMPLE_RATE));
+			double energy = 0;
+			for (int k = low; k < high; ++k) energy += std::norm(spectrum[k]);
+			float db = (float)(10 * std::log10(energy / frameSize + 1e-30));
+			out.push_back(std::max(floorDb, db));
+		}
+	}
+	return out;
+}
+
+static std::string casePath(const std::string& dir, int preset, float rate) {
+	char name[64];
+	snprintf(name, sizeof(name), "/%s_%.2f.txt", presetNames[preset], rate);
+	return dir + name;
+}
+
+static bool writeReference(const std::string& path, const std::vector<float>& bands) {
+	FILE* file = fopen(path.c_str(), "w");
+	if (file == NULL) return false;
+	for (size_t i = 0; i < bands.size(); ++i) {
+		fprintf(file, "%.1f%c", bands[i], (i + 1) % bandCount == 0 ? '\n' : ' ');
+	}
+	fclose(file);
+	return true;
+}
+
+static bool readReference(const std::string& path, std::vector<float>& bands) {
+	FILE* file = fopen(path.c_str(), "r");
+	if (file == NULL) return false;
+	float value;
+	while (fscanf(file, "%f", &value) == 1) bands.push_back(value);
+	fclose(file);
+	return true;
+}
+
+// Returns whether it's within tolerance, and says how far off it was either way
+static bool compare(const char* name, const std::vector<float>& reference, const std::vector<float>& bands) {
+	if (reference.size() != bands.size()) {
+		printf("%-22s FAIL: %zu frames, the reference has %zu\n", name, bands.size() / bandCount, reference.size() / bandCount);
+		return false;
+	}
+	float loudest = floorDb;
+	for (float db : reference) loudest = std::max(loudest, db);
+
+	std::vector<float> diffs;
+	double sum = 0;
+	for (size_t i = 0; i < reference.size(); ++i) {
+		if (reference[i] < loudest + ignoreBelowDb && bands[i] < loudest + ignoreBelowDb) continue;
+		diffs.push_back(std::abs(reference[i] - bands[i]));
+		sum += diffs.back();
+	}
+	if (diffs.empty()) diffs.push_back(0);
+	std::sort(diffs.begin(), diffs.end());
+	double mean = sum / diffs.size();
+	double percentile = diffs[diffs.size() * 99 / 100];
+	bool pass = mean <= meanToleranceDb && percentile <= percentileToleranceDb;
+	printf("%-22s %s: mean %.3f dB, 99th percentile %.2f dB, max %.2f dB over %zu bands\n", name, pass ? "ok" : "FAIL", mean, percentile, diffs.back(), diffs.size());
+	return pass;
+}
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		printf("usage: stretch_golden <reference dir> [--update]\n");
+		return 2;
+	}
+	std::string dir = argv[1];
+	bool update = argc > 2 && strcmp(argv[2], "--update") == 0;
+
+	std::vector<float> input = makeInput();
+	int failures = 0;
+	for (int preset = 0; preset < presetCount; ++preset) {
+		for (int r = 0; r < rateCount; ++r) {
+			std::vector<float> bands = bandEnergies(render(input, preset, rates[r]));
+			std::string path = casePath(dir, preset, rates[r]);
+			char name[64];
+			snprintf(name, sizeof(name), "%s %.2fx", presetNames[preset], rates[r]);
+
+			if (update) {
+				if (!writeReference(path, bands)) {
+					printf("%-22s couldn't write %s\n", name, path.c_str());
+					++failures;
+				}
+				continue;
+			}
+			std::vector<float> reference;
+			if (!readReference(path, reference)) {
+				printf("%-22s FAIL: no reference at %s\n", name, path.c_str());
+				++failures;
+			} else if (!compare(name, reference, bands)) {
+				++failures;
+			}
+		}
+	}
+	if (update) printf("Wrote %d references to %s\n", presetCount * rateCount - failures, dir.c_str());
+	return failures == 0 ? 0 : 1;
+}